@@ -0,0 +1,103 @@
+// Measures how fast road envelope outlines are rebuilt: the per point sin and cos the
+// envelopes used to compute, one getPolygon call per envelope, and the batch path the
+// renderer takes on a full rebuild, plus the handful of envelopes a node drag touches.
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "Constants.h"
+#include "Envelope.h"
+#include "RoadNetworks.h"
+#include "Stopwatch.h"
+
+// The outline as Envelope::getPolygon computed it before the arc directions were tabled
+static void trigPolygon(const VertexBuffer& vertices, const Segment& skeleton, float width, Point* out) {
+    float ax = vertices.x(skeleton.a), ay = vertices.y(skeleton.a);
+    float bx = vertices.x(skeleton.b), by = vertices.y(skeleton.b);
+    float length = std::sqrt((bx - ax) * (bx - ax) + (by - ay) * (by - ay));
+    float dx = length > 0 ? (bx - ax) / length : 1.0f;
+    float dy = length > 0 ? (by - ay) / length : 0.0f;
+    float midX = (ax + bx) / 2.0f, midY = (ay + by) / 2.0f;
+    float radius = width / 2.0f;
+    float deltaAngle = static_cast<float>(MY_PI / 2) / (Envelope::CornerPoints - 1);
+    float centers[4][2] = {{length - radius, radius}, {radius, radius},
+                           {radius, width - radius}, {length - radius, width - radius}};
+    for (int corner = 0; corner < 4; ++corner) {
+        for (int i = 0; i < Envelope::CornerPoints; ++i) {
+            float angle = deltaAngle * (corner * (Envelope::CornerPoints - 1) + i);
+            float u = radius * std::cos(angle) + centers[corner][0] - length / 2.0f;
+            float v = -radius * std::sin(angle) + centers[corner][1] - radius;
+            *out++ = Point(midX + u * dx - v * dy, midY + u * dy + v * dx);
+        }
+    }
+}
+
+static double checksum(const std::vector<Point>& outlines) {
+    double sum = 0;
+    for (size_t i = 0; i < outlines.size(); i += 97) {
+        sum += outlines[i].x + outlines[i].y;
+    }
+    return sum;
+}
+
+static void runBenchmark(size_t envelopeCount) {
+    RoadNetwork network = makeRandomPlanar(envelopeCount);
+    VertexBuffer vertices;
+    std::vector<Handle> handles;
+    handles.reserve(network.points.size());
+    for (const Point& point : network.points) {
+        handles.push_back(vertices.add(point.x, point.y));
+    }
+    envelopeCount = network.segments.size();
+    std::vector<Envelope> envelopes;
+    envelopes.reserve(envelopeCount);
+    for (size_t i = 0; i < envelopeCount; ++i) {
+        const Segment& road = network.segments[i];
+        envelopes.push_back(Envelope(Segment(handles[road.a].index, handles[road.b].index, static_cast<int>(i)), ROAD_WIDTH));
+    }
+
+    size_t pointCount = 4 * Envelope::CornerPoints;
+    std::vector<Point> outlines(envelopeCount * pointCount);
+
+    Stopwatch timer;
+    for (size_t i = 0; i < envelopeCount; ++i) {
+        trigPolygon(vertices, envelopes[i].getSkeleton(), ROAD_WIDTH, &outlines[i * pointCount]);
+    }
+    double trigTime = timer.microseconds();
+    double trigChecksum = checksum(outlines);
+
+    timer.restart();
+    for (size_t i = 0; i < envelopeCount; ++i) {
+        envelopes[i].getPolygon(vertices, &outlines[i * pointCount]);
+    }
+    double singleTime = timer.microseconds();
+
+    timer.restart();
+    Envelope::getPolygons(vertices, envelopes.data(), envelopes.size(), outlines.data());
+    double batchTime = timer.microseconds();
+    double tableChecksum = checksum(outlines);
+
+    // A drag moves one node and rebuilds the few envelopes around it, every mouse event.
+    const int dragEvents = 10000;
+    float minX, minY, maxX, maxY;
+    networkBounds(network, minX, minY, maxX, maxY);
+    std::vector<Point> drops = scatterPoints(dragEvents, minX, minY, maxX, maxY);
+    timer.restart();
+    for (int event = 0; event < dragEvents; ++event) {
+        size_t first = (event * 4) % (envelopeCount - 4);
+        vertices.set(envelopes[first].getSkeleton().a, drops[event].x, drops[event].y);
+        Envelope::getPolygons(vertices, &envelopes[first], 4, &outlines[first * pointCount]);
+    }
+    double dragTime = timer.microseconds() / dragEvents;
+
+    std::printf("%9zu envelopes | sin/cos %8.1f ms | table %8.1f ms | batch %8.1f ms | %7.1f M envelopes/s | drag %5.2f us%s\n",
+                envelopeCount, trigTime / 1000.0, singleTime / 1000.0, batchTime / 1000.0,
+                envelopeCount / batchTime, dragTime,
+                std::fabs(trigChecksum - tableChecksum) <= 1e-3 * std::fabs(trigChecksum) ? "" : " | MISMATCH");
+}
+
+int main() {
+    for (size_t envelopeCount : {10000u, 100000u, 1000000u}) {
+        runBenchmark(envelopeCount);
+    }
+    return 0;
+}
@@ -0,0 +1,208 @@
+// Times the editor's core operations on synthetic road networks of growing size and
+// prints the results as JSON, one record per network, size and operation, so runs from
+// different releases can be compared by a script.
+//
+//   GraphBenchmarks [--max-segments N] [--networks grid,planar,radial] [--output file.json]
+//
+// Sizes go from 1k segments up to --max-segments (default 1M, at most 10M). Run it from
+// the project directory so the renderer finds its road texture; the drawing benchmarks are
+// skipped when no texture or offscreen target can be created, e.g. without a display.
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Envelope.h"
+#include "Graph.h"
+#include "GraphRenderer.h"
+#include "Log.h"
+#include "RoadNetworks.h"
+#include "Stopwatch.h"
+
+struct Result {
+    std::string network;
+    std::size_t points, segments;
+    std::string operation;
+    // Operations timed and the time they took in total
+    std::size_t count;
+    double seconds;
+};
+
+static void writeJson(std::FILE* file, const std::vector<Result>& results) {
+    std::fprintf(file, "{\n  \"benchmark\": \"GraphBenchmarks\",\n  \"results\": [");
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        std::fprintf(file,
+                     "%s\n    {\"network\": \"%s\", \"points\": %zu, \"segments\": %zu, \"operation\": \"%s\", "
+                     "\"count\": %zu, \"seconds\": %.6f, \"per_second\": %.1f}",
+                     i == 0 ? "" : ",", result.network.c_str(), result.points, result.segments,
+                     result.operation.c_str(), result.count, result.seconds,
+                     result.seconds > 0 ? result.count / result.seconds : 0.0);
+    }
+    std::fprintf(file, "\n  ]\n}\n");
+}
+
+// Draws the whole graph zoomed out, then a close-up at full detail, into an offscreen target.
+static void benchmarkDrawing(Graph& graph, const std::string& name, std::vector<Result>& results) {
+    sf::RenderTexture target;
+    if (!target.create(1024, 1024)) {
+        std::cerr << "Skipping drawing: no offscreen target" << std::endl;
+        return;
+    }
+    std::unique_ptr<GraphRenderer> renderer;
+    try {
+        renderer.reset(new GraphRenderer());
+    } catch (const std::runtime_error& error) {
+        std::cerr << "Skipping drawing: " << error.what() << std::endl;
+        return;
+    }
+    auto record = [&](const std::string& operation, std::size_t count, double seconds) {
+        results.push_back({name, graph.vertices.size(), graph.segments.size(), operation, count, seconds});
+    };
+
+    Stopwatch timer;
+    renderer->rebuild(graph);
+    record("renderer_rebuild", graph.segments.size(), timer.seconds());
+
+    float width = graph.maxX - graph.minX, height = graph.maxY - graph.minY;
+    float side = std::max(width, height);
+    sf::FloatRect overview(graph.minX, graph.minY, side, side);
+    sf::FloatRect closeUp(graph.minX + width / 2, graph.minY + height / 2, 1024.0f, 1024.0f);
+    const int frames = 20;
+    for (const auto& view : {std::make_pair(std::string("draw_overview"), overview),
+                             std::make_pair(std::string("draw_closeup"), closeUp)}) {
+        target.setView(sf::View(view.second));
+        timer.restart();
+        for (int frame = 0; frame < frames; ++frame) {
+            target.clear();
+            renderer->draw(target, graph, view.second, view.second.width / 1024.0f);
+            target.display();
+        }
+        record(view.first, frames, timer.seconds());
+    }
+}
+
+static void benchmarkNetwork(const std::string& name, const RoadNetwork& network, std::vector<Result>& results) {
+    auto record = [&](const std::string& operation, std::size_t count, double seconds) {
+        results.push_back({name, network.points.size(), network.segments.size(), operation, count, seconds});
+    };
+
+    {
+        Stopwatch timer;
+        Graph bulk(network.points, network.segments);
+        record("construct", network.segments.size(), timer.seconds());
+    }
+
+    // The editor's path: one point or segment at a time
+    Graph graph({}, {});
+    {
+        std::vector<std::uint32_t> slots;
+        slots.reserve(network.points.size());
+        Stopwatch timer;
+        for (const Point& point : network.points) {
+            slots.push_back(graph.addPoint(point).index);
+        }
+        record("add_point", network.points.size(), timer.seconds());
+
+        timer.restart();
+        for (const Segment& segment : network.segments) {
+            graph.addSegment(Segment(slots[segment.a], slots[segment.b]));
+        }
+        record("add_segment", network.segments.size(), timer.seconds());
+        for (const Point& point : network.points) {
+            graph.updateBoundary(point);
+        }
+    }
+
+    std::vector<Point> queries = scatterPoints(100000, graph.minX, graph.minY, graph.maxX, graph.maxY, 7);
+    std::size_t found = 0;
+    Stopwatch timer;
+    for (const Point& query : queries) {
+        found += graph.findNearestPoint(query).isNull() ? 0 : 1;
+    }
+    record("nearest_point", queries.size(), timer.seconds());
+
+    timer.restart();
+    for (const Point& query : queries) {
+        found += graph.findNearestSegment(query) ? 1 : 0;
+    }
+    record("nearest_segment", queries.size(), timer.seconds());
+
+    timer.restart();
+    found += graph.findIntersections().size();
+    record("intersections", graph.segments.size(), timer.seconds());
+
+    // Envelope outlines in batches, the way the renderer rebuilds them
+    const std::size_t batch = 4096;
+    std::vector<Point> outlines(batch * 4 * Envelope::CornerPoints);
+    const Envelope* envelopes = graph.roadEnvelopes.empty() ? nullptr : &*graph.roadEnvelopes.begin();
+    timer.restart();
+    for (std::size_t first = 0; first < graph.roadEnvelopes.size(); first += batch) {
+        std::size_t count = std::min(batch, graph.roadEnvelopes.size() - first);
+        Envelope::getPolygons(graph.vertices, envelopes + first, count, outlines.data());
+        found += outlines[0].x > 0 ? 1 : 0;
+    }
+    record("envelope_outlines", graph.roadEnvelopes.size(), timer.seconds());
+
+    benchmarkDrawing(graph, name, results);
+    // Keeps the queries from being optimised away
+    if (found == 0) {
+        std::cerr << name << ": no results" << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::size_t maxSegments = 1000000;
+    std::vector<std::string> networks = {"grid", "planar", "radial"};
+    std::string output;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i], value = argv[i + 1];
+        if (option == "--max-segments") {
+            maxSegments = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (option == "--networks") {
+            networks.clear();
+            std::stringstream list(value);
+            for (std::string name; std::getline(list, name, ',');) {
+                networks.push_back(name);
+            }
+        } else if (option == "--output") {
+            output = value;
+        } else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 1;
+        }
+    }
+
+    // Builds with edit logging compiled in would otherwise time the log too
+    Log::instance().setLevel(LogLevel::Warn);
+
+    std::vector<Result> results;
+    for (const std::string& name : networks) {
+        for (std::size_t target = 1000; target <= maxSegments && target <= 10000000; target *= 10) {
+            RoadNetwork network;
+            if (!makeRoadNetwork(name, target, network)) {
+                std::cerr << "Unknown network " << name << std::endl;
+                return 1;
+            }
+            std::cerr << name << ": " << network.points.size() << " points, " << network.segments.size()
+                      << " segments" << std::endl;
+            benchmarkNetwork(name, network, results);
+        }
+    }
+
+    std::FILE* file = output.empty() ? stdout : std::fopen(output.c_str(), "w");
+    if (!file) {
+        std::cerr << "Cannot write " << output << std::endl;
+        return 1;
+    }
+    writeJson(file, results);
+    if (file != stdout) {
+        std::fclose(file);
+    }
+    return 0;
+}
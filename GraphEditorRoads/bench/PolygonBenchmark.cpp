@@ -0,0 +1,60 @@
+// Measures Polygon containment throughput, one point at a time and in batches, for
+// an envelope outline and for a larger footprint, and checks both paths agree.
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "Constants.h"
+#include "Envelope.h"
+#include "Polygon.h"
+#include "RoadNetworks.h"
+#include "Stopwatch.h"
+
+static void runBenchmark(const char* name, const Polygon& polygon, std::size_t pointCount) {
+    // Points spread over the bounding box, as left after a spatial index has culled the rest
+    const AABB& bounds = polygon.getBounds();
+    std::vector<Point> points = scatterPoints(pointCount, bounds.minX, bounds.minY, bounds.maxX, bounds.maxY);
+    std::vector<float> xs(pointCount), ys(pointCount);
+    for (std::size_t i = 0; i < pointCount; ++i) {
+        xs[i] = points[i].x;
+        ys[i] = points[i].y;
+    }
+
+    Stopwatch timer;
+    std::size_t singleInside = 0;
+    for (std::size_t i = 0; i < pointCount; ++i) {
+        singleInside += polygon.contains(xs[i], ys[i]);
+    }
+    double singleTime = timer.microseconds();
+
+    std::vector<std::uint8_t> inside(pointCount);
+    timer.restart();
+    polygon.contains(xs.data(), ys.data(), pointCount, inside.data());
+    double batchTime = timer.microseconds();
+    std::size_t batchInside = 0;
+    for (std::uint8_t flag : inside) {
+        batchInside += flag;
+    }
+
+    std::printf("%-10s %4zu vertices | single %7.1f M tests/s | batch %7.1f M tests/s | %4.1f%% inside%s\n",
+                name, polygon.size(), pointCount / singleTime, pointCount / batchTime,
+                100.0 * batchInside / pointCount, singleInside == batchInside ? "" : " | MISMATCH");
+}
+
+int main() {
+    VertexBuffer vertices;
+    Handle a = vertices.add(0.0f, 0.0f);
+    Handle b = vertices.add(240.0f, 90.0f);
+    Envelope envelope(Segment(a.index, b.index), ROAD_WIDTH);
+    runBenchmark("envelope", envelope.getOutline(vertices), 4000000);
+
+    // A star shaped footprint with plenty of concave corners
+    std::vector<Point> star;
+    for (int i = 0; i < 128; ++i) {
+        float angle = static_cast<float>(2 * MY_PI * i / 128);
+        float radius = i % 2 ? 40.0f : 100.0f;
+        star.push_back(Point(radius * std::cos(angle), radius * std::sin(angle)));
+    }
+    runBenchmark("footprint", Polygon(star), 1000000);
+    return 0;
+}
@@ -0,0 +1,47 @@
+// Measures the headless render path: tiles rasterized on the CPU at each level of detail,
+// and a whole tile pyramid exported with one thread and with every core. Needs no window.
+#include <cstdio>
+#include <filesystem>
+#include <thread>
+#include <vector>
+#include "RoadNetworks.h"
+#include "SoftwareRenderer.h"
+#include "Stopwatch.h"
+#include "TileExporter.h"
+
+int main() {
+    // A 200 by 200 block grid with jittered nodes, so envelopes meet at slightly uneven angles
+    RoadNetwork network = makeGridCity(2 * 200 * 200);
+    Graph city(network.points, network.segments);
+    std::printf("%zu points, %zu segments\n", city.vertices.size(), city.segments.size());
+
+    RoadBorders borders;
+    Stopwatch timer;
+    borders.rebuild(city);
+    std::printf("road borders built in %.0f ms\n", timer.milliseconds());
+
+    SoftwareRenderer renderer(city, &borders);
+    renderer.loadRoadTexture("Assets/road.png");
+    std::vector<std::uint8_t> pixels;
+    // Tiles of 256 pixels covering 256, 1024 and 8192 world units: full detail, then centerlines
+    for (float size : {256.0f, 1024.0f, 8192.0f}) {
+        const int tiles = 50;
+        timer.restart();
+        for (int i = 0; i < tiles; ++i) {
+            renderer.render(sf::FloatRect(i * 97.0f, i * 61.0f, size, size), 256, 256, pixels);
+        }
+        std::printf("256 px tile over %5.0f world units: %7.2f ms\n", size, timer.milliseconds() / tiles);
+    }
+
+    TileExporter exporter(city);
+    exporter.loadRoadTexture("Assets/road.png");
+    std::string directory = (std::filesystem::temp_directory_path() / "graph_tiles").string();
+    for (unsigned threads : {1u, std::max(1u, std::thread::hardware_concurrency())}) {
+        timer.restart();
+        std::size_t written = exporter.exportPyramid(directory, 5, threads);
+        std::printf("pyramid to zoom 5 with %2u threads: %zu tiles in %.0f ms\n", threads, written,
+                    timer.milliseconds());
+    }
+    std::filesystem::remove_all(directory);
+    return 0;
+}
@@ -0,0 +1,156 @@
+#include "RoadNetworks.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include "Constants.h"
+
+// Smallest lattice side whose streets reach the target, given the streets per node
+static std::uint32_t latticeSide(std::size_t targetSegments, double segmentsPerNode) {
+    return std::max<std::uint32_t>(2, static_cast<std::uint32_t>(std::ceil(std::sqrt(targetSegments / segmentsPerNode))));
+}
+
+RoadNetwork makeGridCity(std::size_t targetSegments, unsigned seed) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> jitter(-8.0f, 8.0f);
+    std::uint32_t side = latticeSide(targetSegments, 2.0);
+    RoadNetwork network;
+    network.points.reserve(static_cast<std::size_t>(side) * side);
+    network.segments.reserve(2 * static_cast<std::size_t>(side) * side);
+    for (std::uint32_t y = 0; y < side; ++y) {
+        for (std::uint32_t x = 0; x < side; ++x) {
+            network.points.push_back(Point(x * 120.0f + jitter(random), y * 120.0f + jitter(random)));
+            std::uint32_t index = y * side + x;
+            if (x > 0) network.segments.push_back(Segment(index - 1, index));
+            if (y > 0) network.segments.push_back(Segment(index - side, index));
+        }
+    }
+    return network;
+}
+
+RoadNetwork makeRandomPlanar(std::size_t targetSegments, unsigned seed) {
+    std::mt19937 random(seed);
+    // Jitter under a quarter of the spacing keeps every cell convex, so a diagonal
+    // stays inside its cell and crosses nothing.
+    std::uniform_real_distribution<float> jitter(-24.0f, 24.0f);
+    std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+    std::uint32_t side = latticeSide(targetSegments, 2.1);
+    RoadNetwork network;
+    network.points.reserve(static_cast<std::size_t>(side) * side);
+    network.segments.reserve(3 * static_cast<std::size_t>(side) * side);
+    for (std::uint32_t y = 0; y < side; ++y) {
+        for (std::uint32_t x = 0; x < side; ++x) {
+            network.points.push_back(Point(x * 100.0f + jitter(random), y * 100.0f + jitter(random)));
+            std::uint32_t index = y * side + x;
+            if (x > 0 && chance(random) < 0.85f) network.segments.push_back(Segment(index - 1, index));
+            if (y > 0 && chance(random) < 0.85f) network.segments.push_back(Segment(index - side, index));
+            if (x > 0 && y > 0 && chance(random) < 0.4f) {
+                // One of the cell's two diagonals, never both
+                if (chance(random) < 0.5f) {
+                    network.segments.push_back(Segment(index - side - 1, index));
+                } else {
+                    network.segments.push_back(Segment(index - side, index - 1));
+                }
+            }
+        }
+    }
+    return network;
+}
+
+RoadNetwork makeRadialTowns(std::size_t targetSegments, unsigned seed) {
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> ringCount(3, 10);
+    std::uniform_real_distribution<float> jitter(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+    const float ringSpacing = 80.0f;
+    const float townSpacing = 2 * 10 * ringSpacing + 400.0f;
+    // A town of the average 6.5 rings has close to 300 roads
+    std::uint32_t columns = latticeSide(targetSegments, 300.0);
+
+    // First point and ring count of each town so far, for the highways
+    struct Town {
+        std::uint32_t centre;
+        int rings;
+    };
+    std::vector<Town> towns;
+    RoadNetwork network;
+    auto outerPoint = [](const Town& town, int eighth) {
+        // Ring k has 8k points, so the outer ring's point at eighth e of a turn is e * rings
+        return town.centre + 4 * (town.rings - 1) * town.rings + eighth * town.rings + 1;
+    };
+
+    for (std::uint32_t index = 0; network.segments.size() < targetSegments; ++index) {
+        std::uint32_t column = index % columns, row = index / columns;
+        float centreX = column * townSpacing + jitter(random), centreY = row * townSpacing + jitter(random);
+        Town town = {static_cast<std::uint32_t>(network.points.size()), ringCount(random)};
+        network.points.push_back(Point(centreX, centreY));
+        for (int ring = 1; ring <= town.rings; ++ring) {
+            // Points of this ring start at ringStart; the previous ring's at innerStart
+            std::uint32_t ringStart = town.centre + 4 * (ring - 1) * ring + 1;
+            std::uint32_t innerStart = town.centre + 4 * (ring - 2) * (ring - 1) + 1;
+            int count = 8 * ring;
+            for (int i = 0; i < count; ++i) {
+                float angle = static_cast<float>(2 * MY_PI * i / count);
+                network.points.push_back(Point(centreX + ring * ringSpacing * std::cos(angle),
+                                               centreY + ring * ringSpacing * std::sin(angle)));
+                network.segments.push_back(Segment(ringStart + i, ringStart + (i + 1) % count));
+                // Eight avenues run out from the centre; side streets join some ring points
+                // to the ring inside, keeping their order around the town so none cross.
+                if (ring == 1) {
+                    network.segments.push_back(Segment(town.centre, ringStart + i));
+                } else if (i % ring == 0 || chance(random) < 0.2f) {
+                    network.segments.push_back(Segment(innerStart + i * (ring - 1) / ring, ringStart + i));
+                }
+            }
+        }
+        // Highways to the towns on the left and above
+        if (column > 0) {
+            network.segments.push_back(Segment(outerPoint(towns[index - 1], 0), outerPoint(town, 4)));
+        }
+        if (row > 0) {
+            network.segments.push_back(Segment(outerPoint(towns[index - columns], 2), outerPoint(town, 6)));
+        }
+        towns.push_back(town);
+    }
+    return network;
+}
+
+bool makeRoadNetwork(const std::string& name, std::size_t targetSegments, RoadNetwork& network, unsigned seed) {
+    if (name == "grid") {
+        network = makeGridCity(targetSegments, seed);
+    } else if (name == "planar") {
+        network = makeRandomPlanar(targetSegments, seed);
+    } else if (name == "radial") {
+        network = makeRadialTowns(targetSegments, seed);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::vector<Point> scatterPoints(std::size_t count, float minX, float minY, float maxX, float maxY, unsigned seed) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> x(minX, maxX);
+    std::uniform_real_distribution<float> y(minY, maxY);
+    std::vector<Point> points(count);
+    for (Point& point : points) {
+        // Separate statements, as the order of evaluation of arguments is unspecified
+        float px = x(random);
+        point = Point(px, y(random));
+    }
+    return points;
+}
+
+void networkBounds(const RoadNetwork& network, float& minX, float& minY, float& maxX, float& maxY) {
+    minX = minY = maxX = maxY = 0;
+    if (network.points.empty()) {
+        return;
+    }
+    minX = maxX = network.points[0].x;
+    minY = maxY = network.points[0].y;
+    for (const Point& point : network.points) {
+        minX = std::min(minX, point.x);
+        maxX = std::max(maxX, point.x);
+        minY = std::min(minY, point.y);
+        maxY = std::max(maxY, point.y);
+    }
+}
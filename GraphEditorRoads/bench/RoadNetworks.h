@@ -0,0 +1,39 @@
+#ifndef ROADNETWORKS_H
+#define ROADNETWORKS_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "Point.h"
+#include "Segment.h"
+
+// Synthetic road networks for benchmarks. Segments refer to points by their position in
+// the list, as Graph's constructor expects. Like real maps the networks are (nearly)
+// planar, with roads meeting at shared points. The same seed always gives the same network.
+struct RoadNetwork {
+    std::vector<Point> points;
+    std::vector<Segment> segments;
+};
+
+// Square city blocks with slightly jittered corners.
+RoadNetwork makeGridCity(std::size_t targetSegments, unsigned seed = 42);
+
+// A jittered lattice with random streets removed and random diagonals added, giving
+// junctions of one to six roads at uneven angles.
+RoadNetwork makeRandomPlanar(std::size_t targetSegments, unsigned seed = 42);
+
+// Towns of ring roads and spokes around a centre, like old European towns on OSM, joined
+// to their neighbours by straight highways.
+RoadNetwork makeRadialTowns(std::size_t targetSegments, unsigned seed = 42);
+
+// Builds a network by name: "grid", "planar" or "radial". Returns false for other names.
+bool makeRoadNetwork(const std::string& name, std::size_t targetSegments, RoadNetwork& network, unsigned seed = 42);
+
+// Points spread evenly over a rectangle, such as query positions over a network's bounds.
+std::vector<Point> scatterPoints(std::size_t count, float minX, float minY, float maxX, float maxY,
+                                 unsigned seed = 42);
+
+// Bounds of a network's points, written to the four floats; all zero for no points.
+void networkBounds(const RoadNetwork& network, float& minX, float& minY, float& maxX, float& maxY);
+
+#endif // ROADNETWORKS_H
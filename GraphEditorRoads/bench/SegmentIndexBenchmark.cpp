@@ -0,0 +1,96 @@
+// Compares nearest-segment and point hit-test queries through the AABBTree
+// against the linear scan Graph used before, at growing segment counts.
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <vector>
+#include "AABBTree.h"
+#include "Constants.h"
+#include "Point.h"
+#include "RoadNetworks.h"
+#include "Stopwatch.h"
+#include "utils.h"
+
+struct BenchSegment {
+    Point p1, p2;
+};
+
+static AABB envelopeBounds(const BenchSegment& segment) {
+    float padding = ROAD_WIDTH / 2.0f;
+    return {std::min(segment.p1.x, segment.p2.x) - padding, std::min(segment.p1.y, segment.p2.y) - padding,
+            std::max(segment.p1.x, segment.p2.x) + padding, std::max(segment.p1.y, segment.p2.y) + padding};
+}
+
+static void runBenchmark(size_t segmentCount) {
+    // Irregular street blocks whose area grows with the segment count, so the density
+    // stays close to a real city map
+    RoadNetwork network = makeRandomPlanar(segmentCount);
+    std::vector<BenchSegment> segments(network.segments.size());
+    for (size_t i = 0; i < segments.size(); ++i) {
+        segments[i].p1 = network.points[network.segments[i].a];
+        segments[i].p2 = network.points[network.segments[i].b];
+    }
+
+    Stopwatch timer;
+    AABBTree tree;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        tree.insert(static_cast<int>(i), envelopeBounds(segments[i]));
+    }
+    double buildTime = timer.microseconds();
+
+    float minX, minY, maxX, maxY;
+    networkBounds(network, minX, minY, maxX, maxY);
+    std::vector<Point> queries = scatterPoints(segmentCount >= 1000000 ? 50 : 200, minX, minY, maxX, maxY);
+
+    // Linear scan, as Graph::findNearestSegment used to do it. Streets share their ends,
+    // so the two searches are compared by distance, which ties cannot change.
+    timer.restart();
+    double linearChecksum = 0;
+    for (const auto& query : queries) {
+        int nearest = -1;
+        float minDistance = std::numeric_limits<float>::max();
+        for (size_t i = 0; i < segments.size(); ++i) {
+            float distance = distanceToSegment(query, segments[i].p1, segments[i].p2);
+            if (distance < minDistance) {
+                minDistance = distance;
+                nearest = static_cast<int>(i);
+            }
+        }
+        linearChecksum += nearest < 0 ? 0 : minDistance;
+    }
+    double linearTime = timer.microseconds() / queries.size();
+
+    timer.restart();
+    double treeChecksum = 0;
+    for (const auto& query : queries) {
+        int nearest = tree.nearest(query.x, query.y, [&](int id) {
+            return distanceToSegment(query, segments[id].p1, segments[id].p2);
+        });
+        treeChecksum += nearest < 0 ? 0 : distanceToSegment(query, segments[nearest].p1, segments[nearest].p2);
+    }
+    double treeTime = timer.microseconds() / queries.size();
+
+    timer.restart();
+    long long hits = 0;
+    for (const auto& query : queries) {
+        tree.queryPoint(query.x, query.y, [&](int id) {
+            if (distanceToSegment(query, segments[id].p1, segments[id].p2) <= ROAD_WIDTH / 2.0f) {
+                ++hits;
+            }
+            return true;
+        });
+    }
+    double hitTime = timer.microseconds() / queries.size();
+
+    std::printf("%9zu segments | build %9.1f ms | nearest linear %10.2f us | nearest tree %7.2f us | under cursor %6.2f us | height %d%s\n",
+                segments.size(), buildTime / 1000.0, linearTime, treeTime, hitTime, tree.getHeight(),
+                linearChecksum == treeChecksum ? "" : " | MISMATCH");
+    (void)hits;
+}
+
+int main() {
+    for (size_t segmentCount : {10000u, 100000u, 1000000u}) {
+        runBenchmark(segmentCount);
+    }
+    return 0;
+}
@@ -0,0 +1,23 @@
+#ifndef STOPWATCH_H
+#define STOPWATCH_H
+
+#include <chrono>
+
+// Wall clock time since construction or the last restart, for the benchmarks' reports.
+class Stopwatch {
+public:
+    Stopwatch() : start(std::chrono::steady_clock::now()) {}
+
+    void restart() { start = std::chrono::steady_clock::now(); }
+
+    double seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    double milliseconds() const { return seconds() * 1e3; }
+    double microseconds() const { return seconds() * 1e6; }
+
+private:
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif // STOPWATCH_H
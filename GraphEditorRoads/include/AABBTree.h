@@ -0,0 +1,182 @@
+#ifndef AABBTREE_H
+#define AABBTREE_H
+
+#include <cstddef>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Axis aligned bounding box in world coordinates.
+struct AABB {
+    float minX, minY, maxX, maxY;
+
+    bool contains(const AABB& other) const {
+        return minX <= other.minX && minY <= other.minY && maxX >= other.maxX && maxY >= other.maxY;
+    }
+
+    bool overlaps(const AABB& other) const {
+        return minX <= other.maxX && other.minX <= maxX && minY <= other.maxY && other.minY <= maxY;
+    }
+
+    bool contains(float x, float y) const {
+        return x >= minX && x <= maxX && y >= minY && y <= maxY;
+    }
+
+    // Squared distance from a point to the box, zero when the point is inside.
+    float distanceSquared(float x, float y) const {
+        float dx = x < minX ? minX - x : (x > maxX ? x - maxX : 0.0f);
+        float dy = y < minY ? minY - y : (y > maxY ? y - maxY : 0.0f);
+        return dx * dx + dy * dy;
+    }
+
+    float perimeter() const {
+        return 2.0f * ((maxX - minX) + (maxY - minY));
+    }
+
+    static AABB merge(const AABB& a, const AABB& b) {
+        return {a.minX < b.minX ? a.minX : b.minX, a.minY < b.minY ? a.minY : b.minY,
+                a.maxX > b.maxX ? a.maxX : b.maxX, a.maxY > b.maxY ? a.maxY : b.maxY};
+    }
+};
+
+// The AABBTree class is a dynamic bounding volume hierarchy keyed by integer ids.
+// Leaves store "fat" boxes padded by a margin so small moves (node drags) only
+// refit when an item actually leaves its padded box. The tree is kept balanced
+// with rotations, so inserts, removals and queries stay logarithmic.
+class AABBTree {
+public:
+    // Constructor: margin is the padding added around every leaf box.
+    explicit AABBTree(float margin = 10.0f);
+
+    // Adds an id with the given bounds. Inserting an existing id updates it instead.
+    void insert(int id, const AABB& bounds);
+
+    // Removes an id from the tree. Unknown ids are ignored.
+    void remove(int id);
+
+    // Refits an id after it moved. Returns true if the tree had to be restructured.
+    bool update(int id, const AABB& bounds);
+
+    void clear();
+    bool contains(int id) const;
+    std::size_t size() const;
+    int getHeight() const;
+
+    // Calls visit(id) for every leaf whose box overlaps bounds.
+    // Returning false from visit stops the query early.
+    template <typename Visitor>
+    void query(const AABB& bounds, Visitor visit) const;
+
+    // Calls visit(id) for every leaf whose box contains (x, y).
+    template <typename Visitor>
+    void queryPoint(float x, float y, Visitor visit) const {
+        query(AABB{x, y, x, y}, visit);
+    }
+
+    // Finds the id minimising exactDistance(id), which must never be smaller than the
+    // distance from (x, y) to that id's box. Returns -1 when the tree is empty.
+    template <typename DistanceFunction>
+    int nearest(float x, float y, DistanceFunction exactDistance, float* outDistance = nullptr) const;
+
+    static const int Null = -1;
+
+    struct Node {
+        AABB box;
+        int parent;
+        int left, right;
+        int height; // Leaves have height 0, free nodes -1
+        int id;
+
+        bool isLeaf() const { return left == Null; }
+    };
+
+    // The nodes as a flat array, for saving a built tree. Free nodes are kept in place.
+    const std::vector<Node>& getNodes() const { return nodes; }
+    int getRoot() const { return root; }
+    float getMargin() const { return margin; }
+
+    // Replaces the tree with nodes saved from another one, without rebuilding it. Returns
+    // false and leaves the tree empty if the nodes do not form a tree.
+    bool assign(const Node* nodes, std::size_t count, int root);
+
+private:
+
+    int allocateNode();
+    void freeNode(int node);
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+    int balance(int node);
+    void fixUpwards(int node);
+
+    std::vector<Node> nodes;
+    int root;
+    int freeList;
+    float margin;
+    std::unordered_map<int, int> leaves;
+};
+
+template <typename Visitor>
+void AABBTree::query(const AABB& bounds, Visitor visit) const {
+    if (root == Null) {
+        return;
+    }
+    std::vector<int> stack;
+    stack.push_back(root);
+    while (!stack.empty()) {
+        int index = stack.back();
+        stack.pop_back();
+        const Node& node = nodes[index];
+        if (!node.box.overlaps(bounds)) {
+            continue;
+        }
+        if (node.isLeaf()) {
+            if (!visit(node.id)) {
+                return;
+            }
+        } else {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+}
+
+template <typename DistanceFunction>
+int AABBTree::nearest(float x, float y, DistanceFunction exactDistance, float* outDistance) const {
+    if (root == Null) {
+        return -1;
+    }
+    int bestId = -1;
+    float bestDistance = std::numeric_limits<float>::max();
+
+    // Best-first descent: always expand the box closest to the query point and stop
+    // once the nearest remaining box is further away than the best exact hit.
+    typedef std::pair<float, int> Candidate;
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> open;
+    open.push({nodes[root].box.distanceSquared(x, y), root});
+    while (!open.empty()) {
+        Candidate candidate = open.top();
+        open.pop();
+        if (candidate.first > bestDistance * bestDistance) {
+            break;
+        }
+        const Node& node = nodes[candidate.second];
+        if (node.isLeaf()) {
+            float distance = exactDistance(node.id);
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                bestId = node.id;
+            }
+        } else {
+            open.push({nodes[node.left].box.distanceSquared(x, y), node.left});
+            open.push({nodes[node.right].box.distanceSquared(x, y), node.right});
+        }
+    }
+    if (outDistance) {
+        *outDistance = bestDistance;
+    }
+    return bestId;
+}
+
+#endif // AABBTREE_H
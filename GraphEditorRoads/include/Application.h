@@ -6,16 +6,27 @@
 #include "GraphEditor.h"
 #include "Viewport.h"
 #include "Button.h"
+#include "EditJournal.h"
+#include "ProfilerOverlay.h"
 #include "World.h"
 
+// The Application class owns the window and runs the editor's event and render loop.
+// The window is only redrawn when an event or a change to the graph invalidates it;
+// with nothing happening the loop sleeps in the window's event queue.
 class Application {
 public:
-    Application();
+    // Constructor: frameLimit caps redraws per second while the mouse just moves about,
+    // dragFrameLimit while a mouse button is held. 0 means no cap.
+    explicit Application(unsigned frameLimit = 60, unsigned dragFrameLimit = 0);
+
+    // Runs until the window is closed.
     void run();
     void update();
     void render();
     bool isRunning() const;
 
+    void setFrameLimits(unsigned frameLimit, unsigned dragFrameLimit);
+
 private:
     sf::RenderWindow window;
     Viewport viewport;
@@ -24,9 +35,38 @@ private:
     World world;
     Button saveButton;
     Button resetButton;
+    // Autosaves every edit to world.graph.journal and folds it into world.graph
+    EditJournal journal;
+
+    unsigned frameLimit;
+    unsigned dragFrameLimit;
+    // Set when what is on screen is out of date
+    bool needsRedraw;
+    // Graph epoch and version last drawn
+    unsigned long long drawnEpoch;
+    unsigned long long drawnVersion;
+    // Mouse buttons currently held; drags are drawn at dragFrameLimit
+    int buttonsHeld;
+
+#ifdef GRAPH_ENABLE_PROFILER
+    // Frame times in the corner, toggled with F3
+    ProfilerOverlay profilerOverlay;
+#endif
 
     void initialize();
     void handleEvents();
+
+    // Folds the journal into world.graph on the journal's thread, so saving never stalls
+    // the editor; the edits themselves are already saved
+    void save();
+
+    // Hands the graph's recorded edits to the journal
+    void journalEdits();
+
+    // Passes an event on, returning whether it may change what is on screen.
+    bool handleEvent(const sf::Event& event);
+
+    void applyFrameLimit();
 };
 
 #endif // APPLICATION_H
@@ -3,4 +3,10 @@
 
 constexpr double MY_PI = 3.14159265358979323846;
 
+// Width of a road envelope in world units
+constexpr float ROAD_WIDTH = 25.0f;
+
+// Points closer than this, in world units, are treated as the same point
+constexpr float SNAP_TOLERANCE = 0.01f;
+
 #endif // CONSTANTS_H_INCLUDED
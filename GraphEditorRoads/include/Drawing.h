@@ -0,0 +1,18 @@
+#ifndef DRAWING_H
+#define DRAWING_H
+
+#include <SFML/Graphics.hpp>
+#include "Point.h"
+#include "Segment.h"
+
+// Draws single points and segments as SFML shapes. Kept out of Point and Segment so the
+// graph core builds without SFML; whole graphs are drawn in batches by the GraphRenderer.
+
+// Draws a point as a circle of the given radius.
+void drawPoint(sf::RenderTarget& target, const Point& point, float size = 12, sf::Color color = sf::Color(0, 0, 0));
+
+// Draws a segment as a line of the given width.
+void drawSegment(sf::RenderTarget& target, const Segment& segment, const VertexBuffer& vertices, float width = 2,
+                 sf::Color color = sf::Color::Black);
+
+#endif // DRAWING_H
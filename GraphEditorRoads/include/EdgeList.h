@@ -0,0 +1,21 @@
+#ifndef EDGELIST_H
+#define EDGELIST_H
+
+#include <vector>
+#include "Point.h"
+#include "Segment.h"
+
+class Graph;
+
+// A graph as two plain lists: points, and segments joining them by position in the
+// point list. It is what Graph's constructor takes, and holds no indexes, envelopes or
+// topology, so batch jobs over huge graphs use it instead of a Graph.
+struct EdgeList {
+    std::vector<Point> points;
+    std::vector<Segment> segments;
+};
+
+// Copies a graph's live points and segments, renumbered from 0.
+EdgeList toEdgeList(const Graph& graph);
+
+#endif // EDGELIST_H
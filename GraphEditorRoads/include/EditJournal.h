@@ -0,0 +1,105 @@
+#ifndef EDITJOURNAL_H
+#define EDITJOURNAL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Graph.h"
+
+// Autosave for the editor. A base graph file holds the graph as it was at some point, and
+// a journal file next to it (the base's name plus ".journal") holds every edit made since,
+// so saving costs in proportion to the edits rather than to the map:
+//
+//   header   32 bytes: "GRAPHJNL", version, byte order mark and the stamp of the base
+//   batches  {payload bytes, checksum} followed by the encoded edits, one batch per write
+//
+// A background thread appends a batch at every write interval and syncs it to disk. Once
+// the journal grows past a limit, or when asked, the same thread compacts: it loads the
+// base into a graph of its own, replays the journal onto it, writes that as the new base
+// and starts an empty journal. The editor's graph is never read from that thread.
+//
+// A journal only replays onto the base carrying the same stamp. Each compaction gives the
+// base a new stamp before the old journal is replaced, so a crash in between leaves a
+// journal that is recognised as already folded in. A batch cut short by a crash fails its
+// checksum, and replay stops before it.
+class EditJournal {
+public:
+    EditJournal();
+    ~EditJournal();
+    EditJournal(const EditJournal&) = delete;
+    EditJournal& operator=(const EditJournal&) = delete;
+
+    // Loads the base into graph and replays the journal onto it, recovering the edits of a
+    // session that did not shut down, then turns on the graph's edit recording and starts
+    // the writer. A missing base gives an empty graph. Returns false and reports on
+    // std::cerr if the base cannot be read.
+    bool open(const std::string& baseFile, Graph& graph);
+
+    // Writes out every queued edit and stops the writer.
+    void close();
+    bool isOpen() const { return writer.joinable(); }
+
+    // Queues edits for the writer. Consecutive moves of one point, as made by a drag, are
+    // merged into a single move.
+    void append(const std::vector<GraphEdit>& edits);
+
+    // Waits until every edit queued so far has been written. Returns false if writing
+    // failed; the edits are kept and tried again at the next interval.
+    bool flush();
+
+    // Asks the writer to fold the journal into a new base at its next pass.
+    void compact();
+
+    // How long queued edits may wait before they are written, and the journal size that
+    // makes the writer compact on its own.
+    void setWriteInterval(std::chrono::milliseconds interval);
+    void setCompactBytes(std::uint64_t bytes);
+
+    // Bytes written to journal and base files since open, for measuring autosave I/O.
+    std::uint64_t getJournalBytesWritten() const;
+    std::uint64_t getBaseBytesWritten() const;
+
+    // Applies the edits of a journal to a graph loaded from the base with the given stamp,
+    // without recording them. Returns the bytes of the journal that were valid, or 0 if it
+    // does not belong to that base or cannot be read.
+    static std::uint64_t replay(const std::string& journalFile, std::uint64_t baseStamp, Graph& graph);
+
+private:
+    void run();
+    bool writeBatch(const std::vector<GraphEdit>& batch);
+    bool compactFiles(const std::vector<GraphEdit>& unwritten);
+    bool startJournal(std::uint64_t stamp);
+
+    std::string baseFile;
+    std::string journalFile;
+
+    // Only touched by the writer once it has started
+    std::FILE* journal;
+    std::uint64_t baseStamp;
+    std::uint64_t journalBytes;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable written;
+    std::vector<GraphEdit> pending;
+    // Appends made, and appends the writer has tried to write
+    std::uint64_t appended;
+    std::uint64_t attempted;
+    std::uint64_t flushTarget;
+    bool failing;
+    bool compactRequested;
+    bool running;
+    std::chrono::milliseconds writeInterval;
+    std::uint64_t compactBytes;
+    std::atomic<std::uint64_t> journalBytesWritten;
+    std::atomic<std::uint64_t> baseBytesWritten;
+    std::thread writer;
+};
+
+#endif // EDITJOURNAL_H
@@ -1,28 +1,41 @@
 #ifndef ENVELOPE_H
 #define ENVELOPE_H
 
-#include "RoundedRectangleShape.h"
+#include <cstddef>
+#include <vector>
 #include "Segment.h"
-#include <memory>
+#include "Polygon.h"
 
+// The Envelope class is the area a road covers around its segment: a rectangle as wide
+// as the road with fully rounded ends. It holds geometry only; the outline is generated
+// from the current end point positions, and drawing is left to the GraphRenderer.
 class Envelope {
 public:
-    Envelope(const Segment& skeleton, double width, int roundness = 1);
-    void draw(sf::RenderWindow& window) const; // For drawing using SFML
+    // Points generated per rounded corner
+    static const int CornerPoints = 5;
+
+    Envelope(const Segment& skeleton, double width);
 
     const Segment& getSkeleton() const;
     double getWidth() const;
 
-    void updateSkeleton(const Segment& newSkeleton);
-    void updateRoundedRect();
+    // Number of points in the outline
+    std::size_t getPointCount() const { return 4 * CornerPoints; }
+
+    // Writes the outline, getPointCount() points in order, at the end points' current positions.
+    void getPolygon(const VertexBuffer& vertices, Point* out) const;
+    std::vector<Point> getPolygon(const VertexBuffer& vertices) const;
+
+    // The outline as a Polygon, for containment and overlap tests. The second form reuses
+    // the polygon's memory.
+    Polygon getOutline(const VertexBuffer& vertices) const;
+    void getOutline(const VertexBuffer& vertices, Polygon& outline) const;
 
-    void setColor(sf::Color newColor);
-    void setTexture(const std::shared_ptr<sf::Texture>& texture);
+    // Writes the outlines of count envelopes back to back, getPointCount() points each.
+    static void getPolygons(const VertexBuffer& vertices, const Envelope* envelopes, std::size_t count, Point* out);
 
 private:
     Segment skeleton;
-    sf::RoundedRectangleShape roundedRect;
-    sf::Texture texture; // Texture member
     double width;
 };
 
@@ -4,22 +4,73 @@
 #include <vector>
 #include "Segment.h"
 #include "Envelope.h"
-#include "ResourceManager.h"
+#include "SpatialGrid.h"
+#include "AABBTree.h"
+#include "Topology.h"
+#include "SlotMap.h"
+#include "VertexBuffer.h"
+#include "SnapIndex.h"
+
+// One edit of a graph, as recorded for the EditJournal. Points are named by position
+// rather than by slot, as slots are renumbered whenever the graph is saved. addPoint and
+// movePoint keep points further apart than the snap tolerance, so a position names one
+// point; graph files are checked for the same when saved and opened.
+struct GraphEdit {
+    enum Type : std::uint8_t {
+        AddPoint = 1,      // at (x1, y1)
+        RemovePoint = 2,   // at (x1, y1), with its segments
+        MovePoint = 3,     // from (x1, y1) to (x2, y2)
+        AddSegment = 4,    // between the points at (x1, y1) and (x2, y2)
+        RemoveSegment = 5, // between the points at (x1, y1) and (x2, y2)
+        Clear = 6,         // every point and segment
+    };
+    Type type;
+    float x1, y1, x2, y2;
+};
 
 // The Graph class represents a collection of points and segments in 2D space.
 class Graph {
 public:
-    // Collections of segments and points in the graph
-    std::vector<Segment> segments;
-    std::vector<Point> points;
-    ResourceManager resourceManager;
+    // Segments of the graph. Each segment's id is its slot index, and the Handles
+    // returned by addSegment stay valid across later edits.
+    SlotMap<Segment> segments;
+    // Positions of the points of the graph. Segments refer to them by slot index,
+    // and a point's id is its slot index.
+    VertexBuffer vertices;
     float minX, maxX, minY, maxY;
+    // Finds the envelope of a segment in O(1), or nullptr
     Envelope* findEnvelope(const Segment& segment);
-    // Index of the last point added to the graph
-    size_t lastPointIndex;
-    std::vector<Envelope> roadEnvelopes;
+    Envelope* findEnvelope(Handle segment);
+    // Handle of the last point added to the graph; stale once that point is removed
+    Handle lastPoint;
+    SlotMap<Envelope> roadEnvelopes;
+    // Handle of each segment's envelope in roadEnvelopes, indexed by segment id
+    std::vector<Handle> segmentEnvelopes;
+    // Uniform grid over point ids, kept in sync by addPoint, removePoint and movePoint
+    SpatialGrid pointIndex;
+    // Bounding volume hierarchy over segment ids, sized to each segment's road envelope
+    AABBTree segmentIndex;
+    // Ids of the segments touching each point
+    Topology topology;
+    // Hashes of point positions and segment end point pairs, for O(1) duplicate checks
+    SnapIndex snapIndex;
+    // Vertex and segment slots added, moved or removed since the last clearChanges,
+    // so retained renderers only rewrite what changed. May hold repeats.
+    std::vector<std::uint32_t> changedVertices;
+    std::vector<std::uint32_t> changedSegments;
+    // Incremented on every edit
+    unsigned long long version;
+    // Unique to each graph built from scratch, by construction, assign or clear. The
+    // version may start over on a new graph, so caches check both.
+    unsigned long long epoch;
+    // While recordEdits is set, the edits made through the public methods since the last
+    // clearEdits, in order. Replacing the whole graph by assign or assignment records nothing.
+    bool recordEdits;
+    std::vector<GraphEdit> edits;
 
     // Constructor: Initializes a new graph with optional predefined points and segments.
+    // The end points of the predefined segments are positions in the points list.
+    // Points within snap tolerance of each other are merged, and duplicate segments dropped.
     Graph(const std::vector<Point>& points = {},
       const std::vector<Segment>& segments = {},
       float minX = std::numeric_limits<float>::max(),
@@ -27,21 +78,67 @@ public:
       float minY = std::numeric_limits<float>::max(),
       float maxY = std::numeric_limits<float>::lowest());
 
+    // Replaces the graph with trusted arrays, such as those of a mapped graph file. Vertex i
+    // goes to slot i, and segment j joins vertices segmentEnds[2j] and segmentEnds[2j + 1]
+    // and gets id j. Nothing is snapped or checked for duplicates. A saved segment tree
+    // whose leaves are segment ids is used as is; without one the tree is rebuilt.
+    void assign(const float* xs, const float* ys, std::size_t vertexCount,
+                const std::uint32_t* segmentEnds, std::size_t segmentCount,
+                const AABBTree::Node* treeNodes = nullptr, std::size_t treeNodeCount = 0, int treeRoot = -1);
+
     Envelope createRoadEnvelope(const Segment& segment, double width);
 
-    std::vector<Segment>& getConnectedSegments(const Point& point);
-    std::vector<int> getConnectedSegmentIds(const Point& point);
+    // Gets the segments touching a point
+    std::vector<Segment> getConnectedSegments(Handle point);
+    std::vector<int> getConnectedSegmentIds(Handle point);
 
-    void updateEnvelope(Segment& segment);
+    // Builds a compact read-only copy of the point to segment incidence lists
+    TopologySnapshot buildTopologySnapshot() const;
 
     Segment* findNearestSegment(const Point& point);
 
+    // Finds the segment whose road envelope lies under a given point, or nullptr
+    Segment* findSegmentAt(const Point& point);
+
+    // Finds every segment whose road envelope overlaps the rectangle spanned by two corners
+    std::vector<Segment*> findSegmentsInRect(const Point& topLeft, const Point& bottomRight);
+
+    // Finds a segment by its id, or nullptr if it is not in the graph
+    Segment* findSegmentById(int id);
+
+    // Refits a segment in the spatial index after one of its end points moved
+    void updateSegmentBounds(const Segment& segment);
+
+    // Finds every point where two segments of the graph cross
     std::vector<Point> findIntersections();
-    // Adds a point to the graph
-    void addPoint(const Point& point);
 
-    // Adds a segment to the graph
-    void addSegment(const Segment& seg);
+    // Finds the points where a single segment crosses the rest of the graph
+    std::vector<Point> findIntersections(const Segment& segment);
+    // Adds a point to the graph and returns its handle, or a null handle if it already exists
+    Handle addPoint(const Point& point);
+
+    // Returns the point within snap tolerance of the given one, adding it if there is none
+    Handle snapPoint(const Point& point);
+
+    // Changes how close two points must be to count as the same point
+    void setSnapTolerance(float tolerance);
+    float getSnapTolerance() const;
+
+    // Adds a segment between two vertex indexes and returns its handle,
+    // or a null handle if the segment already exists or joins a point to itself
+    Handle addSegment(const Segment& seg);
+
+    // Checks whether a handle still names a point of the graph
+    bool containsPoint(Handle handle) const;
+
+    // Copies out the position of a live point; its id is the vertex index
+    Point getPoint(Handle handle) const;
+
+    // Resolves a segment handle, returning nullptr once the segment has been removed
+    Segment* getSegment(Handle handle);
+
+    // Gets the handle of a point stored in the graph
+    Handle getPointHandle(const Point& point) const;
 
     // Tries to add a point to the graph, returns true if added successfully
     bool tryAddPoint(const Point& point);
@@ -49,32 +146,66 @@ public:
     // Tries to add a segment to the graph, returns true if added successfully
     bool tryAddSegment(const Segment& seg);
 
-    // Removes a point from the graph
+    // Removes a point and the segments touching it from the graph
     void removePoint(const Point& point);
+    void removePoint(Handle handle);
 
     // Removes a segment from the graph
     void removeSegment(const Segment& seg);
-    void removeSegmentById(const std::string& segmentId);
-    // Checks if the graph contains a specific point
+    void removeSegmentById(int segmentId);
+    // Checks if the graph contains a point within snap tolerance
     bool containsPoint(const Point& point) const;
 
-    // Checks if the graph contains a specific segment
+    // Checks if the graph contains a segment joining the same points
     bool containsSegment(const Segment& seg) const;
 
-    // Finds the nearest point in the graph to a given point
-    Point* findNearestPoint(const Point& newPoint);
+    // Finds the nearest point in the graph to a given point, or a null handle
+    Handle findNearestPoint(const Point& newPoint);
+
+    // Finds the k points closest to a given point, nearest first
+    std::vector<Handle> findNearestPoints(const Point& point, size_t k);
+
+    // Finds every point within radius of a given point
+    std::vector<Handle> findPointsInRadius(const Point& center, float radius);
+
+    // Finds every point inside the rectangle spanned by two corners
+    std::vector<Handle> findPointsInRect(const Point& topLeft, const Point& bottomRight);
+
+    // Moves a point. Segments read their end points from the vertex buffer, so only the
+    // spatial indexes need refreshing. A move within snap tolerance of another point is
+    // refused and not recorded, so two points never share a position. Returns whether
+    // the point moved.
+    bool movePoint(Handle handle, float x, float y);
+
+    // Sets the last point added to the graph
+    void setLastPoint(Handle handle);
+
+    // Gets the last point added to the graph, or a null handle
+    Handle getLastPoint() const;
+
+    // Forgets the changed slot lists once a renderer has caught up with them
+    void clearChanges();
+
+    // Forgets the recorded edits once they have been journaled
+    void clearEdits();
 
-    // Sets the index of the last point added to the graph
-    void setLastPointIndex(int index);
+    // Repeats an edit recorded on another graph. Edits naming points that are not here do nothing.
+    void applyEdit(const GraphEdit& edit);
 
-    // Gets the last point added to the graph
-    const Point* getLastPoint() const;
+    // Removes every point and segment, keeping the snap tolerance and edit recording
+    void clear();
 
     void updateBoundary(const Point& newPoint);
     void updateGraph();
-    float calculateDistanceFromPointToSegment(const Point& point, const Segment& segment);
-    // Draws the graph on an SFML render window
-    void draw(sf::RenderWindow& window);
+    float calculateDistanceFromPointToSegment(const Point& point, const Segment& segment) const;
+
+private:
+    void rebuildIndexes(bool segmentTree = true);
+    void attachEnvelope(const Segment& segment);
+    void markVertex(std::uint32_t index);
+    void markSegment(std::uint32_t index);
+    void recordEdit(GraphEdit::Type type, float x1, float y1, float x2 = 0, float y2 = 0);
+    void removeSegmentAt(Handle handle);
 };
 
 #endif // GRAPH_H
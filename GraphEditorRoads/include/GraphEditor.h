@@ -7,6 +7,7 @@
 #include <stack>
 #include <vector>
 #include "Envelope.h"
+#include "GraphRenderer.h"
 
 // The GraphEditor class manages the interaction and visualization of a Graph object.
 class GraphEditor {
@@ -29,6 +30,9 @@ public:
 
     // Draws a temporary point at the current mouse cursor position.
     void drawTemporaryPoint();
+
+    // Forgets the selected and hovered points, e.g. after the graph was replaced.
+    void clearSelection();
     Viewport& viewport;
 
 private:
@@ -41,10 +45,13 @@ private:
     // Reference to the graph being edited.
     Graph& graph;
 
+    // Batched drawing of the graph's segments and points.
+    GraphRenderer renderer;
 
-    // Pointers to the currently selected and hovered points.
-    Point* selected;
-    Point* hovered;
+    // Handles to the currently selected and hovered points. Unlike raw pointers
+    // they survive the graph growing and resolve to nothing once the point is removed.
+    Handle selected;
+    Handle hovered;
 
     // Flag to indicate if a point is being dragged.
     bool dragging;
@@ -59,12 +66,10 @@ private:
     void handleRightMouseDown(const sf::Event& event);
 
     // Selects a given point.
-    void selectPoint(Point* point);
+    void selectPoint(Handle point);
 
     // Removes a given point from the graph.
-    void removePoint(Point* point);
-
-    void updateConnectedSegmentsAndEnvelopes(const Point& selectedPoint);
+    void removePoint(Handle point);
 
     // Draws a dashed line between two points.
     void drawDashedLine(const sf::Vector2f& start, const sf::Vector2f& end, const sf::Color& color, float thickness);
@@ -0,0 +1,110 @@
+#ifndef GRAPHFILE_H
+#define GRAPHFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include "AABBTree.h"
+#include "EdgeList.h"
+
+class Graph;
+
+// Binary graph files (.graph). Arrays are stored the way they sit in memory, so a file is
+// opened by mapping it and reading the arrays in place, with nothing to parse:
+//
+//   header        64 bytes: "GRAPHBIN", version, byte order mark, vertex and segment
+//                 counts, bounds, the number of sections and the journal stamp
+//   section table one {type, offset, bytes} entry per section
+//   sections      each starting on a 64 byte boundary
+//     VertexX       float[vertexCount]
+//     VertexY       float[vertexCount]
+//     Segments      uint32[2 * segmentCount], the two vertex indexes of each segment
+//     SegmentTree   optional: root, margin and nodes of the segment AABBTree, with segment
+//                   indexes as leaf ids, so loading can skip building the tree
+//
+// Readers skip section types they do not know, so new optional sections keep the version;
+// it only changes when an existing section changes meaning. Files are written in the
+// machine's byte order and a reader on a machine of the other order refuses them.
+class GraphFile {
+public:
+    static const std::uint32_t Version = 1;
+
+    GraphFile() = default;
+    ~GraphFile();
+    GraphFile(const GraphFile&) = delete;
+    GraphFile& operator=(const GraphFile&) = delete;
+
+    // Maps a file and checks its header, sections and indexes, that no two points lie
+    // within snap tolerance of each other, and that no segment joins a point to itself or
+    // repeats another. Returns false and reports on std::cerr if it
+    // cannot be read or is not a valid graph file.
+    bool open(const std::string& filename);
+    void close();
+    bool isOpen() const { return data != nullptr; }
+
+    // The arrays point into the mapping and stay valid until the file is closed.
+    std::size_t getVertexCount() const { return vertexCount; }
+    std::size_t getSegmentCount() const { return segmentCount; }
+    const float* getXs() const { return xs; }
+    const float* getYs() const { return ys; }
+    const std::uint32_t* getSegmentEnds() const { return segmentEnds; }
+    AABB getBounds() const { return bounds; }
+
+    // Pairs the file with the EditJournal written on top of it; 0 when it has none.
+    std::uint64_t getJournalStamp() const { return journalStamp; }
+
+    // The saved segment tree; no nodes when the file has none.
+    const AABBTree::Node* getTreeNodes() const { return treeNodes; }
+    std::size_t getTreeNodeCount() const { return treeNodeCount; }
+    int getTreeRoot() const { return treeRoot; }
+    float getTreeMargin() const { return treeMargin; }
+
+private:
+    bool readSections(const std::string& filename);
+    void unmap();
+
+    const unsigned char* data = nullptr;
+    std::size_t size = 0;
+#ifdef _WIN32
+    void* file = nullptr;
+    void* mapping = nullptr;
+#endif
+
+    std::size_t vertexCount = 0, segmentCount = 0;
+    const float* xs = nullptr;
+    const float* ys = nullptr;
+    const std::uint32_t* segmentEnds = nullptr;
+    AABB bounds = {0, 0, 0, 0};
+    const AABBTree::Node* treeNodes = nullptr;
+    std::size_t treeNodeCount = 0;
+    int treeRoot = AABBTree::Null;
+    float treeMargin = 0;
+    std::uint64_t journalStamp = 0;
+};
+
+// Writes a graph, streaming straight from its arrays. Points removed in the editor leave
+// holes in the vertex slots, which are closed up on the way out. With withSegmentTree the
+// built segment index is saved too. The file is written next to the old one, synced to
+// disk and only then moved over it, and the move is synced too, so a power cut leaves
+// either file whole. Returns false and reports on std::cerr on failure.
+bool saveGraph(const std::string& filename, const Graph& graph, bool withSegmentTree = true,
+               std::uint64_t journalStamp = 0);
+bool saveGraph(const std::string& filename, const EdgeList& graph);
+
+// Replaces a graph with the contents of a graph file. Returns false and reports on
+// std::cerr on failure, leaving the graph unchanged.
+bool loadGraph(const std::string& filename, Graph& graph);
+bool loadGraph(const std::string& filename, EdgeList& graph);
+
+// Same, from a file already open.
+void loadGraph(const GraphFile& file, Graph& graph);
+
+// Pushes a file's buffered writes through to the disk.
+bool syncFile(std::FILE* file);
+
+// Makes the creation or renaming of a file in a directory survive a power cut. Windows
+// renames through the disk already, so there it does nothing.
+bool syncDirectory(const std::string& filename);
+
+#endif // GRAPHFILE_H
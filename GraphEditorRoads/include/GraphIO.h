@@ -0,0 +1,19 @@
+#ifndef GRAPHIO_H
+#define GRAPHIO_H
+
+#include <string>
+#include "EdgeList.h"
+
+// Reading and writing graphs as files. Functions return false and report on std::cerr
+// when a file cannot be read or written.
+
+// Reads the vertices ("v x y") and lines ("l i j ...") of a Wavefront OBJ file. Each line
+// record becomes a chain of segments. Indices start at 1, negative ones count back from
+// the last vertex; z coordinates and every other record are ignored.
+bool loadObj(const std::string& filename, EdgeList& graph);
+
+// Writes the graph as OBJ vertices and two point lines, readable by loadObj and by
+// 3D and GIS tools.
+bool saveObj(const std::string& filename, const EdgeList& graph);
+
+#endif // GRAPHIO_H
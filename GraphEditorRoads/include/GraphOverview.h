@@ -0,0 +1,53 @@
+#ifndef GRAPHOVERVIEW_H
+#define GRAPHOVERVIEW_H
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+#include "Graph.h"
+
+// The GraphOverview class holds the simplified forms of a graph drawn when zoomed out.
+// Centerlines: chains of nearly collinear segments through nodes of degree two are
+// merged into single lines, so long straight roads cost one line however finely they
+// are split. Density: node counts binned into square cells, drawn as shaded quads.
+// Both are rebuilt only when the graph epoch, version or the density cell size changes.
+class GraphOverview {
+public:
+    GraphOverview();
+
+    // Rebuilds the merged centerlines if the graph changed since the last call.
+    void updateCenterlines(const Graph& graph);
+
+    // Rebuilds the density cells if the graph or the cell size changed since the last call.
+    void updateDensity(const Graph& graph, float cellSize);
+
+    // Draws the merged centerlines overlapping the visible area.
+    void drawCenterlines(sf::RenderTarget& target, const Graph& graph, const sf::FloatRect& visibleArea);
+
+    // Draws the density cells.
+    void drawDensity(sf::RenderTarget& target);
+
+    // Number of merged centerlines
+    std::size_t getLineCount() const { return lines.getVertexCount() / 2; }
+
+    // Largest turn, in radians, between segments merged into one centerline
+    static constexpr float MergeAngle = 0.035f;
+
+private:
+    sf::VertexArray lines;
+    // Merged line drawn for each segment slot, -1 for free slots
+    std::vector<int> lineOfSegment;
+    unsigned long long linesEpoch, linesVersion;
+    bool hasLines;
+
+    sf::VertexArray densityQuads;
+    unsigned long long densityEpoch, densityVersion;
+    float densityCellSize;
+
+    // Scratch state for culled drawing
+    sf::VertexArray visibleLines;
+    std::vector<unsigned> lineStamps;
+    unsigned stamp;
+};
+
+#endif // GRAPHOVERVIEW_H
@@ -0,0 +1,42 @@
+#ifndef GRAPHPROCESSING_H
+#define GRAPHPROCESSING_H
+
+#include <cstddef>
+#include <vector>
+#include "Constants.h"
+#include "EdgeList.h"
+
+// Whole-graph clean-up passes for batch jobs, such as preparing imported maps for the
+// editor. They work on plain EdgeLists and need no window, so they run on servers.
+
+// Merges points closer than tolerance into the first of them, then drops the segments
+// left with zero length and all but the first of repeated ones.
+void dedupe(EdgeList& graph, float tolerance = SNAP_TOLERANCE);
+
+// Splits segments where they cross, so that roads only meet at shared points.
+// Returns the number of crossings found.
+std::size_t splitCrossings(EdgeList& graph);
+
+// Removes points along chains of roads (points joining exactly two segments) wherever the
+// chain stays within tolerance of the simplified one, with Douglas-Peucker. Junctions,
+// dead ends and isolated points stay; loops keep at least three points.
+void simplify(EdgeList& graph, float tolerance);
+
+struct GraphStats {
+    std::size_t points = 0;
+    std::size_t segments = 0;
+    // Points of no segment
+    std::size_t isolatedPoints = 0;
+    // Points of one segment, and of three or more
+    std::size_t deadEnds = 0;
+    std::size_t junctions = 0;
+    std::size_t maxDegree = 0;
+    // Separate pieces of the graph; an isolated point is a piece of its own
+    std::size_t components = 0;
+    double totalLength = 0;
+    float minX = 0, minY = 0, maxX = 0, maxY = 0;
+};
+
+GraphStats computeStats(const EdgeList& graph);
+
+#endif // GRAPHPROCESSING_H
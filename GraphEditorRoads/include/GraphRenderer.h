@@ -0,0 +1,111 @@
+#ifndef GRAPHRENDERER_H
+#define GRAPHRENDERER_H
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Graph.h"
+#include "ResourceManager.h"
+#include "GraphOverview.h"
+#include "TileCache.h"
+#include "RoadBorders.h"
+
+// The GraphRenderer class draws the segments, points and road envelopes of a graph in
+// three draw calls. It keeps one triangle list for segment quads, one for point discs
+// and one textured mesh for envelopes, with a fixed run of vertices per graph slot, and
+// only rewrites the slots the graph reports as changed. Removed slots are collapsed to
+// degenerate triangles until they are reused. Up close, the borders of the union of all
+// envelopes are drawn over them as lines.
+class GraphRenderer {
+public:
+    // Constructor: Sets the look of segments (line width), points (disc radius) and road borders.
+    GraphRenderer(float segmentWidth = 2.0f, float pointRadius = 12.0f,
+                  sf::Color segmentColor = sf::Color::Black, sf::Color pointColor = sf::Color::Black,
+                  sf::Color borderColor = sf::Color::White);
+
+    // Borders of the union of the road envelopes, as of the last sync
+    const RoadBorders& getBorders() const { return borders; }
+
+    // Rewrites the vertices of the slots changed since the last sync.
+    void sync(Graph& graph);
+
+    // Rewrites every slot, e.g. after the graph was replaced.
+    void rebuild(Graph& graph);
+
+    // Syncs, then draws all segments, points and envelopes.
+    void draw(sf::RenderTarget& target, Graph& graph);
+
+    // Syncs, then draws only what overlaps the visible area. The spatial indexes pick
+    // the visible slots and their vertices are copied into scratch arrays, so the cost
+    // follows what is on screen rather than the size of the graph.
+    // The zoom, in world units per pixel, picks the level of detail.
+    void draw(sf::RenderTarget& target, Graph& graph, const sf::FloatRect& visibleArea, float zoom = 1.0f);
+
+    // Syncs, then draws through a cache of offscreen tiles. Only tiles touched by the
+    // edits since the last frame are redrawn, so frames where nothing but the overlays
+    // changed cost a few texture blits.
+    void drawCached(sf::RenderTarget& target, Graph& graph, const sf::FloatRect& visibleArea, float zoom = 1.0f);
+
+    // Levels of detail: everything, merged centerlines only, or node density only
+    enum class DetailLevel { Full, Centerlines, Density };
+    static DetailLevel detailLevelFor(float zoom);
+
+    // Zooms, in world units per pixel, past which nodes and envelopes shrink to a few
+    // pixels and centerlines are drawn instead, and past which roads blur into density.
+    static constexpr float CenterlineZoom = 3.0f;
+    static constexpr float DensityZoom = 24.0f;
+
+    // Vertices per point disc; discs are fans of this many triangles
+    static const int DiscSides = 16;
+
+private:
+    void writeSegment(const Graph& graph, std::uint32_t slot);
+    void writePoint(const Graph& graph, std::uint32_t slot);
+    void writeEnvelope(const Graph& graph, std::uint32_t slot);
+    // Writes an envelope's mesh from its already generated outline
+    void writeEnvelope(const Graph& graph, std::uint32_t slot, const Point* outline);
+    // Records the area covered by a slot's vertices, which is where its pixels are.
+    // Appends the border pieces of a segment slot to a line list
+    void appendBorders(sf::VertexArray& lines, std::uint32_t slot) const;
+    void addDirtyArea(const sf::VertexArray& array, std::uint32_t slot, std::size_t verticesPerSlot);
+    static void copySlots(const sf::VertexArray& from, sf::VertexArray& to,
+                          const std::vector<int>& slots, std::size_t verticesPerSlot);
+
+    float segmentWidth;
+    float pointRadius;
+    sf::Color segmentColor;
+    sf::Color pointColor;
+    sf::Color borderColor;
+    sf::VertexArray segmentTriangles;
+    sf::VertexArray pointTriangles;
+    // All envelopes, textured with the repeating road texture
+    sf::VertexArray envelopeTriangles;
+    ResourceManager resourceManager;
+    std::shared_ptr<sf::Texture> roadTexture;
+    // Unit circle, so discs do not call sin and cos per frame
+    sf::Vector2f disc[DiscSides];
+    // Union borders of the envelopes, and all of them as lines once drawn whole
+    RoadBorders borders;
+    sf::VertexArray borderLines;
+    bool borderLinesStale;
+    // Outlines of every envelope, generated in one batch by rebuild
+    std::vector<Point> envelopeOutlines;
+    // Simplified graph for the zoomed out levels of detail
+    GraphOverview overview;
+    // Static layers rendered offscreen, and the areas edited since they were last drawn
+    TileCache tileCache;
+    std::vector<AABB> dirtyAreas;
+    bool everythingDirty;
+    // Scratch buffers for culled drawing, kept to reuse their memory
+    std::vector<int> visibleSegments;
+    sf::VertexArray visibleSegmentTriangles;
+    sf::VertexArray visiblePointTriangles;
+    sf::VertexArray visibleEnvelopeTriangles;
+    sf::VertexArray visibleBorderLines;
+    // Epoch and version of the graph the arrays were last synced with
+    unsigned long long syncedEpoch;
+    unsigned long long syncedVersion;
+};
+
+#endif // GRAPHRENDERER_H
@@ -0,0 +1,23 @@
+#ifndef INTERSECTIONS_H
+#define INTERSECTIONS_H
+
+#include <cstddef>
+#include <vector>
+#include "Segment.h"
+
+// A crossing between two segments, given by their positions in the input vector.
+struct SegmentCrossing {
+    size_t first;
+    size_t second;
+    Point point;
+};
+
+// Returns true if two segments cross. Segments that only meet at an end point
+// they share (two roads leaving the same node) do not count as crossing.
+bool segmentsCross(const Segment& a, const Segment& b, const VertexBuffer& vertices, Point& crossing);
+
+// Reports every pair of crossing segments with a Bentley-Ottmann sweep.
+// Runs in O((n + k) log n) for n segments and k crossings, instead of testing every pair.
+std::vector<SegmentCrossing> findSegmentCrossings(const std::vector<Segment>& segments, const VertexBuffer& vertices);
+
+#endif // INTERSECTIONS_H
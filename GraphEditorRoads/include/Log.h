@@ -0,0 +1,143 @@
+#ifndef LOG_H
+#define LOG_H
+
+// Leveled logging that never blocks the caller on output. Messages are printf formatted,
+// as key=value pairs where there are values, and written by a background thread:
+//
+//   LOG_DEBUG("point added id=%u x=%g y=%g", id, x, y);
+//   LOG_WARN("point exists x=%g y=%g", x, y);
+//
+// Levels below GRAPH_LOG_LEVEL compile to nothing, arguments included, so logging on hot
+// paths costs nothing in builds that leave it out. The levels left in can still be
+// filtered at runtime with Log::instance().setLevel.
+#define GRAPH_LOG_TRACE 0
+#define GRAPH_LOG_DEBUG 1
+#define GRAPH_LOG_INFO 2
+#define GRAPH_LOG_WARN 3
+#define GRAPH_LOG_ERROR 4
+#define GRAPH_LOG_OFF 5
+
+#ifndef GRAPH_LOG_LEVEL
+#define GRAPH_LOG_LEVEL GRAPH_LOG_INFO
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#if defined(__GNUC__)
+#define GRAPH_PRINTF_FORMAT(string, first) __attribute__((format(printf, string, first)))
+#else
+#define GRAPH_PRINTF_FORMAT(string, first)
+#endif
+
+enum class LogLevel { Trace, Debug, Info, Warn, Error, Off };
+
+// The Log class queues records in a fixed size ring buffer that any thread can append to
+// without a lock, and a writer thread drains it to std::cerr's stream or a file. When the
+// buffer is full records are dropped and counted rather than making the caller wait.
+class Log {
+public:
+    static Log& instance();
+    ~Log();
+
+    void setLevel(LogLevel level);
+    LogLevel getLevel() const;
+    bool enabled(LogLevel level) const {
+        return level >= minLevel.load(std::memory_order_relaxed);
+    }
+
+    // Writes to a file instead of stderr. Returns false and reports on std::cerr on failure.
+    bool setOutput(const std::string& filename);
+
+    void write(LogLevel level, const char* file, int line, const char* format, ...) GRAPH_PRINTF_FORMAT(5, 6);
+
+    // Waits until every record queued so far has been written out.
+    void flush();
+
+    // Records dropped because the buffer was full.
+    std::uint64_t getDropped() const;
+
+    // Records the buffer holds; a power of two. Longer messages are cut short.
+    static const std::size_t Capacity = 1 << 13;
+    static const std::size_t MessageSize = 192;
+
+private:
+    struct Record {
+        // Claimed by a writer when equal to its position, readable when one past it
+        std::atomic<std::uint64_t> sequence;
+        std::int64_t time;
+        LogLevel level;
+        unsigned thread;
+        const char* file;
+        int line;
+        char message[MessageSize];
+    };
+
+    Log();
+    void run();
+    std::size_t drain();
+
+    std::unique_ptr<Record[]> records;
+    // Next position to claim, shared by every thread
+    alignas(64) std::atomic<std::uint64_t> head;
+    // Next position to write out, only touched with the mutex held
+    alignas(64) std::uint64_t tail;
+    // Dropped records already noted in the output
+    std::uint64_t reportedDrops;
+    std::atomic<std::uint64_t> written;
+    std::atomic<std::uint64_t> dropped;
+    std::atomic<LogLevel> minLevel;
+    std::atomic<bool> running;
+
+    // Held while records are written out; flush waits on it
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable flushed;
+    std::FILE* output;
+    std::thread writer;
+};
+
+#define GRAPH_LOG_AT(level, ...)                                                \
+    do {                                                                        \
+        if (Log::instance().enabled(level)) {                                   \
+            Log::instance().write(level, __FILE__, __LINE__, __VA_ARGS__);     \
+        }                                                                       \
+    } while (0)
+
+#if GRAPH_LOG_LEVEL <= GRAPH_LOG_TRACE
+#define LOG_TRACE(...) GRAPH_LOG_AT(LogLevel::Trace, __VA_ARGS__)
+#else
+#define LOG_TRACE(...) ((void)0)
+#endif
+
+#if GRAPH_LOG_LEVEL <= GRAPH_LOG_DEBUG
+#define LOG_DEBUG(...) GRAPH_LOG_AT(LogLevel::Debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+
+#if GRAPH_LOG_LEVEL <= GRAPH_LOG_INFO
+#define LOG_INFO(...) GRAPH_LOG_AT(LogLevel::Info, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if GRAPH_LOG_LEVEL <= GRAPH_LOG_WARN
+#define LOG_WARN(...) GRAPH_LOG_AT(LogLevel::Warn, __VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#endif
+
+#if GRAPH_LOG_LEVEL <= GRAPH_LOG_ERROR
+#define LOG_ERROR(...) GRAPH_LOG_AT(LogLevel::Error, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) ((void)0)
+#endif
+
+#endif // LOG_H
@@ -0,0 +1,50 @@
+#ifndef OSMIMPORT_H
+#define OSMIMPORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <set>
+#include <string>
+#include "EdgeList.h"
+
+// How far an import has got.
+struct OsmProgress {
+    // "ways" while finding the roads, then "nodes" while reading where their nodes are
+    const char* phase;
+    std::uint64_t bytesRead;
+    std::uint64_t totalBytes;
+    // Highway ways kept so far, and nodes of theirs found
+    std::size_t ways;
+    std::size_t nodes;
+};
+
+struct OsmImportOptions {
+    // Values of the highway tag to import; empty imports every highway
+    std::set<std::string> highways = {
+        "motorway", "motorway_link", "trunk", "trunk_link", "primary", "primary_link",
+        "secondary", "secondary_link", "tertiary", "tertiary_link", "unclassified",
+        "residential", "living_street", "service", "road"};
+    // Centre of the projection in degrees; NaN centres it on the imported roads
+    double originLat = std::numeric_limits<double>::quiet_NaN();
+    double originLon = std::numeric_limits<double>::quiet_NaN();
+    // World units per metre around the origin
+    float scale = 1.0f;
+    // Threads decoding .osm.pbf blocks, 0 for one per core
+    unsigned threads = 0;
+    // Called every few megabytes and at the end of each pass
+    std::function<void(const OsmProgress&)> progress;
+};
+
+// Reads the roads of an OpenStreetMap extract, .osm.pbf or else .osm XML. The file is
+// streamed twice, first for the highway ways, then for the positions of only their nodes,
+// so memory grows with the road network rather than with the file. Positions are
+// projected with Web Mercator, scaled to metres around the origin, with y pointing south
+// like the screen. Consecutive nodes of a way become segments, and nodes shared by ways
+// become junctions. Distinct nodes within snap tolerance of each other, which OSM often
+// has at one spot, are merged into one point, so the result saves as a graph file.
+// Returns false and reports on std::cerr on failure.
+bool importOsm(const std::string& filename, EdgeList& graph, const OsmImportOptions& options = OsmImportOptions());
+
+#endif // OSMIMPORT_H
@@ -0,0 +1,56 @@
+#ifndef OSMREADER_H
+#define OSMREADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "OsmImport.h"
+
+// The file format readers behind importOsm. Each format is read in the same two passes:
+// the ways pass keeps the highway ways, the nodes pass fills in the positions of the
+// nodes they use. Both return false and report on std::cerr on failure.
+
+// Highway ways. Way i uses the node ids refs[ends[i - 1]] up to refs[ends[i]].
+struct OsmWays {
+    std::vector<std::int64_t> refs;
+    std::vector<std::size_t> ends;
+
+    // Where the ways pass saw nodes, so the nodes pass can skip the rest: the offset
+    // just past the last node in XML, and the offset of every block holding nodes in PBF
+    std::uint64_t nodesEnd = 0;
+    std::vector<std::uint64_t> nodeBlocks;
+};
+
+// Positions of the nodes the ways use, by position in the sorted ids.
+struct OsmNodes {
+    std::vector<std::int64_t> ids;
+    std::vector<double> lat, lon;
+    std::vector<char> found;
+
+    // Position of an id, or -1. Files list nodes by ascending id, so the search starts
+    // at hint, the position after the previous hit, and gallops forward from there.
+    std::ptrdiff_t find(std::int64_t id, std::size_t& hint) const;
+};
+
+// Tells whether a way with this highway tag value is imported.
+bool isImportedHighway(const OsmImportOptions& options, const char* value, std::size_t length);
+
+// Calls the progress callback, if there is one.
+void reportProgress(const OsmImportOptions& options, const char* phase, std::uint64_t bytesRead,
+                    std::uint64_t totalBytes, std::size_t ways, std::size_t nodes);
+
+// Size of a file in bytes, or 0 if it cannot be read.
+std::uint64_t fileSize(const std::string& filename);
+
+// Seeks to a 64 bit offset; std::fseek only takes a long, which is 32 bits on Windows.
+bool seekFile(std::FILE* file, std::uint64_t offset);
+
+bool readXmlWays(const std::string& filename, const OsmImportOptions& options, OsmWays& ways);
+bool readXmlNodes(const std::string& filename, const OsmImportOptions& options, const OsmWays& ways, OsmNodes& nodes);
+
+bool readPbfWays(const std::string& filename, const OsmImportOptions& options, OsmWays& ways);
+bool readPbfNodes(const std::string& filename, const OsmImportOptions& options, const OsmWays& ways, OsmNodes& nodes);
+
+#endif // OSMREADER_H
@@ -0,0 +1,78 @@
+#ifndef POLYGON_H
+#define POLYGON_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "AABBTree.h"
+#include "Point.h"
+
+// The Polygon class is a simple closed polygon, such as an envelope outline, a road
+// border or a building footprint. Vertices are kept as one array of x coordinates and
+// one of y coordinates, each with the first vertex repeated at the end, so edge loops
+// walk i to i + 1 without wrapping and compile to straight vector code. The bounding
+// box is kept up to date and rejects most queries before any edge is looked at.
+class Polygon {
+public:
+    Polygon();
+
+    // Builds a polygon from its vertices in order. A last point equal to the first, as
+    // closed border polylines have, is dropped.
+    explicit Polygon(const std::vector<Point>& points);
+    Polygon(const Point* points, std::size_t count);
+
+    void assign(const Point* points, std::size_t count);
+    void addPoint(float x, float y);
+    void clear();
+
+    std::size_t size() const { return xs.empty() ? 0 : xs.size() - 1; }
+    bool empty() const { return xs.empty(); }
+    float x(std::size_t index) const { return xs[index]; }
+    float y(std::size_t index) const { return ys[index]; }
+    Point getPoint(std::size_t index) const { return Point(xs[index], ys[index]); }
+    const AABB& getBounds() const { return bounds; }
+
+    // Raw coordinate arrays, size() + 1 long with the first vertex repeated at the end
+    const float* xData() const { return xs.data(); }
+    const float* yData() const { return ys.data(); }
+
+    // Checks whether a point is inside, by the even-odd rule. Points exactly on an edge
+    // may land on either side.
+    bool contains(float x, float y) const;
+    bool contains(const Point& point) const { return contains(point.x, point.y); }
+
+    // For convex polygons such as envelope outlines: checks whether a point is on the inner
+    // side of every edge and further than rounding from the line of each, so points on an
+    // edge count as outside. The road borders use it so the shared edges of touching
+    // envelopes are kept by neither.
+    bool containsStrictly(float x, float y) const;
+
+    // Tests count points at once, writing 1 for each point inside and 0 otherwise.
+    // Faster per point than contains when testing many points against one polygon.
+    void contains(const float* x, const float* y, std::size_t count, std::uint8_t* inside) const;
+
+    // Checks whether the segment from a to b crosses an edge or lies inside the polygon.
+    bool intersects(const Point& a, const Point& b) const;
+
+    // Checks whether two polygons share any area, or their edges cross or touch.
+    bool overlaps(const Polygon& other) const;
+
+    // Finds where edge i, from vertex i to vertex i + 1, crosses the line through c and d,
+    // as fractions along each. Parallel lines never cross. Rounding depends on which of
+    // the two is the edge, so callers needing both sides to agree to the bit must always
+    // ask the same polygon.
+    bool crossEdge(std::size_t i, const Point& c, const Point& d, float& alongEdge, float& alongOther) const;
+
+    // Signed area, positive when the vertices run counter-clockwise in a y-up frame.
+    float area() const;
+
+private:
+    // Checks whether the segment from a to b crosses or touches any edge. Collinear
+    // overlaps are not counted.
+    bool crossesEdges(float ax, float ay, float bx, float by) const;
+
+    std::vector<float> xs, ys;
+    AABB bounds;
+};
+
+#endif // POLYGON_H
@@ -0,0 +1,113 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// Scoped timing of the editor's phases. Build with GRAPH_ENABLE_PROFILER defined to record;
+// without it the macros below expand to nothing and none of this is compiled.
+//
+//   PROFILE_SCOPE("Graph::movePoint");  // times the rest of the enclosing block
+//   PROFILE_FUNCTION();                 // same, named after the enclosing function
+//   PROFILE_FRAME_BEGIN();              // starts timing a frame
+//   PROFILE_FRAME_END();                // ends it and sums up its scopes
+#ifdef GRAPH_ENABLE_PROFILER
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// The Profiler class collects timed scopes from every thread. Each thread appends to its
+// own buffer, so recording takes no shared lock. Scopes are kept in memory until written
+// out as a Chrome trace, which chrome://tracing and Perfetto open.
+class Profiler {
+public:
+    // A timed scope; times are nanoseconds since the profiler started.
+    struct Scope {
+        const char* name;
+        std::int64_t start;
+        std::int64_t duration;
+    };
+
+    // Total time spent in scopes of one name during a frame. Nested scopes count in full
+    // towards their own name and towards every enclosing one.
+    struct PhaseTime {
+        const char* name;
+        double milliseconds;
+        unsigned calls;
+    };
+
+    static Profiler& instance();
+
+    static std::int64_t now();
+    void record(const char* name, std::int64_t start, std::int64_t end);
+
+    // A frame runs from beginFrame to endFrame on one thread, so time spent waiting for
+    // input between frames is not counted. endFrame sums up the thread's scopes since the
+    // previous frame ended.
+    void beginFrame();
+    void endFrame();
+
+    // Length of recent frames in milliseconds, oldest first.
+    std::vector<double> getFrameTimes() const;
+    // Phases of the last finished frame, slowest first.
+    std::vector<PhaseTime> getLastFrame() const;
+
+    // Writes every scope recorded so far. Returns false and reports on std::cerr on failure.
+    bool writeChromeTrace(const std::string& filename) const;
+
+    // Scopes kept per thread; later ones are dropped and counted.
+    static const std::size_t MaxScopesPerThread = 1 << 20;
+    static const std::size_t FrameHistory = 120;
+
+private:
+    struct ThreadBuffer {
+        std::mutex mutex;
+        std::vector<Scope> scopes;
+        std::size_t dropped = 0;
+        unsigned thread = 0;
+        // Scopes before this one belong to frames already summed up
+        std::size_t firstInFrame = 0;
+    };
+
+    Profiler();
+    ThreadBuffer& threadBuffer();
+
+    mutable std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::vector<double> frameTimes;
+    std::vector<PhaseTime> lastFrame;
+    std::int64_t frameStart;
+};
+
+// Records the time from its construction to the end of the enclosing scope.
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name) : name(name), start(Profiler::now()) {}
+    ~ProfileScope() { Profiler::instance().record(name, start, Profiler::now()); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;
+    std::int64_t start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#define PROFILE_FRAME_BEGIN() Profiler::instance().beginFrame()
+#define PROFILE_FRAME_END() Profiler::instance().endFrame()
+
+#else
+
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#define PROFILE_FRAME_BEGIN() ((void)0)
+#define PROFILE_FRAME_END() ((void)0)
+
+#endif // GRAPH_ENABLE_PROFILER
+
+#endif // PROFILER_H
@@ -0,0 +1,35 @@
+#ifndef PROFILEROVERLAY_H
+#define PROFILEROVERLAY_H
+
+#include "Profiler.h"
+
+#ifdef GRAPH_ENABLE_PROFILER
+
+#include <SFML/Graphics.hpp>
+
+// The ProfilerOverlay class draws recent frame times and the slowest phases of the last
+// frame in the window's corner. It is only built along with the profiler.
+class ProfilerOverlay {
+public:
+    ProfilerOverlay();
+
+    // Draws in screen coordinates; the caller sets the default view first.
+    void draw(sf::RenderTarget& target);
+
+    void toggle() { visible = !visible; }
+    bool isVisible() const { return visible; }
+
+    // Phases listed below the frame time graph
+    static const std::size_t ShownPhases = 8;
+
+private:
+    sf::Font font;
+    sf::Text text;
+    sf::RectangleShape background;
+    sf::VertexArray graph;
+    bool visible;
+};
+
+#endif // GRAPH_ENABLE_PROFILER
+
+#endif // PROFILEROVERLAY_H
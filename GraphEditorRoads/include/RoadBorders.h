@@ -0,0 +1,65 @@
+#ifndef ROADBORDERS_H
+#define ROADBORDERS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Graph.h"
+#include "Polygon.h"
+
+// A straight piece of road border. Pieces run the same way round as the envelope
+// outlines they were cut from, so each one leads into the next.
+struct BorderEdge {
+    Point a, b;
+};
+
+// The RoadBorders class outlines the union of all road envelopes. Each envelope's outline
+// is cut where it crosses the outlines of the envelopes overlapping it, and the pieces
+// lying inside another envelope are dropped; what is left is the border of the union.
+// Pieces are stored per segment slot, so an edit only recomputes the envelopes whose
+// bounds touch the edited ones, found through the graph's segment index.
+class RoadBorders {
+public:
+    // Recomputes the borders of every envelope.
+    void rebuild(const Graph& graph);
+
+    // Recomputes the borders around the given segment slots, which may hold repeats.
+    // Call it with the graph's changed segments before they are cleared.
+    void update(const Graph& graph, const std::vector<std::uint32_t>& changedSegments);
+
+    // Border pieces cut from the envelope of a segment slot
+    const std::vector<BorderEdge>& getEdges(std::uint32_t slot) const;
+
+    // Chains every border piece into polylines. Closed borders end on their first point.
+    std::vector<std::vector<Point>> getPolylines() const;
+
+    std::size_t getEdgeCount() const { return edgeCount; }
+
+    // Number of envelopes recomputed by the last rebuild or update
+    std::size_t getRecomputedCount() const { return recomputed; }
+
+private:
+    struct Outline {
+        std::uint32_t slot;
+        Polygon polygon;
+    };
+
+    bool buildOutline(const Graph& graph, std::uint32_t slot, Outline& outline) const;
+    void recompute(const Graph& graph, std::uint32_t slot);
+
+    // Border pieces by segment slot
+    std::vector<std::vector<BorderEdge>> edges;
+    // Bounds of each slot's envelope when its pieces were computed; empty slots have none
+    std::vector<AABB> bounds;
+    std::vector<bool> hasBounds;
+    std::size_t edgeCount = 0;
+    std::size_t recomputed = 0;
+    // Scratch space reused between recomputations; only the first neighbourCount
+    // neighbours are current, the rest keep their memory for the next time
+    Outline self;
+    std::vector<Outline> neighbours;
+    std::size_t neighbourCount = 0;
+    std::vector<std::pair<float, Point>> cuts;
+};
+
+#endif // ROADBORDERS_H
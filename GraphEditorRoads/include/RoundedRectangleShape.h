@@ -2,6 +2,7 @@
 #define ROUNDEDRECTANGLESHAPE_H
 
 #include <SFML/Graphics/Shape.hpp>
+#include <vector>
 
 namespace sf
 {
@@ -29,6 +30,10 @@ namespace sf
 
         virtual sf::Vector2f getPoint(std::size_t index) const;
 
+        // Unit vectors from each corner's centre to its arc points, for every point of the
+        // outline. Computed once per corner point count and shared by all shapes.
+        static const std::vector<Vector2f>& getCornerDirections(unsigned int cornerPointCount);
+
             Vector2f mySize;
             float myRadius;
             unsigned int myCornerPointCount;
@@ -1,31 +1,36 @@
 #ifndef SEGMENT_H
 #define SEGMENT_H
 
+#include <cstdint>
 #include "Point.h"
-#include <string>
+#include "VertexBuffer.h"
 
-// The Segment class represents a line segment defined by two points in 2D space.
+// The Segment class represents a line segment between two vertices of a VertexBuffer.
+// It stores the vertex slot indexes rather than copies of the end points, so it always
+// sees the current position of its nodes.
 class Segment {
 public:
-    // Endpoints of the segment
-    Segment();
-    Point p1, p2;
-    float length() const;
-    std::string id;
-    // Constructor: Initializes a new segment with the given end points.
-    Segment(const Point& p1, const Point& p2, const std::string& id = "") : p1(p1), p2(p2), id(id) {}
+    // Vertex slot indexes of the end points
+    std::uint32_t a, b;
+    // Slot index of the segment in the graph, -1 until it is added
+    int id;
+
+    Segment() : a(0), b(0), id(-1) {}
+
+    // Constructor: Initializes a new segment between two vertex indexes.
+    Segment(std::uint32_t a, std::uint32_t b, int id = -1) : a(a), b(b), id(id) {}
 
     // Checks if this segment is equal to another segment.
-    // Two segments are equal if they have the same end points.
+    // Two segments are equal if they join the same vertices.
     bool equals(const Segment& other) const;
 
-    // Checks if this segment includes a given point.
-    // A point is included in a segment if it is one of the segment's end points.
-    bool includes(const Point& point) const;
+    // Checks if this segment includes a given vertex.
+    bool includes(std::uint32_t vertex) const;
+
+    // Returns the end point across the segment from a given one.
+    std::uint32_t other(std::uint32_t vertex) const { return vertex == a ? b : a; }
 
-    // Draws this segment on the given SFML render window.
-    // The segment is drawn as a line with a specified width and color.
-    void draw(sf::RenderWindow& window, float width = 2, sf::Color color = sf::Color::Black) const;
+    float length(const VertexBuffer& vertices) const;
 };
 
 #endif // SEGMENT_H
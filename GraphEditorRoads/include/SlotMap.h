@@ -0,0 +1,148 @@
+#ifndef SLOTMAP_H
+#define SLOTMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// A Handle names an element of a SlotMap. It stays valid for as long as the element
+// lives, no matter how many other elements are added or removed. Once the element is
+// removed the slot's generation changes, so the old handle resolves to nothing instead
+// of silently pointing at whatever reuses the slot.
+struct Handle {
+    std::uint32_t index = 0;
+    std::uint32_t generation = 0; // Live slots start at generation 1, so {0, 0} is never valid
+
+    bool isNull() const { return generation == 0; }
+    bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const Handle& other) const { return !(*this == other); }
+};
+
+// The generation a slot takes when it is filled or freed. It wraps past 0, so a slot never
+// carries the generation of a null handle.
+inline std::uint32_t nextGeneration(std::uint32_t generation) {
+    return generation + 1 != 0 ? generation + 1 : 1;
+}
+
+// The SlotMap class stores values densely in one vector so iteration is a plain array
+// walk, while an indirection table of slots hands out stable handles.
+// Insertion and removal are O(1): removal moves the last value into the hole.
+template <typename T>
+class SlotMap {
+public:
+    typedef typename std::vector<T>::iterator iterator;
+    typedef typename std::vector<T>::const_iterator const_iterator;
+
+    // Adds a value and returns its handle.
+    Handle insert(const T& value) {
+        std::uint32_t index;
+        if (freeHead != NoSlot) {
+            index = freeHead;
+            freeHead = slots[index].dense;
+        } else {
+            index = static_cast<std::uint32_t>(slots.size());
+            slots.push_back({0, 0});
+        }
+        Slot& slot = slots[index];
+        slot.generation = nextGeneration(slot.generation);
+        slot.dense = static_cast<std::uint32_t>(values.size());
+        values.push_back(value);
+        denseToSlot.push_back(index);
+        return {index, slot.generation};
+    }
+
+    // Removes the value behind a handle. Returns false if the handle is stale.
+    bool remove(Handle handle) {
+        if (!contains(handle)) {
+            return false;
+        }
+        Slot& slot = slots[handle.index];
+        std::uint32_t hole = slot.dense;
+        std::uint32_t last = static_cast<std::uint32_t>(values.size()) - 1;
+        if (hole != last) {
+            values[hole] = std::move(values[last]);
+            denseToSlot[hole] = denseToSlot[last];
+            slots[denseToSlot[hole]].dense = hole;
+        }
+        values.pop_back();
+        denseToSlot.pop_back();
+
+        // Bumping the generation invalidates every outstanding handle to this slot.
+        slot.generation = nextGeneration(slot.generation);
+        slot.dense = freeHead;
+        freeHead = handle.index;
+        return true;
+    }
+
+    bool contains(Handle handle) const {
+        return handle.index < slots.size() && !handle.isNull() &&
+               slots[handle.index].generation == handle.generation && isLive(handle.index);
+    }
+
+    // Returns the value behind a handle, or nullptr if the handle is stale.
+    T* get(Handle handle) { return contains(handle) ? &values[slots[handle.index].dense] : nullptr; }
+    const T* get(Handle handle) const { return contains(handle) ? &values[slots[handle.index].dense] : nullptr; }
+
+    // Returns the current handle of a live slot index, or a null handle.
+    Handle handleOf(std::uint32_t index) const {
+        if (index >= slots.size() || !isLive(index)) return Handle();
+        return {index, slots[index].generation};
+    }
+
+    // Returns the handle of the value stored at a dense position.
+    Handle handleAt(std::size_t denseIndex) const {
+        std::uint32_t index = denseToSlot[denseIndex];
+        return {index, slots[index].generation};
+    }
+
+    // Looks a value up by slot index alone, for indexes that store plain integers.
+    T* getByIndex(std::uint32_t index) { return index < slots.size() && isLive(index) ? &values[slots[index].dense] : nullptr; }
+    const T* getByIndex(std::uint32_t index) const { return index < slots.size() && isLive(index) ? &values[slots[index].dense] : nullptr; }
+
+    void clear() {
+        values.clear();
+        denseToSlot.clear();
+        slots.clear();
+        freeHead = NoSlot;
+    }
+
+    void reserve(std::size_t count) {
+        values.reserve(count);
+        denseToSlot.reserve(count);
+        slots.reserve(count);
+    }
+
+    std::size_t size() const { return values.size(); }
+    bool empty() const { return values.empty(); }
+
+    // Number of slots ever allocated, live or free. Slot indexes are always below it.
+    std::size_t capacity() const { return slots.size(); }
+
+    // Dense, cache friendly iteration over the live values.
+    iterator begin() { return values.begin(); }
+    iterator end() { return values.end(); }
+    const_iterator begin() const { return values.begin(); }
+    const_iterator end() const { return values.end(); }
+    const std::vector<T>& dense() const { return values; }
+
+private:
+    static const std::uint32_t NoSlot = 0xFFFFFFFFu;
+
+    struct Slot {
+        std::uint32_t dense;      // Position in values when live, next free slot otherwise
+        std::uint32_t generation;
+    };
+
+    bool isLive(std::uint32_t index) const {
+        std::uint32_t dense = slots[index].dense;
+        return dense < denseToSlot.size() && denseToSlot[dense] == index;
+    }
+
+    std::vector<T> values;
+    std::vector<std::uint32_t> denseToSlot;
+    std::vector<Slot> slots;
+    std::uint32_t freeHead = NoSlot;
+};
+
+#endif // SLOTMAP_H
@@ -0,0 +1,57 @@
+#ifndef SNAPINDEX_H
+#define SNAPINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// The SnapIndex class answers the duplicate checks of the graph in O(1).
+// Points are hashed on their coordinates quantized to the snap tolerance, so a point
+// within tolerance of an existing one is found by probing the 3x3 cells around it.
+// Segments are hashed on their unordered pair of vertex indexes.
+class SnapIndex {
+public:
+    // Constructor: Initializes an empty index that merges points closer than tolerance.
+    explicit SnapIndex(float tolerance = 0.01f);
+
+    // Changes the snap tolerance. Points already stored are rehashed.
+    void setTolerance(float tolerance);
+    float getTolerance() const;
+
+    void insertPoint(std::uint32_t vertex, float x, float y);
+    void removePoint(std::uint32_t vertex, float x, float y);
+    void movePoint(std::uint32_t vertex, float fromX, float fromY, float toX, float toY);
+
+    // Returns the vertex within tolerance of (x, y), closest first, or -1 if there is none.
+    // The vertex except, if given, is passed over.
+    int findPoint(float x, float y, int except = -1) const;
+
+    void insertSegment(std::uint32_t a, std::uint32_t b, int segmentId);
+    void removeSegment(std::uint32_t a, std::uint32_t b);
+
+    // Returns the id of the segment joining two vertices in either order, or -1.
+    int findSegment(std::uint32_t a, std::uint32_t b) const;
+
+    void clear();
+    std::size_t pointCount() const;
+    std::size_t segmentCount() const;
+
+private:
+    struct Entry {
+        std::uint32_t vertex;
+        float x, y;
+    };
+
+    long long cellCoord(float value) const;
+    static std::uint64_t cellKey(long long cellX, long long cellY);
+    static std::uint64_t pairKey(std::uint32_t a, std::uint32_t b);
+
+    float tolerance;
+    float cellSize;
+    std::size_t points;
+    std::unordered_map<std::uint64_t, std::vector<Entry>> cells;
+    std::unordered_map<std::uint64_t, int> segmentPairs;
+};
+
+#endif // SNAPINDEX_H
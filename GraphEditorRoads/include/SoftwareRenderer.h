@@ -0,0 +1,64 @@
+#ifndef SOFTWARERENDERER_H
+#define SOFTWARERENDERER_H
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Graph.h"
+#include "RoadBorders.h"
+
+// The SoftwareRenderer class rasterizes a graph on the CPU into an RGBA pixel buffer,
+// so maps can be drawn with no window or OpenGL context, e.g. on a build server.
+// Up close it draws what the GraphRenderer draws, in the same order; zoomed out it draws
+// plain centerlines, without merging or density shading. Rendering only reads the graph,
+// the borders and the renderer, so several threads may render different areas at once
+// as long as nobody edits the graph.
+class SoftwareRenderer {
+public:
+    // Constructor: borders may be null to leave the road borders out.
+    SoftwareRenderer(const Graph& graph, const RoadBorders* borders = nullptr,
+                     float segmentWidth = 2.0f, float pointRadius = 12.0f);
+
+    // Loads the road texture from an image file. Without one roads are flat grey.
+    bool loadRoadTexture(const std::string& filename);
+
+    // Draws a world rectangle into width x height pixels, 4 bytes per pixel, rows top down.
+    void render(const sf::FloatRect& area, unsigned width, unsigned height, std::vector<std::uint8_t>& pixels) const;
+
+    // Draws a world rectangle into an image of width x height pixels.
+    void render(const sf::FloatRect& area, unsigned width, unsigned height, sf::Image& image) const;
+
+    sf::Color backgroundColor;
+    sf::Color segmentColor;
+    sf::Color pointColor;
+    sf::Color roadColor;
+    sf::Color borderColor;
+
+private:
+    // Pixel buffer being drawn into, and the mapping from world to pixel coordinates
+    struct Canvas {
+        std::uint8_t* pixels;
+        int width, height;
+        float left, top, scaleX, scaleY;
+    };
+
+    // Fills a convex polygon given in pixel coordinates, sampling at pixel centres.
+    // shade(x, y) returns the colour of the pixel whose centre is (x + 0.5, y + 0.5).
+    template <typename Shader>
+    static void fillConvex(Canvas& canvas, const float* xs, const float* ys, int count, Shader shade);
+
+    static void blend(std::uint8_t* pixel, const sf::Color& color);
+    void drawLine(Canvas& canvas, float ax, float ay, float bx, float by, float width, const sf::Color& color) const;
+    void drawDisc(Canvas& canvas, float x, float y, float radius, const sf::Color& color) const;
+    void drawEnvelope(Canvas& canvas, const Segment& segment, const Envelope& envelope) const;
+
+    const Graph& graph;
+    const RoadBorders* borders;
+    float segmentWidth;
+    float pointRadius;
+    sf::Image roadTexture;
+    bool hasRoadTexture;
+};
+
+#endif // SOFTWARERENDERER_H
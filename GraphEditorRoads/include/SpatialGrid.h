@@ -0,0 +1,77 @@
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include <cstddef>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+// The SpatialGrid class is a uniform hash grid over point ids.
+// Each id lives in exactly one cell, so inserts, removals and moves are O(1)
+// and proximity queries only touch the cells around the query location.
+class SpatialGrid {
+public:
+    // Constructor: Initializes an empty grid whose square cells are cellSize world units wide.
+    explicit SpatialGrid(float cellSize = 50.0f);
+
+    // Adds an id at the given position. Inserting an existing id moves it instead.
+    void insert(int id, float x, float y);
+
+    // Removes an id from the grid. Unknown ids are ignored.
+    void remove(int id);
+
+    // Moves an id to a new position, changing cells only when it has to.
+    void move(int id, float x, float y);
+
+    // Removes every id from the grid.
+    void clear();
+
+    bool contains(int id) const;
+    std::size_t size() const;
+    float getCellSize() const;
+
+    // Returns the id closest to (x, y) within maxDistance, or -1 if there is none.
+    int nearest(float x, float y, float maxDistance = std::numeric_limits<float>::max()) const;
+
+    // Returns up to k ids ordered from closest to furthest.
+    std::vector<int> kNearest(float x, float y, std::size_t k) const;
+
+    // Returns every id within radius of (x, y).
+    std::vector<int> queryRadius(float x, float y, float radius) const;
+
+    // Returns every id inside the axis aligned rectangle [minX, maxX] x [minY, maxY].
+    std::vector<int> queryRect(float minX, float minY, float maxX, float maxY) const;
+
+private:
+    struct Entry {
+        int id;
+        float x, y;
+    };
+
+    typedef long long CellKey;
+
+    int cellCoord(float value) const;
+    static CellKey makeKey(int cellX, int cellY);
+
+    // Calls visit(entry) for every entry stored in the cell block [x0, x1] x [y0, y1].
+    // Falls back to walking the occupied cells when the block is larger than the grid itself.
+    template <typename Visitor>
+    void forEachInCells(int x0, int y0, int x1, int y1, Visitor visit) const;
+
+    // Calls visit(entry) for every entry on the square ring at Chebyshev distance ring from (cx, cy).
+    template <typename Visitor>
+    void forEachOnRing(int cx, int cy, int ring, Visitor visit) const;
+
+    // Number of rings needed around (cx, cy) to cover every occupied cell.
+    int maxRing(int cx, int cy) const;
+
+    float cellSize;
+    std::unordered_map<CellKey, std::vector<Entry>> cells;
+    std::unordered_map<int, CellKey> locations;
+
+    // Occupied cell extent. It only ever grows, which keeps ring searches bounded
+    // without rescanning the grid on removal.
+    int minCellX, maxCellX, minCellY, maxCellY;
+};
+
+#endif // SPATIALGRID_H
@@ -0,0 +1,57 @@
+#ifndef TILECACHE_H
+#define TILECACHE_H
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "AABBTree.h"
+
+// The TileCache class keeps the static layers of the scene rendered into offscreen
+// tiles, so frames where only overlays change just blit a handful of textures.
+// Tiles cover a fixed number of screen pixels at the current zoom; changing the zoom
+// drops them, panning reuses them. A tile is redrawn only after a dirty rectangle
+// touching it is reported, or after the whole cache is invalidated.
+class TileCache {
+public:
+    // Draws the static layers of one world rectangle into a target whose view already shows it.
+    typedef std::function<void(sf::RenderTarget&, const sf::FloatRect&)> TileDrawer;
+
+    // Constructor: tiles are tilePixels square; at most maxTiles are kept in memory.
+    explicit TileCache(unsigned tilePixels = 512, std::size_t maxTiles = 64);
+
+    // Marks the tiles overlapping a world rectangle for redrawing.
+    void invalidate(const AABB& area);
+
+    // Marks every tile for redrawing.
+    void invalidateAll();
+
+    // Draws the tiles covering the visible area, redrawing stale or missing ones first.
+    void draw(sf::RenderTarget& target, const sf::FloatRect& visibleArea, float zoom, const TileDrawer& drawTile);
+
+    // Tiles redrawn by the last call to draw
+    std::size_t getRedrawCount() const { return redrawn; }
+    std::size_t getTileCount() const { return tiles.size(); }
+
+private:
+    struct Tile {
+        std::unique_ptr<sf::RenderTexture> texture;
+        bool stale;
+        std::uint64_t lastUsed;
+    };
+
+    static std::uint64_t tileKey(std::int32_t x, std::int32_t y);
+    void evict();
+
+    unsigned tilePixels;
+    std::size_t maxTiles;
+    // World units per pixel the tiles were rendered at
+    float tileZoom;
+    std::uint64_t frame;
+    std::size_t redrawn;
+    std::unordered_map<std::uint64_t, Tile> tiles;
+};
+
+#endif // TILECACHE_H
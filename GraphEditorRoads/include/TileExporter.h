@@ -0,0 +1,45 @@
+#ifndef TILEEXPORTER_H
+#define TILEEXPORTER_H
+
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <string>
+#include "Graph.h"
+#include "RoadBorders.h"
+#include "SoftwareRenderer.h"
+
+// The TileExporter class renders a whole graph into a pyramid of PNG tiles laid out as
+// directory/z/x/y.png, like web map tiles. Zoom 0 is a single tile showing the whole map
+// and each further zoom splits every tile into four. Tiles are rasterized on the CPU by a
+// pool of threads, so exporting needs neither a window nor a display.
+class TileExporter {
+public:
+    // Constructor: tiles are tileSize pixels square. The graph must not change while the
+    // exporter exists.
+    explicit TileExporter(const Graph& graph, unsigned tileSize = 256);
+
+    // Loads the road texture from an image file; see SoftwareRenderer::loadRoadTexture.
+    bool loadRoadTexture(const std::string& filename);
+
+    // Writes every tile from zoom 0 to maxZoom. threadCount 0 uses one thread per core.
+    // Returns the number of tiles written; failures are reported on std::cerr.
+    std::size_t exportPyramid(const std::string& directory, int maxZoom, unsigned threadCount = 0);
+
+    // Renders a single tile into an image.
+    void renderTile(int zoom, int x, int y, sf::Image& image) const;
+
+    // World rectangle shown by a tile
+    sf::FloatRect getTileArea(int zoom, int x, int y) const;
+
+    unsigned getTileSize() const { return tileSize; }
+
+private:
+    const Graph& graph;
+    RoadBorders borders;
+    SoftwareRenderer renderer;
+    unsigned tileSize;
+    // Square around the whole graph, shown by the zoom 0 tile
+    sf::FloatRect world;
+};
+
+#endif // TILEEXPORTER_H
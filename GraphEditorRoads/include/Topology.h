@@ -0,0 +1,51 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+// Compressed sparse row copy of the point -> segment incidence lists.
+// Row r lists the segments touching point id r in segmentIds[offsets[r] .. offsets[r + 1]).
+// Building one is O(points + segments); reading it afterwards never touches a hash map.
+struct TopologySnapshot {
+    std::vector<int> offsets;
+    std::vector<int> segmentIds;
+
+    // Number of segments touching a point
+    int degree(int pointId) const {
+        if (pointId < 0 || pointId + 1 >= static_cast<int>(offsets.size())) return 0;
+        return offsets[pointId + 1] - offsets[pointId];
+    }
+
+    const int* begin(int pointId) const { return segmentIds.data() + offsets[pointId]; }
+    const int* end(int pointId) const { return begin(pointId) + degree(pointId); }
+};
+
+// The Topology class keeps, for every point id, the ids of the segments touching it,
+// so connected segment lookups cost O(degree) instead of a scan over all segments.
+class Topology {
+public:
+    // Records a segment between two point ids.
+    void addSegment(int segmentId, int p1, int p2);
+
+    // Forgets a segment between two point ids.
+    void removeSegment(int segmentId, int p1, int p2);
+
+    // Forgets a point and returns the ids of the segments that were touching it.
+    std::vector<int> removePoint(int pointId);
+
+    // Ids of the segments touching a point
+    const std::vector<int>& incident(int pointId) const;
+
+    std::size_t degree(int pointId) const;
+    void clear();
+
+    // Builds a compact read-only copy of the incidence lists.
+    TopologySnapshot snapshot() const;
+
+private:
+    std::unordered_map<int, std::vector<int>> incidence;
+};
+
+#endif // TOPOLOGY_H
@@ -0,0 +1,76 @@
+#ifndef VERTEXBUFFER_H
+#define VERTEXBUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Point.h"
+#include "SlotMap.h"
+
+// The VertexBuffer class holds the position of every node in the graph, as one array of
+// x coordinates and one of y coordinates indexed by vertex slot. Segments and envelopes
+// refer to their end points by slot index, so moving a node is a single write here.
+// Slots are reused after removal; handles carry a generation to tell reuses apart.
+class VertexBuffer {
+public:
+    // Adds a vertex and returns its handle. handle.index is the slot used by segments.
+    Handle add(float x, float y);
+
+    // Frees a vertex slot. Returns false if the handle is stale.
+    bool remove(Handle handle);
+
+    bool contains(Handle handle) const {
+        return handle.index < generations.size() && !handle.isNull() &&
+               generations[handle.index] == handle.generation && isLive(handle.index);
+    }
+
+    // Checks whether a slot index currently holds a vertex
+    bool isLive(std::uint32_t index) const {
+        return index < slotToLive.size() && slotToLive[index] != NoSlot;
+    }
+
+    // Returns the current handle of a live slot index, or a null handle.
+    Handle handleOf(std::uint32_t index) const {
+        return isLive(index) ? Handle{index, generations[index]} : Handle();
+    }
+
+    float x(std::uint32_t index) const { return xs[index]; }
+    float y(std::uint32_t index) const { return ys[index]; }
+    void set(std::uint32_t index, float x, float y) { xs[index] = x; ys[index] = y; }
+
+    // Copies a vertex out as a Point whose id is its slot index.
+    Point point(std::uint32_t index) const { return Point(xs[index], ys[index], static_cast<int>(index)); }
+
+    // Slot indexes of the live vertices, in no particular order.
+    const std::vector<std::uint32_t>& live() const { return liveSlots; }
+
+    void clear();
+    void reserve(std::size_t count);
+
+    // Replaces every vertex with count new ones in slots 0 to count - 1, copying the
+    // coordinates in bulk.
+    void assign(const float* x, const float* y, std::size_t count);
+
+    // Number of live vertices
+    std::size_t size() const { return liveSlots.size(); }
+    bool empty() const { return liveSlots.empty(); }
+
+    // Number of slots ever allocated. Every slot index is below it.
+    std::size_t capacity() const { return xs.size(); }
+
+    // Raw coordinate arrays, indexed by slot. Dead slots hold stale values.
+    const float* xData() const { return xs.data(); }
+    const float* yData() const { return ys.data(); }
+
+private:
+    static constexpr std::uint32_t NoSlot = 0xFFFFFFFFu;
+
+    std::vector<float> xs, ys;
+    std::vector<std::uint32_t> generations;
+    // Position of each slot in liveSlots, or NoSlot while the slot is free
+    std::vector<std::uint32_t> slotToLive;
+    std::vector<std::uint32_t> liveSlots;
+    std::vector<std::uint32_t> freeSlots;
+};
+
+#endif // VERTEXBUFFER_H
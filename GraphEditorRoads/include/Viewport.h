@@ -10,6 +10,12 @@ public:
     void handleEvent(const sf::Event& event);
     void update();
 
+    // The rectangle of the world currently on screen, in world coordinates.
+    sf::FloatRect getVisibleArea() const;
+
+    // World units covered by one screen pixel; grows as the view zooms out.
+    float getZoom() const;
+
 private:
     void zoom(float factor);
     void pan(sf::Vector2f movement);
@@ -20,7 +20,14 @@ float angle(const Point& p);
 // Linear Interpolation
 float lerp(float a, float b, float t);
 
+// Shortest distance from point P to the segment AB
+float distanceToSegment(const Point& P, const Point& A, const Point& B);
+
 // Get Intersection (assuming Point has a constructor Point(float x, float y))
 Point getIntersection(const Point& A, const Point& B, const Point& C, const Point& D);
 
+// Segment Intersection: returns true if segments AB and CD meet, storing the meeting point.
+// Parallel and collinear segments are reported as not intersecting.
+bool getSegmentIntersection(const Point& A, const Point& B, const Point& C, const Point& D, Point& intersection);
+
 #endif // UTILS_H
@@ -2,11 +2,6 @@
 
 int main() {
     Application application;
-
-	while (application.isRunning()) {
-		application.update();
-
-		application.render();
-	}
+    application.run();
     return 0;
 }
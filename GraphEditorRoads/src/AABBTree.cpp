@@ -0,0 +1,300 @@
+#include "AABBTree.h"
+#include <algorithm>
+
+AABBTree::AABBTree(float margin) : root(Null), freeList(Null), margin(margin) {}
+
+int AABBTree::allocateNode() {
+    if (freeList == Null) {
+        nodes.push_back(Node());
+        freeList = static_cast<int>(nodes.size()) - 1;
+        nodes[freeList].parent = Null;
+    }
+    int index = freeList;
+    freeList = nodes[index].parent;
+    Node& node = nodes[index];
+    node.parent = Null;
+    node.left = Null;
+    node.right = Null;
+    node.height = 0;
+    node.id = -1;
+    return index;
+}
+
+void AABBTree::freeNode(int index) {
+    nodes[index].parent = freeList;
+    nodes[index].height = -1;
+    freeList = index;
+}
+
+void AABBTree::insert(int id, const AABB& bounds) {
+    if (leaves.count(id)) {
+        update(id, bounds);
+        return;
+    }
+    int leaf = allocateNode();
+    nodes[leaf].box = {bounds.minX - margin, bounds.minY - margin, bounds.maxX + margin, bounds.maxY + margin};
+    nodes[leaf].id = id;
+    insertLeaf(leaf);
+    leaves[id] = leaf;
+}
+
+void AABBTree::remove(int id) {
+    auto found = leaves.find(id);
+    if (found == leaves.end()) {
+        return;
+    }
+    removeLeaf(found->second);
+    freeNode(found->second);
+    leaves.erase(found);
+}
+
+bool AABBTree::update(int id, const AABB& bounds) {
+    auto found = leaves.find(id);
+    if (found == leaves.end()) {
+        insert(id, bounds);
+        return true;
+    }
+    int leaf = found->second;
+    if (nodes[leaf].box.contains(bounds)) {
+        // Still inside the padded box, nothing to restructure.
+        return false;
+    }
+    removeLeaf(leaf);
+    nodes[leaf].box = {bounds.minX - margin, bounds.minY - margin, bounds.maxX + margin, bounds.maxY + margin};
+    insertLeaf(leaf);
+    return true;
+}
+
+void AABBTree::clear() {
+    nodes.clear();
+    leaves.clear();
+    root = Null;
+    freeList = Null;
+}
+
+bool AABBTree::assign(const Node* source, std::size_t count, int rootIndex) {
+    clear();
+    int size = static_cast<int>(count);
+    if (count > static_cast<std::size_t>(std::numeric_limits<int>::max()) || rootIndex < Null || rootIndex >= size ||
+        (rootIndex != Null && (source[rootIndex].parent != Null || source[rootIndex].height < 0))) {
+        return false;
+    }
+    // Every child must name its parent back, so walking down from the root can never loop
+    for (int index = 0; index < size; ++index) {
+        const Node& node = source[index];
+        if (node.height < 0 || node.isLeaf()) {
+            continue;
+        }
+        if (node.left < 0 || node.left >= size || node.right < 0 || node.right >= size || node.left == node.right ||
+            source[node.left].parent != index || source[node.right].parent != index ||
+            source[node.left].height < 0 || source[node.right].height < 0) {
+            return false;
+        }
+    }
+
+    nodes.assign(source, source + count);
+    root = rootIndex;
+    leaves.reserve(count / 2 + 1);
+    for (int index = size - 1; index >= 0; --index) {
+        if (nodes[index].height < 0) {
+            nodes[index].parent = freeList;
+            freeList = index;
+        } else if (nodes[index].isLeaf()) {
+            leaves[nodes[index].id] = index;
+        }
+    }
+    return true;
+}
+
+bool AABBTree::contains(int id) const {
+    return leaves.count(id) != 0;
+}
+
+std::size_t AABBTree::size() const {
+    return leaves.size();
+}
+
+int AABBTree::getHeight() const {
+    return root == Null ? 0 : nodes[root].height;
+}
+
+void AABBTree::insertLeaf(int leaf) {
+    if (root == Null) {
+        root = leaf;
+        nodes[root].parent = Null;
+        return;
+    }
+
+    // Walk down picking the child whose box grows the least (surface area heuristic).
+    AABB leafBox = nodes[leaf].box;
+    int index = root;
+    while (!nodes[index].isLeaf()) {
+        int left = nodes[index].left;
+        int right = nodes[index].right;
+
+        float area = nodes[index].box.perimeter();
+        float combinedArea = AABB::merge(nodes[index].box, leafBox).perimeter();
+
+        // Cost of making a new parent for this node and the leaf
+        float cost = 2.0f * combinedArea;
+        // Minimum cost of pushing the leaf further down the tree
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        float costLeft = AABB::merge(leafBox, nodes[left].box).perimeter() + inheritanceCost;
+        if (!nodes[left].isLeaf()) {
+            costLeft -= nodes[left].box.perimeter();
+        }
+        float costRight = AABB::merge(leafBox, nodes[right].box).perimeter() + inheritanceCost;
+        if (!nodes[right].isLeaf()) {
+            costRight -= nodes[right].box.perimeter();
+        }
+
+        if (cost < costLeft && cost < costRight) {
+            break;
+        }
+        index = costLeft < costRight ? left : right;
+    }
+
+    int sibling = index;
+    int oldParent = nodes[sibling].parent;
+    int newParent = allocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].box = AABB::merge(leafBox, nodes[sibling].box);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].left = sibling;
+    nodes[newParent].right = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if (oldParent == Null) {
+        root = newParent;
+    } else if (nodes[oldParent].left == sibling) {
+        nodes[oldParent].left = newParent;
+    } else {
+        nodes[oldParent].right = newParent;
+    }
+
+    fixUpwards(nodes[leaf].parent);
+}
+
+void AABBTree::removeLeaf(int leaf) {
+    if (leaf == root) {
+        root = Null;
+        return;
+    }
+
+    int parent = nodes[leaf].parent;
+    int grandParent = nodes[parent].parent;
+    int sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+    if (grandParent == Null) {
+        root = sibling;
+        nodes[sibling].parent = Null;
+        freeNode(parent);
+        return;
+    }
+
+    if (nodes[grandParent].left == parent) {
+        nodes[grandParent].left = sibling;
+    } else {
+        nodes[grandParent].right = sibling;
+    }
+    nodes[sibling].parent = grandParent;
+    freeNode(parent);
+
+    fixUpwards(grandParent);
+}
+
+// Rebalances and refits every ancestor starting at index.
+void AABBTree::fixUpwards(int index) {
+    while (index != Null) {
+        index = balance(index);
+
+        int left = nodes[index].left;
+        int right = nodes[index].right;
+        nodes[index].height = 1 + std::max(nodes[left].height, nodes[right].height);
+        nodes[index].box = AABB::merge(nodes[left].box, nodes[right].box);
+
+        index = nodes[index].parent;
+    }
+}
+
+// Performs a left or right rotation if node A is imbalanced and returns the new subtree root.
+int AABBTree::balance(int iA) {
+    Node& A = nodes[iA];
+    if (A.isLeaf() || A.height < 2) {
+        return iA;
+    }
+
+    int iB = A.left;
+    int iC = A.right;
+    int heightDifference = nodes[iC].height - nodes[iB].height;
+
+    // Rotate C up
+    if (heightDifference > 1) {
+        int iF = nodes[iC].left;
+        int iG = nodes[iC].right;
+
+        nodes[iC].left = iA;
+        nodes[iC].parent = A.parent;
+        A.parent = iC;
+
+        if (nodes[iC].parent == Null) {
+            root = iC;
+        } else if (nodes[nodes[iC].parent].left == iA) {
+            nodes[nodes[iC].parent].left = iC;
+        } else {
+            nodes[nodes[iC].parent].right = iC;
+        }
+
+        if (nodes[iF].height > nodes[iG].height) {
+            nodes[iC].right = iF;
+            A.right = iG;
+            nodes[iG].parent = iA;
+        } else {
+            nodes[iC].right = iG;
+            A.right = iF;
+            nodes[iF].parent = iA;
+        }
+        A.box = AABB::merge(nodes[iB].box, nodes[A.right].box);
+        A.height = 1 + std::max(nodes[iB].height, nodes[A.right].height);
+        nodes[iC].box = AABB::merge(A.box, nodes[nodes[iC].right].box);
+        nodes[iC].height = 1 + std::max(A.height, nodes[nodes[iC].right].height);
+        return iC;
+    }
+
+    // Rotate B up
+    if (heightDifference < -1) {
+        int iD = nodes[iB].left;
+        int iE = nodes[iB].right;
+
+        nodes[iB].left = iA;
+        nodes[iB].parent = A.parent;
+        A.parent = iB;
+
+        if (nodes[iB].parent == Null) {
+            root = iB;
+        } else if (nodes[nodes[iB].parent].left == iA) {
+            nodes[nodes[iB].parent].left = iB;
+        } else {
+            nodes[nodes[iB].parent].right = iB;
+        }
+
+        if (nodes[iD].height > nodes[iE].height) {
+            nodes[iB].right = iD;
+            A.left = iE;
+            nodes[iE].parent = iA;
+        } else {
+            nodes[iB].right = iE;
+            A.left = iD;
+            nodes[iD].parent = iA;
+        }
+        A.box = AABB::merge(nodes[iC].box, nodes[A.left].box);
+        A.height = 1 + std::max(nodes[iC].height, nodes[A.left].height);
+        nodes[iB].box = AABB::merge(A.box, nodes[nodes[iB].right].box);
+        nodes[iB].height = 1 + std::max(A.height, nodes[nodes[iB].right].height);
+        return iB;
+    }
+
+    return iA;
+}
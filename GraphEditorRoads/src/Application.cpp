@@ -1,99 +1,177 @@
 #include "Application.h"
+#include "Log.h"
+#include "Profiler.h"
 
-Application::Application()
+// The graph is opened from here on startup, along with the journal of edits since
+static const char* const WorldFile = "world.graph";
+
+Application::Application(unsigned frameLimit, unsigned dragFrameLimit)
     : window(sf::VideoMode(1000, 1000), "Spatial Graphs"),
       viewport(window),
       graph({}, {}),
       editor(window, graph, viewport),
       world(graph, editor),
-      saveButton({800, 50}, {100, 50}, "Save", [this](){ /* Save logic here */ }),
-      resetButton({800, 110}, {100, 50}, "Reset", [this](){ this->graph = Graph({}, {}); }) {
+      saveButton({800, 50}, {100, 50}, "Save", [this](){ this->save(); }),
+      resetButton({800, 110}, {100, 50}, "Reset", [this](){ this->graph.clear(); this->editor.clearSelection(); }),
+      frameLimit(frameLimit),
+      dragFrameLimit(dragFrameLimit),
+      needsRedraw(true),
+      drawnEpoch(0),
+      drawnVersion(0),
+      buttonsHeld(0) {
     initialize();
 }
 
 void Application::initialize() {
-    bool isMouseOverButton = false;
-
-    // Main loop that runs as long as the window is open
-    while (window.isOpen()) {
-        sf::Event event;
-        // Poll for events from the window
-
-        while (window.pollEvent(event)) {
-            // If the close button is pressed, close the window
-            if (event.type == sf::Event::Closed)
-                window.close();
-            // Pass all events to the GraphEditor for handling
-            editor.handleEvent(event);
-            viewport.handleEvent(event);
-        }
-
-        saveButton.checkClick(window);
-        resetButton.checkClick(window);
-
-        // Clear the window with a dark gray color
-        window.clear(sf::Color(0, 163, 108));
+    applyFrameLimit();
+    if (journal.open(WorldFile, graph)) {
+        LOG_INFO("loaded file=%s points=%zu segments=%zu", WorldFile, graph.vertices.size(), graph.segments.size());
+    } else {
+        LOG_ERROR("cannot open file=%s, edits will not be saved", WorldFile);
+    }
+}
 
-        // Draw the regular content of the GraphEditor
-        world.draw();
-        viewport.update();  // Update the viewport
-        // Draw your world, graph, etc. with the transformed view
-        // world.draw(window); // Assuming this is where you draw the world
+void Application::save() {
+    journalEdits();
+    journal.compact();
+    LOG_INFO("save requested file=%s points=%zu segments=%zu", WorldFile, graph.vertices.size(), graph.segments.size());
+}
 
-        // Save the current view
-        sf::View currentView = window.getView();
+void Application::journalEdits() {
+    if (!graph.edits.empty()) {
+        journal.append(graph.edits);
+        graph.clearEdits();
+    }
+}
 
-        // Reset to the default view before drawing your UI
-        window.setView(window.getDefaultView());
+void Application::setFrameLimits(unsigned frameLimit, unsigned dragFrameLimit) {
+    this->frameLimit = frameLimit;
+    this->dragFrameLimit = dragFrameLimit;
+    applyFrameLimit();
+}
 
-        // Draw UI elements like buttons which should be unaffected by the view transformations
-        saveButton.draw(window);
-        resetButton.draw(window);
+// The window sleeps in display() to keep to the limit. While dragging that sleep is
+// latency between the mouse and the point under it, so drags get their own limit.
+void Application::applyFrameLimit() {
+    window.setFramerateLimit(buttonsHeld > 0 ? dragFrameLimit : frameLimit);
+}
 
-        // Restore the previous view to continue drawing the rest of the scene
-        window.setView(currentView);
-        // Display the drawn content on the window
-        window.display();
+bool Application::handleEvent(const sf::Event& event) {
+    PROFILE_FUNCTION();
+    if (event.type == sf::Event::Closed) {
+        window.close();
+        return false;
+    }
+#ifdef GRAPH_ENABLE_PROFILER
+    if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3) {
+        profilerOverlay.toggle();
+        return true;
+    }
+#endif
+    editor.handleEvent(event);
+    viewport.handleEvent(event);
+
+    switch (event.type) {
+    case sf::Event::MouseButtonPressed:
+        if (buttonsHeld++ == 0) {
+            applyFrameLimit();
+        }
+        if (event.mouseButton.button == sf::Mouse::Left) {
+            saveButton.checkClick(window);
+            resetButton.checkClick(window);
+        }
+        return true;
+    case sf::Event::MouseButtonReleased:
+        if (buttonsHeld > 0 && --buttonsHeld == 0) {
+            applyFrameLimit();
+        }
+        return true;
+    case sf::Event::LostFocus:
+        // Releases outside the window may never arrive
+        if (buttonsHeld > 0) {
+            buttonsHeld = 0;
+            applyFrameLimit();
+        }
+        return false;
+    case sf::Event::MouseMoved:
+    case sf::Event::MouseWheelScrolled:
+    case sf::Event::Resized:
+    case sf::Event::GainedFocus:
+    case sf::Event::MouseEntered:
+    case sf::Event::MouseLeft:
+        return true;
+    default:
+        // Keys, text and joysticks change nothing on screen
+        return false;
     }
 }
 
 void Application::handleEvents() {
     sf::Event event;
+    // Nothing to draw: sleep until the next event instead of spinning
+    if (!needsRedraw) {
+        if (!window.waitEvent(event)) {
+            return;
+        }
+        PROFILE_FRAME_BEGIN();
+        needsRedraw |= handleEvent(event);
+    } else {
+        PROFILE_FRAME_BEGIN();
+    }
+    // Everything already queued is handled before drawing, so a burst of mouse moves costs one frame
     while (window.pollEvent(event)) {
-        if (event.type == sf::Event::Closed)
-            window.close();
-        editor.handleEvent(event);
-        viewport.handleEvent(event);
+        needsRedraw |= handleEvent(event);
     }
-    saveButton.checkClick(window);
-    resetButton.checkClick(window);
 }
 
 void Application::update() {
-    // Update application state
+    PROFILE_FUNCTION();
+    // Queued once a frame; the journal's writer puts them on disk in batches
+    journalEdits();
+    // Edits made outside of events, e.g. by the buttons, show up as a new graph version
+    if (graph.epoch != drawnEpoch || graph.version != drawnVersion) {
+        needsRedraw = true;
+    }
 }
 
 void Application::render() {
+    PROFILE_FUNCTION();
     window.clear(sf::Color(0, 163, 108));
-    world.draw();
+    // Update the viewport first so the world is culled against the view it is drawn with
     viewport.update();
+    world.draw();
 
+    // Draw the UI unaffected by the view transformations, then restore the view
     sf::View currentView = window.getView();
     window.setView(window.getDefaultView());
 
     saveButton.draw(window);
     resetButton.draw(window);
+#ifdef GRAPH_ENABLE_PROFILER
+    profilerOverlay.draw(window);
+#endif
 
     window.setView(currentView);
+    // The frame ends before display(), which also sleeps to keep to the frame limit
+    PROFILE_FRAME_END();
     window.display();
+
+    needsRedraw = false;
+    drawnEpoch = graph.epoch;
+    drawnVersion = graph.version;
 }
 
 void Application::run() {
     while (window.isOpen()) {
         handleEvents();
         update();
-        render();
+        if (needsRedraw && window.isOpen()) {
+            render();
+        }
     }
+#ifdef GRAPH_ENABLE_PROFILER
+    Profiler::instance().writeChromeTrace("profile.json");
+#endif
 }
 
 bool Application::isRunning() const {
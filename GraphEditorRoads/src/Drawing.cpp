@@ -0,0 +1,24 @@
+#include "Drawing.h"
+#include <cmath>
+#include "Constants.h"
+
+void drawPoint(sf::RenderTarget& target, const Point& point, float size, sf::Color color) {
+    sf::CircleShape shape(size);
+    shape.setFillColor(color);
+    shape.setPosition(point.x - size, point.y - size);
+    target.draw(shape);
+}
+
+void drawSegment(sf::RenderTarget& target, const Segment& segment, const VertexBuffer& vertices, float width,
+                 sf::Color color) {
+    sf::Vector2f start(vertices.x(segment.a), vertices.y(segment.a));
+    sf::Vector2f direction = sf::Vector2f(vertices.x(segment.b), vertices.y(segment.b)) - start;
+    float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+
+    // A rectangle from the first end point, turned to point at the second
+    sf::RectangleShape line(sf::Vector2f(length, width));
+    line.setPosition(start);
+    line.setRotation(static_cast<float>(std::atan2(direction.y, direction.x) * 180.0 / MY_PI));
+    line.setFillColor(color);
+    target.draw(line);
+}
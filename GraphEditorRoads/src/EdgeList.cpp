@@ -0,0 +1,18 @@
+#include "EdgeList.h"
+#include "Graph.h"
+
+EdgeList toEdgeList(const Graph& graph) {
+    EdgeList list;
+    // Vertex slots have holes where points were removed
+    std::vector<std::uint32_t> position(graph.vertices.capacity(), 0);
+    list.points.reserve(graph.vertices.size());
+    for (std::uint32_t slot : graph.vertices.live()) {
+        position[slot] = static_cast<std::uint32_t>(list.points.size());
+        list.points.push_back(Point(graph.vertices.x(slot), graph.vertices.y(slot)));
+    }
+    list.segments.reserve(graph.segments.size());
+    for (const Segment& segment : graph.segments) {
+        list.segments.push_back(Segment(position[segment.a], position[segment.b]));
+    }
+    return list;
+}
@@ -0,0 +1,428 @@
+#include "EditJournal.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include "GraphFile.h"
+#include "Log.h"
+#include "Profiler.h"
+
+namespace {
+
+const char Magic[8] = {'G', 'R', 'A', 'P', 'H', 'J', 'N', 'L'};
+const std::uint32_t Version = 1;
+const std::uint32_t ByteOrderMark = 0x01020304u;
+// Far more than a write interval of editing can produce; a larger size means damage
+const std::uint32_t MaxBatchBytes = 1u << 28;
+
+struct JournalHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint64_t baseStamp;
+    std::uint64_t reserved;
+};
+
+struct BatchHeader {
+    std::uint32_t bytes;
+    std::uint32_t checksum;
+};
+
+static_assert(sizeof(JournalHeader) == 32, "journal header layout changed");
+static_assert(sizeof(BatchHeader) == 8, "journal batch header layout changed");
+
+// FNV-1a; enough to tell a batch cut short or overwritten from a whole one
+std::uint32_t checksum(const unsigned char* bytes, std::size_t count) {
+    std::uint32_t hash = 2166136261u;
+    for (std::size_t i = 0; i < count; ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Coordinates stored after the type byte of each kind of edit, or -1 for an unknown type
+int coordinateCount(std::uint8_t type) {
+    switch (type) {
+        case GraphEdit::AddPoint:
+        case GraphEdit::RemovePoint:
+            return 2;
+        case GraphEdit::MovePoint:
+        case GraphEdit::AddSegment:
+        case GraphEdit::RemoveSegment:
+            return 4;
+        case GraphEdit::Clear:
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+void encode(const GraphEdit& edit, std::vector<unsigned char>& bytes) {
+    const float coordinates[4] = {edit.x1, edit.y1, edit.x2, edit.y2};
+    std::size_t size = coordinateCount(edit.type) * sizeof(float);
+    bytes.push_back(edit.type);
+    bytes.insert(bytes.end(), reinterpret_cast<const unsigned char*>(coordinates),
+                 reinterpret_cast<const unsigned char*>(coordinates) + size);
+}
+
+// Decodes a whole batch, so a damaged one is rejected before any of it is applied.
+bool decode(const std::vector<unsigned char>& bytes, std::vector<GraphEdit>& edits) {
+    edits.clear();
+    for (std::size_t i = 0; i < bytes.size();) {
+        int count = coordinateCount(bytes[i]);
+        if (count < 0 || bytes.size() - i - 1 < count * sizeof(float)) {
+            return false;
+        }
+        float coordinates[4] = {0, 0, 0, 0};
+        std::memcpy(coordinates, &bytes[i + 1], count * sizeof(float));
+        edits.push_back({static_cast<GraphEdit::Type>(bytes[i]), coordinates[0], coordinates[1], coordinates[2],
+                         coordinates[3]});
+        i += 1 + count * sizeof(float);
+    }
+    return true;
+}
+
+std::uint64_t sizeOfFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    return file ? static_cast<std::uint64_t>(file.tellg()) : 0;
+}
+
+// Stamps only need to differ between the bases one journal could meet; 0 means none
+std::uint64_t makeStamp() {
+    std::random_device device;
+    std::uint64_t stamp = (static_cast<std::uint64_t>(device()) << 32 | device()) ^
+                          static_cast<std::uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+    return stamp != 0 ? stamp : 1;
+}
+
+} // namespace
+
+EditJournal::EditJournal()
+    : journal(nullptr), baseStamp(0), journalBytes(0), appended(0), attempted(0), flushTarget(0), failing(false),
+      compactRequested(false), running(false), writeInterval(1000), compactBytes(16 << 20),
+      journalBytesWritten(0), baseBytesWritten(0) {}
+
+EditJournal::~EditJournal() {
+    close();
+}
+
+bool EditJournal::open(const std::string& baseFile, Graph& graph) {
+    PROFILE_SCOPE("EditJournal::open");
+    close();
+    this->baseFile = baseFile;
+    journalFile = baseFile + ".journal";
+    baseStamp = 0;
+    journalBytes = 0;
+    journalBytesWritten = 0;
+    baseBytesWritten = 0;
+    failing = compactRequested = false;
+
+    graph.recordEdits = false;
+    if (std::ifstream(baseFile)) {
+        GraphFile file;
+        if (!file.open(baseFile)) {
+            return false;
+        }
+        loadGraph(file, graph);
+        baseStamp = file.getJournalStamp();
+    } else {
+        graph = Graph({}, {});
+    }
+    LOG_INFO("journal base file=%s points=%zu segments=%zu", baseFile.c_str(), graph.vertices.size(),
+             graph.segments.size());
+
+    // A journal replayed to its end is appended to; anything else is replaced by the
+    // first compaction, which the first edit triggers
+    std::uint64_t valid = replay(journalFile, baseStamp, graph);
+    if (valid > 0 && valid == sizeOfFile(journalFile)) {
+        journal = std::fopen(journalFile.c_str(), "ab");
+        journalBytes = valid;
+    }
+    graph.clearEdits();
+    graph.recordEdits = true;
+
+    running = true;
+    writer = std::thread(&EditJournal::run, this);
+    return true;
+}
+
+void EditJournal::close() {
+    if (!writer.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wake.notify_one();
+    writer.join();
+    if (journal) {
+        std::fclose(journal);
+        journal = nullptr;
+    }
+}
+
+void EditJournal::append(const std::vector<GraphEdit>& edits) {
+    if (edits.empty() || !writer.joinable()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const GraphEdit& edit : edits) {
+        // The point a move starts from is where the queued move left it
+        if (edit.type == GraphEdit::MovePoint && !pending.empty()) {
+            GraphEdit& last = pending.back();
+            if (last.type == GraphEdit::MovePoint && last.x2 == edit.x1 && last.y2 == edit.y1) {
+                last.x2 = edit.x2;
+                last.y2 = edit.y2;
+                continue;
+            }
+        }
+        pending.push_back(edit);
+    }
+    ++appended;
+}
+
+bool EditJournal::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!writer.joinable()) {
+        return !failing;
+    }
+    std::uint64_t target = appended;
+    flushTarget = std::max(flushTarget, target);
+    wake.notify_one();
+    written.wait(lock, [this, target] { return attempted >= target; });
+    return !failing;
+}
+
+void EditJournal::compact() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        compactRequested = true;
+    }
+    wake.notify_one();
+}
+
+void EditJournal::setWriteInterval(std::chrono::milliseconds interval) {
+    std::lock_guard<std::mutex> lock(mutex);
+    writeInterval = interval;
+}
+
+void EditJournal::setCompactBytes(std::uint64_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    compactBytes = bytes;
+}
+
+std::uint64_t EditJournal::getJournalBytesWritten() const {
+    return journalBytesWritten.load();
+}
+
+std::uint64_t EditJournal::getBaseBytesWritten() const {
+    return baseBytesWritten.load();
+}
+
+void EditJournal::run() {
+    // Edits taken from the queue but not yet on disk
+    std::vector<GraphEdit> unwritten;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait_for(lock, writeInterval, [this] { return !running || compactRequested || flushTarget > attempted; });
+        unwritten.insert(unwritten.end(), pending.begin(), pending.end());
+        pending.clear();
+        std::uint64_t target = appended;
+        bool compacting = compactRequested;
+        std::uint64_t limit = compactBytes;
+        compactRequested = false;
+        lock.unlock();
+
+        bool saved = unwritten.empty() || (journal && writeBatch(unwritten));
+        if (saved) {
+            unwritten.clear();
+        }
+        // Without a journal for the current base, edits can only be saved by compacting
+        if (compacting || !saved || journalBytes >= limit) {
+            if (compactFiles(unwritten)) {
+                unwritten.clear();
+                saved = true;
+            }
+        }
+
+        lock.lock();
+        attempted = target;
+        failing = !saved;
+        written.notify_all();
+        if (!running && pending.empty()) {
+            if (!unwritten.empty()) {
+                LOG_ERROR("journal lost edits=%zu file=%s", unwritten.size(), journalFile.c_str());
+            }
+            return;
+        }
+    }
+}
+
+bool EditJournal::writeBatch(const std::vector<GraphEdit>& batch) {
+    PROFILE_SCOPE("EditJournal::writeBatch");
+    std::vector<unsigned char> bytes(sizeof(BatchHeader));
+    for (const GraphEdit& edit : batch) {
+        encode(edit, bytes);
+    }
+    BatchHeader header = {static_cast<std::uint32_t>(bytes.size() - sizeof(BatchHeader)), 0};
+    header.checksum = checksum(bytes.data() + sizeof(BatchHeader), header.bytes);
+    std::memcpy(bytes.data(), &header, sizeof(header));
+
+    if (std::fwrite(bytes.data(), 1, bytes.size(), journal) != bytes.size() || !syncFile(journal)) {
+        // What reached the file may end in a partial batch, so nothing more goes after it
+        LOG_ERROR("journal write failed file=%s", journalFile.c_str());
+        std::fclose(journal);
+        journal = nullptr;
+        journalBytes = 0;
+        return false;
+    }
+    journalBytes += bytes.size();
+    journalBytesWritten += bytes.size();
+    LOG_DEBUG("journal wrote edits=%zu bytes=%zu", batch.size(), bytes.size());
+    return true;
+}
+
+// Writes the base, the journal and the unwritten edits as a new base, then starts an
+// empty journal on it. Returns whether the unwritten edits are now saved.
+bool EditJournal::compactFiles(const std::vector<GraphEdit>& unwritten) {
+    PROFILE_SCOPE("EditJournal::compact");
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    Graph graph({}, {});
+    std::uint64_t stamp = 0;
+    if (std::ifstream(baseFile)) {
+        GraphFile file;
+        if (!file.open(baseFile)) {
+            LOG_ERROR("journal cannot compact, base unreadable file=%s", baseFile.c_str());
+            return false;
+        }
+        loadGraph(file, graph);
+        stamp = file.getJournalStamp();
+    }
+    if (journal) {
+        std::fflush(journal);
+    }
+    replay(journalFile, stamp, graph);
+    for (const GraphEdit& edit : unwritten) {
+        graph.applyEdit(edit);
+    }
+
+    // Once the base carries the new stamp the old journal no longer replays onto it, so
+    // there is no moment at which its edits could be applied twice. saveGraph only returns
+    // true once the base and its directory are on disk; until then the journal is kept.
+    std::uint64_t newStamp = makeStamp();
+    if (!saveGraph(baseFile, graph, true, newStamp)) {
+        GraphFile written;
+        if (!written.open(baseFile) || written.getJournalStamp() != newStamp) {
+            LOG_ERROR("journal cannot compact, base not written file=%s", baseFile.c_str());
+            return false;
+        }
+        // The new base replaced the old one but may not be on disk yet. Leave the old
+        // journal whole, which still replays onto the old base should that be what
+        // survives, and compact again at the next edit.
+        baseStamp = newStamp;
+        baseBytesWritten += sizeOfFile(baseFile);
+        if (journal) {
+            std::fclose(journal);
+            journal = nullptr;
+        }
+        journalBytes = 0;
+        LOG_WARN("journal compacted without syncing the base file=%s", baseFile.c_str());
+        return true;
+    }
+    baseStamp = newStamp;
+    baseBytesWritten += sizeOfFile(baseFile);
+    if (journal) {
+        std::fclose(journal);
+        journal = nullptr;
+    }
+    journalBytes = 0;
+    if (!startJournal(newStamp)) {
+        LOG_ERROR("journal cannot be started file=%s", journalFile.c_str());
+    }
+    LOG_INFO("journal compacted file=%s points=%zu segments=%zu ms=%.1f", baseFile.c_str(), graph.vertices.size(),
+             graph.segments.size(),
+             std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    return true;
+}
+
+bool EditJournal::startJournal(std::uint64_t stamp) {
+    journal = std::fopen(journalFile.c_str(), "wb");
+    if (!journal) {
+        return false;
+    }
+    JournalHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.byteOrder = ByteOrderMark;
+    header.baseStamp = stamp;
+    if (std::fwrite(&header, 1, sizeof(header), journal) != sizeof(header) || !syncFile(journal) ||
+        !syncDirectory(journalFile)) {
+        std::fclose(journal);
+        journal = nullptr;
+        return false;
+    }
+    journalBytes = sizeof(header);
+    journalBytesWritten += sizeof(header);
+    return true;
+}
+
+std::uint64_t EditJournal::replay(const std::string& journalFile, std::uint64_t baseStamp, Graph& graph) {
+    PROFILE_SCOPE("EditJournal::replay");
+    std::FILE* file = std::fopen(journalFile.c_str(), "rb");
+    if (!file) {
+        return 0;
+    }
+    JournalHeader header;
+    if (std::fread(&header, 1, sizeof(header), file) != sizeof(header) ||
+        std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.version != Version ||
+        header.byteOrder != ByteOrderMark) {
+        LOG_WARN("journal unreadable, ignored file=%s", journalFile.c_str());
+        std::fclose(file);
+        return 0;
+    }
+    // Left by a crash during compaction, or by the base being replaced; either way the
+    // base does not start where the journal does
+    if (baseStamp == 0 || header.baseStamp != baseStamp) {
+        LOG_INFO("journal belongs to another base, ignored file=%s", journalFile.c_str());
+        std::fclose(file);
+        return 0;
+    }
+
+    bool record = graph.recordEdits;
+    graph.recordEdits = false;
+    std::uint64_t valid = sizeof(header);
+    std::size_t count = 0;
+    std::vector<unsigned char> bytes;
+    std::vector<GraphEdit> edits;
+    for (;;) {
+        BatchHeader batch;
+        std::size_t read = std::fread(&batch, 1, sizeof(batch), file);
+        if (read == 0 && std::feof(file)) {
+            break;
+        }
+        bool whole = read == sizeof(batch) && batch.bytes <= MaxBatchBytes;
+        if (whole) {
+            bytes.resize(batch.bytes);
+            whole = std::fread(bytes.data(), 1, bytes.size(), file) == bytes.size() &&
+                    checksum(bytes.data(), bytes.size()) == batch.checksum && decode(bytes, edits);
+        }
+        if (!whole) {
+            LOG_WARN("journal ends in a damaged batch, ignored file=%s offset=%llu", journalFile.c_str(),
+                     static_cast<unsigned long long>(valid));
+            break;
+        }
+        for (const GraphEdit& edit : edits) {
+            graph.applyEdit(edit);
+        }
+        count += edits.size();
+        valid += sizeof(batch) + batch.bytes;
+    }
+    std::fclose(file);
+    graph.recordEdits = record;
+    LOG_INFO("journal replayed file=%s edits=%zu bytes=%llu", journalFile.c_str(), count,
+             static_cast<unsigned long long>(valid));
+    return valid;
+}
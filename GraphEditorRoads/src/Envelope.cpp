@@ -1,97 +1,97 @@
 #include "Envelope.h"
 #include <cmath>
 #include "Constants.h"
-#include "utils.h"
-#include <iostream>
+#include "Profiler.h"
 
-Envelope::Envelope(const Segment& skeleton, double width, int roundness): skeleton(skeleton),
-                    roundedRect(sf::Vector2f(distance(skeleton.p1, skeleton.p2), width),5,5){
-
-    sf::Vector2f midpoint((skeleton.p1.x + skeleton.p2.x) / 2.0f, (skeleton.p1.y + skeleton.p2.y) / 2.0f);
-    roundedRect.setPosition(midpoint);
-
-    // Set the origin to the center for rotation
-    roundedRect.setOrigin(roundedRect.getSize().x / 2.0f, roundedRect.getSize().y / 2.0f);
-
-    // Calculate the rotation angle based on the segment's orientation
-    float angle = std::atan2(skeleton.p2.y - skeleton.p1.y, skeleton.p2.x - skeleton.p1.x);
-    roundedRect.setRotation(angle * 180.0f / M_PI);
-
-    // Set the corner radius and other properties
-    roundedRect.setCornersRadius(width / 2.0f);
-
-    //roundedRect.setOutlineThickness(0); // Adjust as needed
-    //roundedRect.setFillColor(sf::Color(0, 71, 171, 128)); // Set fill color
-    //roundedRect.setOutlineColor(sf::Color(0, 71, 171, 128)); // Set outline color
+Envelope::Envelope(const Segment& skeleton, double width) : skeleton(skeleton), width(width) {}
 
+const Segment& Envelope::getSkeleton() const {
+    return this->skeleton;
 }
 
-
-void Envelope::setTexture(const std::shared_ptr<sf::Texture>& texture) {
-    // Pass the raw pointer of the shared_ptr to the RoundedRectangleShape
-    roundedRect.setTexture(texture.get(), false);
+double Envelope::getWidth() const {
+    return this->width;
 }
 
-void Envelope::updateSkeleton(const Segment& newSkeleton) {
-    skeleton = newSkeleton;
-
-    float newLength = distance(skeleton.p1, skeleton.p2);
-    sf::Vector2f midpoint((skeleton.p1.x + skeleton.p2.x) / 2.0f, (skeleton.p1.y + skeleton.p2.y) / 2.0f);
-
-    // Set origin before setting position and rotation
-    roundedRect.setOrigin(newLength / 2.0f, 25 / 2.0f);
-
-    // Update the size of the rectangle
-    roundedRect.setSize(sf::Vector2f(newLength, 25));
-
-    // Update the position of the rectangle
-    roundedRect.setPosition(midpoint);
-    // Calculate and set the rotation of the rectangle
-    float angle = std::atan2(skeleton.p2.y - skeleton.p1.y, skeleton.p2.x - skeleton.p1.x) * 180.0f / M_PI;
-    roundedRect.setRotation(angle);
-
-    // Debug output
-    //std::cout << "Envelope updated: Midpoint (" << midpoint.x << ", " << midpoint.y
-             // << "), Length: " << newLength << ", Angle: " << angle << std::endl;
+namespace {
+
+// Outline of a unit envelope, relative to the centre of the rectangle: each point is a
+// corner arc direction plus the side of the road its corner sits on. The corners sit on
+// the centre line because the ends are fully rounded. The two tips of the outline lie
+// exactly on the end points, and are copied from them so envelopes meeting at a node
+// share their tips to the bit.
+struct OutlinePoint {
+    float cos, sin, side;
+    bool tip;
+};
+
+const OutlinePoint* unitOutline() {
+    static const std::vector<OutlinePoint> outline = [] {
+        std::vector<OutlinePoint> points;
+        float deltaAngle = static_cast<float>(MY_PI / 2) / (Envelope::CornerPoints - 1);
+        for (int corner = 0; corner < 4; ++corner) {
+            for (int i = 0; i < Envelope::CornerPoints; ++i) {
+                float angle = deltaAngle * (corner * (Envelope::CornerPoints - 1) + i);
+                // Corners 0 and 3 are at the far end of the skeleton, 1 and 2 at the near end
+                float side = (corner == 0 || corner == 3) ? 1.0f : -1.0f;
+                bool tip = (corner * (Envelope::CornerPoints - 1) + i) % (2 * (Envelope::CornerPoints - 1)) == 0;
+                points.push_back({std::cos(angle), -std::sin(angle), side, tip});
+            }
+        }
+        return points;
+    }();
+    return outline.data();
 }
 
+} // namespace
 
-void Envelope::setColor(sf::Color newColor) {
-    roundedRect.setFillColor(newColor);
-    // If you have an outline or a different color for it, set it here as well.
-    roundedRect.setOutlineColor(newColor);
+// Lays out a rounded rectangle along the skeleton, as sf::RoundedRectangleShape would
+// with its origin at the centre, then rotates and moves it onto the segment.
+// The arc directions come from a table, so this is a scale and a translate per point.
+void Envelope::getPolygon(const VertexBuffer& vertices, Point* out) const {
+    getPolygons(vertices, this, 1, out);
 }
 
-const Segment& Envelope::getSkeleton() const {
-    //std::cout << "Get Skeleton called: (" << skeleton.p1.x << "," << skeleton.p2.x << ")" << std::endl;
-    return this->skeleton;
+void Envelope::getPolygons(const VertexBuffer& vertices, const Envelope* envelopes, std::size_t count, Point* out) {
+    PROFILE_SCOPE("Envelope::getPolygons");
+    const OutlinePoint* outline = unitOutline();
+    for (std::size_t e = 0; e < count; ++e) {
+        const Segment& skeleton = envelopes[e].skeleton;
+        float ax = vertices.x(skeleton.a), ay = vertices.y(skeleton.a);
+        float bx = vertices.x(skeleton.b), by = vertices.y(skeleton.b);
+        float length = std::sqrt((bx - ax) * (bx - ax) + (by - ay) * (by - ay));
+        float dx = length > 0 ? (bx - ax) / length : 1.0f;
+        float dy = length > 0 ? (by - ay) / length : 0.0f;
+        float midX = (ax + bx) / 2.0f, midY = (ay + by) / 2.0f;
+        float radius = static_cast<float>(envelopes[e].width) / 2.0f;
+        float reach = length / 2.0f - radius;
+
+        for (int i = 0; i < 4 * CornerPoints; ++i) {
+            if (outline[i].tip) {
+                *out++ = outline[i].side > 0 ? Point(bx, by) : Point(ax, ay);
+                continue;
+            }
+            float u = radius * outline[i].cos + reach * outline[i].side;
+            float v = radius * outline[i].sin;
+            *out++ = Point(midX + u * dx - v * dy, midY + u * dy + v * dx);
+        }
+    }
 }
 
-void Envelope::updateRoundedRect() {
-    sf::Vector2f midpoint((skeleton.p1.x + skeleton.p2.x) / 2.0f, (skeleton.p1.y + skeleton.p2.y) / 2.0f);
-    roundedRect.setPosition(midpoint);
-
-    float angle = std::atan2(skeleton.p2.y - skeleton.p1.y, skeleton.p2.x - skeleton.p1.x);
-    roundedRect.setRotation(angle * 180.0f / M_PI);
-
-    // Calculate the length of the segment
-    float segmentLength = distance(skeleton.p1, skeleton.p2);
-    // Get the size of the texture
-    sf::Vector2u texSize = texture.getSize();
-
-    // Check that the texture size is greater than 0 to avoid division by zero
-    if (texSize.x > 0 && texSize.y > 0) {
-        // Calculate the number of times the texture should repeat
-        int repeatCount = std::ceil(segmentLength / texSize.x);
-        // Set the texture rectangle
-        roundedRect.setTextureRect(sf::IntRect(0, 0, texSize.x * repeatCount, texSize.y));
-    }
+Polygon Envelope::getOutline(const VertexBuffer& vertices) const {
+    Polygon outline;
+    getOutline(vertices, outline);
+    return outline;
 }
 
-double Envelope::getWidth() const {
-    return this->width;
+void Envelope::getOutline(const VertexBuffer& vertices, Polygon& outline) const {
+    Point points[4 * CornerPoints];
+    getPolygon(vertices, points);
+    outline.assign(points, getPointCount());
 }
 
-void Envelope::draw(sf::RenderWindow& window) const {
-    window.draw(roundedRect);
+std::vector<Point> Envelope::getPolygon(const VertexBuffer& vertices) const {
+    std::vector<Point> polygon(getPointCount());
+    getPolygon(vertices, polygon.data());
+    return polygon;
 }
@@ -1,25 +1,199 @@
 #include "Graph.h"
 #include <algorithm>
 #include <cmath>
-#include <iostream>
-#include "RoundedRectangleShape.h"
 #include "utils.h"
+#include "Constants.h"
+#include "Intersections.h"
+#include "Log.h"
+#include "Profiler.h"
+#include <atomic>
+
+// Bounds of a segment padded by a margin on every side.
+static AABB segmentBounds(const Segment& segment, const VertexBuffer& vertices, float padding = ROAD_WIDTH / 2.0f) {
+    float x1 = vertices.x(segment.a), y1 = vertices.y(segment.a);
+    float x2 = vertices.x(segment.b), y2 = vertices.y(segment.b);
+    return {std::min(x1, x2) - padding, std::min(y1, y2) - padding,
+            std::max(x1, x2) + padding, std::max(y1, y2) + padding};
+}
+
+// Graphs are built on the journal's thread too, so epochs are taken atomically.
+static unsigned long long nextEpoch() {
+    static std::atomic<unsigned long long> next(1);
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
 
 // Constructor: Initializes the graph with the given points and segments.
 Graph::Graph(const std::vector<Point>& points, const std::vector<Segment>& segments,
              float min_x, float max_x, float min_y, float max_y)
-    : points(points), segments(segments),
-      minX(min_x), maxX(max_x), minY(min_y), maxY(max_y), lastPointIndex(-1) {
-    resourceManager.loadTexture("roadTexture", "Assets/road.png");
-    if (!points.empty()) {
-        lastPointIndex = this->points.size() - 1;
-        // Initialize boundary based on existing points
-        for (const auto& point : this->points) {
-            updateBoundary(point);
+    : minX(min_x), maxX(max_x), minY(min_y), maxY(max_y), snapIndex(SNAP_TOLERANCE), version(0),
+      epoch(nextEpoch()), recordEdits(false) {
+    // Predefined segments refer to points by position in the list, which maps to the vertex slots taken here.
+    std::vector<std::uint32_t> slots;
+    vertices.reserve(points.size());
+    for (const auto& point : points) {
+        int existing = snapIndex.findPoint(point.x, point.y);
+        if (existing >= 0) {
+            slots.push_back(existing);
+            continue;
         }
+        lastPoint = vertices.add(point.x, point.y);
+        slots.push_back(lastPoint.index);
+        snapIndex.insertPoint(slots.back(), point.x, point.y);
+        updateBoundary(point);
+    }
+    for (const auto& segment : segments) {
+        if (segment.a >= slots.size() || segment.b >= slots.size()) {
+            continue;
+        }
+        std::uint32_t a = slots[segment.a];
+        std::uint32_t b = slots[segment.b];
+        if (a == b || snapIndex.findSegment(a, b) >= 0) {
+            continue;
+        }
+        Handle handle = this->segments.insert(Segment(a, b));
+        Segment& newSegment = *this->segments.get(handle);
+        newSegment.id = handle.index;
+        snapIndex.insertSegment(a, b, newSegment.id);
+        attachEnvelope(newSegment);
+    }
+    rebuildIndexes();
+}
+
+void Graph::assign(const float* xs, const float* ys, std::size_t vertexCount,
+                   const std::uint32_t* segmentEnds, std::size_t segmentCount,
+                   const AABBTree::Node* treeNodes, std::size_t treeNodeCount, int treeRoot) {
+    PROFILE_SCOPE("Graph::assign");
+    vertices.assign(xs, ys, vertexCount);
+    epoch = nextEpoch();
+    segments.clear();
+    roadEnvelopes.clear();
+    segmentEnvelopes.clear();
+    clearChanges();
+    minX = minY = std::numeric_limits<float>::max();
+    maxX = maxY = std::numeric_limits<float>::lowest();
+    for (std::size_t i = 0; i < vertexCount; ++i) {
+        minX = std::min(minX, xs[i]);
+        maxX = std::max(maxX, xs[i]);
+        minY = std::min(minY, ys[i]);
+        maxY = std::max(maxY, ys[i]);
+    }
+    lastPoint = vertexCount > 0 ? vertices.handleOf(static_cast<std::uint32_t>(vertexCount - 1)) : Handle();
+
+    segments.reserve(segmentCount);
+    roadEnvelopes.reserve(segmentCount);
+    segmentEnvelopes.reserve(segmentCount);
+    for (std::size_t i = 0; i < segmentCount; ++i) {
+        Handle handle = segments.insert(Segment(segmentEnds[2 * i], segmentEnds[2 * i + 1]));
+        Segment& segment = *segments.get(handle);
+        segment.id = handle.index;
+        attachEnvelope(segment);
+    }
+
+    bool treeLoaded = treeNodes && segmentIndex.assign(treeNodes, treeNodeCount, treeRoot) &&
+                      segmentIndex.size() == segmentCount;
+    rebuildIndexes(!treeLoaded);
+}
+
+// Rebuilds the spatial indexes and incidence lists from the stored points and segments.
+// A segment tree restored from a file can be kept instead of being rebuilt.
+void Graph::rebuildIndexes(bool segmentTree) {
+    PROFILE_SCOPE("Graph::rebuildIndexes");
+    pointIndex.clear();
+    if (segmentTree) {
+        segmentIndex.clear();
+    }
+    topology.clear();
+    snapIndex.clear();
+    for (std::uint32_t index : vertices.live()) {
+        pointIndex.insert(index, vertices.x(index), vertices.y(index));
+        snapIndex.insertPoint(index, vertices.x(index), vertices.y(index));
+        markVertex(index);
+    }
+    for (const auto& segment : segments) {
+        if (segmentTree) {
+            segmentIndex.insert(segment.id, segmentBounds(segment, vertices));
+        }
+        topology.addSegment(segment.id, segment.a, segment.b);
+        snapIndex.insertSegment(segment.a, segment.b, segment.id);
+        markSegment(segment.id);
+    }
+}
+
+void Graph::markVertex(std::uint32_t index) {
+    changedVertices.push_back(index);
+    ++version;
+}
+
+void Graph::markSegment(std::uint32_t index) {
+    changedSegments.push_back(index);
+    ++version;
+}
+
+void Graph::clearChanges() {
+    changedVertices.clear();
+    changedSegments.clear();
+}
+
+void Graph::recordEdit(GraphEdit::Type type, float x1, float y1, float x2, float y2) {
+    if (recordEdits) {
+        edits.push_back({type, x1, y1, x2, y2});
+    }
+}
+
+void Graph::clearEdits() {
+    edits.clear();
+}
+
+// Replays an edit through the same methods that recorded it, finding its points by position.
+void Graph::applyEdit(const GraphEdit& edit) {
+    int a = -1, b = -1;
+    switch (edit.type) {
+        case GraphEdit::AddPoint:
+            if (!addPoint(Point(edit.x1, edit.y1)).isNull()) {
+                updateBoundary(Point(edit.x1, edit.y1));
+            }
+            break;
+        case GraphEdit::RemovePoint:
+            a = snapIndex.findPoint(edit.x1, edit.y1);
+            if (a >= 0) {
+                removePoint(vertices.handleOf(a));
+            }
+            break;
+        case GraphEdit::MovePoint:
+            a = snapIndex.findPoint(edit.x1, edit.y1);
+            if (a >= 0) {
+                movePoint(vertices.handleOf(a), edit.x2, edit.y2);
+            }
+            break;
+        case GraphEdit::AddSegment:
+        case GraphEdit::RemoveSegment:
+            a = snapIndex.findPoint(edit.x1, edit.y1);
+            b = snapIndex.findPoint(edit.x2, edit.y2);
+            if (a >= 0 && b >= 0 && edit.type == GraphEdit::AddSegment) {
+                addSegment(Segment(a, b));
+            } else if (a >= 0 && b >= 0) {
+                removeSegment(Segment(a, b));
+            }
+            break;
+        case GraphEdit::Clear:
+            clear();
+            break;
     }
 }
 
+// Replaces the graph with an empty one. It is a new graph with a new epoch, which tells
+// retained renderers to rebuild rather than update.
+void Graph::clear() {
+    float tolerance = getSnapTolerance();
+    bool record = recordEdits;
+    std::vector<GraphEdit> pending = std::move(edits);
+    *this = Graph({}, {});
+    setSnapTolerance(tolerance);
+    recordEdits = record;
+    edits = std::move(pending);
+    recordEdit(GraphEdit::Clear, 0, 0);
+}
+
 void Graph::updateBoundary(const Point& newPoint) {
     // Update minX and maxX
     if (newPoint.x < minX) minX = newPoint.x;
@@ -30,60 +204,142 @@ void Graph::updateBoundary(const Point& newPoint) {
     if (newPoint.y > maxY) maxY = newPoint.y;
 }
 
-// Checks if a given point already exists in the graph.
+// Checks if a point already exists within snap tolerance of the given position.
 bool Graph::containsPoint(const Point& point) const {
-    return std::find_if(points.begin(), points.end(), [&point](const Point& p) {
-        return p.equals(point);
-    }) != points.end();
+    return snapIndex.findPoint(point.x, point.y) >= 0;
 }
 
-// Sets the index of the last point that was added to the graph.
-void Graph::setLastPointIndex(int index) {
-    lastPointIndex = index;
+// Sets the last point that was added to the graph.
+void Graph::setLastPoint(Handle handle) {
+    lastPoint = handle;
 }
 
-// Gets the last point that was added to the graph.
-const Point* Graph::getLastPoint() const {
-    if (lastPointIndex >= 0 && lastPointIndex < points.size()) {
-        return &points[lastPointIndex];
-    }
-    return nullptr;
+// Gets the last point that was added to the graph, or a null handle once it is removed.
+// A handle rather than a position in the live list, which removals reorder.
+Handle Graph::getLastPoint() const {
+    return vertices.contains(lastPoint) ? lastPoint : Handle();
 }
 
 // Finds and returns the nearest point in the graph to a specified point.
-Point* Graph::findNearestPoint(const Point& newPoint) {
-    if (points.empty()) {
-        return nullptr;
+Handle Graph::findNearestPoint(const Point& newPoint) {
+    PROFILE_SCOPE("Graph::findNearestPoint");
+    int id = pointIndex.nearest(newPoint.x, newPoint.y);
+    return id < 0 ? Handle() : vertices.handleOf(id);
+}
+
+// Finds the k points nearest to a specified point, closest first.
+std::vector<Handle> Graph::findNearestPoints(const Point& point, size_t k) {
+    std::vector<Handle> result;
+    for (int id : pointIndex.kNearest(point.x, point.y, k)) {
+        result.push_back(vertices.handleOf(id));
     }
-    Point* nearestPoint = &points[0];
-    float minDistance = std::sqrt(std::pow(newPoint.x - nearestPoint->x, 2) + std::pow(newPoint.y - nearestPoint->y, 2));
-
-    for (auto& point : points) {
-        float distance = std::sqrt(std::pow(newPoint.x - point.x, 2) + std::pow(newPoint.y - point.y, 2));
-        if (distance < minDistance && distance > 0) {
-            minDistance = distance;
-            nearestPoint = &point;
-        }
+    return result;
+}
+
+// Finds all points within a radius of a specified point.
+std::vector<Handle> Graph::findPointsInRadius(const Point& center, float radius) {
+    std::vector<Handle> result;
+    for (int id : pointIndex.queryRadius(center.x, center.y, radius)) {
+        result.push_back(vertices.handleOf(id));
+    }
+    return result;
+}
+
+// Finds all points inside the rectangle spanned by two corners.
+std::vector<Handle> Graph::findPointsInRect(const Point& topLeft, const Point& bottomRight) {
+    std::vector<Handle> result;
+    for (int id : pointIndex.queryRect(std::min(topLeft.x, bottomRight.x), std::min(topLeft.y, bottomRight.y),
+                                       std::max(topLeft.x, bottomRight.x), std::max(topLeft.y, bottomRight.y))) {
+        result.push_back(vertices.handleOf(id));
     }
+    return result;
+}
+
+bool Graph::containsPoint(Handle handle) const {
+    return vertices.contains(handle);
+}
 
-    return nearestPoint;
+Point Graph::getPoint(Handle handle) const {
+    return vertices.point(handle.index);
+}
+
+Segment* Graph::getSegment(Handle handle) {
+    return segments.get(handle);
+}
+
+Handle Graph::getPointHandle(const Point& point) const {
+    return point.id < 0 ? Handle() : vertices.handleOf(point.id);
+}
+
+// Moves a point with a single write to the vertex buffer, then refits the spatial indexes.
+bool Graph::movePoint(Handle handle, float x, float y) {
+    PROFILE_SCOPE("Graph::movePoint");
+    if (!vertices.contains(handle)) {
+        return false;
+    }
+    if (snapIndex.findPoint(x, y, static_cast<int>(handle.index)) >= 0) {
+        LOG_DEBUG("point exists x=%g y=%g", x, y);
+        return false;
+    }
+    recordEdit(GraphEdit::MovePoint, vertices.x(handle.index), vertices.y(handle.index), x, y);
+    snapIndex.movePoint(handle.index, vertices.x(handle.index), vertices.y(handle.index), x, y);
+    vertices.set(handle.index, x, y);
+    pointIndex.move(handle.index, x, y);
+    updateBoundary(Point(x, y));
+    markVertex(handle.index);
+
+    for (int id : topology.incident(handle.index)) {
+        updateSegmentBounds(*segments.getByIndex(id));
+        markSegment(id);
+    }
+    return true;
 }
 
 // Adds a new point to the graph.
-void Graph::addPoint(const Point& point) {
+Handle Graph::addPoint(const Point& point) {
+    PROFILE_SCOPE("Graph::addPoint");
     if (!containsPoint(point)) {
-        Point newPoint(point.x, point.y, points.size() + 1);
-        std::cout << "Point ID: " << newPoint.id << std::endl;
-        points.push_back(newPoint);
+        Handle handle = vertices.add(point.x, point.y);
+        LOG_DEBUG("point added id=%u x=%g y=%g", handle.index, point.x, point.y);
+        recordEdit(GraphEdit::AddPoint, point.x, point.y);
+        lastPoint = handle;
+        pointIndex.insert(handle.index, point.x, point.y);
+        snapIndex.insertPoint(handle.index, point.x, point.y);
+        markVertex(handle.index);
+        return handle;
     } else {
-        std::cerr << "Point already exists: " << point.x << ", " << point.y << std::endl;
+        LOG_DEBUG("point exists x=%g y=%g", point.x, point.y);
+        return Handle();
     }
 }
 
+// Returns the existing point within snap tolerance, or adds a new one.
+Handle Graph::snapPoint(const Point& point) {
+    int existing = snapIndex.findPoint(point.x, point.y);
+    if (existing >= 0) {
+        return vertices.handleOf(existing);
+    }
+    Handle handle = vertices.add(point.x, point.y);
+    recordEdit(GraphEdit::AddPoint, point.x, point.y);
+    lastPoint = handle;
+    pointIndex.insert(handle.index, point.x, point.y);
+    snapIndex.insertPoint(handle.index, point.x, point.y);
+    updateBoundary(point);
+    markVertex(handle.index);
+    return handle;
+}
+
+void Graph::setSnapTolerance(float tolerance) {
+    snapIndex.setTolerance(tolerance);
+}
+
+float Graph::getSnapTolerance() const {
+    return snapIndex.getTolerance();
+}
+
 // Tries to add a new point to the graph. Returns true if the point was added.
 bool Graph::tryAddPoint(const Point& point) {
     if (!containsPoint(point)) {
-        std::cout << "Point Added (" << point.x << "," << point.y << ")" << std::endl;
         addPoint(point);
         return true;
     }
@@ -92,186 +348,213 @@ bool Graph::tryAddPoint(const Point& point) {
 
 // Removes a specified point and any segments connected to it from the graph.
 void Graph::removePoint(const Point& point) {
-    auto it = std::remove_if(segments.begin(), segments.end(), [&point](const Segment& seg) {
-        return seg.includes(point);
-    });
-    if(segments.size() > 0){
-    segments.erase(it, segments.end());
-    roadEnvelopes.pop_back();
+    Handle handle = getPointHandle(point);
+    if (handle.isNull() || !getPoint(handle).equals(point)) {
+        // Not one of our points by id, so look it up by position instead.
+        int match = snapIndex.findPoint(point.x, point.y);
+        handle = match < 0 ? Handle() : vertices.handleOf(match);
     }
-    points.erase(std::remove_if(points.begin(), points.end(), [&point](const Point& p) {
-        return p.equals(point);
-    }), points.end());
+    removePoint(handle);
 }
 
-// Adds a new segment to the graph.
-void Graph::addSegment(const Segment& seg) {
-    Segment newSegment(seg.p1, seg.p2, std::to_string(segments.size() + 1));
-
-    std::cout << "Segment added ID: " << newSegment.id << std::endl;
-    segments.push_back(newSegment);
+void Graph::removePoint(Handle handle) {
+    PROFILE_SCOPE("Graph::removePoint");
+    if (!vertices.contains(handle)) {
+        return;
+    }
+    // The segments go with the point, so replaying the one edit removes them too
+    recordEdit(GraphEdit::RemovePoint, vertices.x(handle.index), vertices.y(handle.index));
+    for (int segmentId : std::vector<int>(topology.incident(handle.index))) {
+        removeSegmentAt(segments.handleOf(segmentId));
+    }
+    pointIndex.remove(handle.index);
+    snapIndex.removePoint(handle.index, vertices.x(handle.index), vertices.y(handle.index));
+    vertices.remove(handle);
+    markVertex(handle.index);
+}
 
-    roadEnvelopes.push_back(createRoadEnvelope(newSegment, 25.0));
+// Adds a new segment to the graph.
+Handle Graph::addSegment(const Segment& seg) {
+    PROFILE_SCOPE("Graph::addSegment");
+    if (seg.a == seg.b || containsSegment(seg)) {
+        return Handle();
+    }
+    Handle handle = segments.insert(Segment(seg.a, seg.b));
+    Segment& newSegment = *segments.get(handle);
+    newSegment.id = handle.index;
+
+    LOG_DEBUG("segment added id=%d a=%u b=%u", newSegment.id, newSegment.a, newSegment.b);
+    recordEdit(GraphEdit::AddSegment, vertices.x(newSegment.a), vertices.y(newSegment.a),
+               vertices.x(newSegment.b), vertices.y(newSegment.b));
+    segmentIndex.insert(newSegment.id, segmentBounds(newSegment, vertices));
+    topology.addSegment(newSegment.id, newSegment.a, newSegment.b);
+    snapIndex.insertSegment(newSegment.a, newSegment.b, newSegment.id);
+    markSegment(newSegment.id);
+
+    attachEnvelope(newSegment);
+    return handle;
 }
 
 // Tries to add a new segment to the graph. Returns true if the segment was added.
 bool Graph::tryAddSegment(const Segment& seg) {
-    if (!containsSegment(seg) && !seg.p1.equals(seg.p2)) {
-        addSegment(seg);
-        return true;
+    if (vertices.isLive(seg.a) && vertices.isLive(seg.b)) {
+        return !addSegment(seg).isNull();
     }
     return false;
 }
 
 // Removes a specified segment from the graph.
 void Graph::removeSegment(const Segment& seg) {
-    segments.erase(std::remove_if(segments.begin(), segments.end(), [&seg](const Segment& s) {
-        return s.equals(seg);
-    }), segments.end());
-    for (size_t i = 0; i < segments.size(); ++i) {
-        if (segments[i].equals(seg)) {
-            segments.erase(segments.begin() + i);
-            roadEnvelopes.erase(roadEnvelopes.begin() + i);
-            break;  // Assuming each segment is unique
-        }
-    }
+    removeSegmentById(snapIndex.findSegment(seg.a, seg.b));
 }
 
-void Graph::removeSegmentById(const std::string& segmentId) {
-    auto it = std::remove_if(segments.begin(), segments.end(),
-                            [&segmentId](const Segment& seg) { return seg.id == segmentId; });
-    if (it != segments.end()) {
-        segments.erase(it, segments.end());
+void Graph::removeSegmentById(int segmentId) {
+    Handle handle = segmentId < 0 ? Handle() : segments.handleOf(segmentId);
+    if (const Segment* seg = segments.get(handle)) {
+        recordEdit(GraphEdit::RemoveSegment, vertices.x(seg->a), vertices.y(seg->a), vertices.x(seg->b), vertices.y(seg->b));
     }
-     auto envelopeIt = std::remove_if(roadEnvelopes.begin(), roadEnvelopes.end(),
-                                         [&segmentId](const Envelope& env) { return env.getSkeleton().id == segmentId; });
-        if (envelopeIt != roadEnvelopes.end()) {
-            roadEnvelopes.erase(envelopeIt, roadEnvelopes.end());
-        }
-
-    std::cout << "Segments Array Size: " << segments.size() << std::endl;
+    removeSegmentAt(handle);
+    LOG_DEBUG("segment removed id=%d segments=%zu", segmentId, segments.size());
 }
 
-std::vector<int> Graph::getConnectedSegmentIds(const Point& point) {
-    std::vector<int> connectedIds;
-    for (const auto& segment : segments) {
-        if (segment.p1.id == point.id || segment.p2.id == point.id) {
-            connectedIds.push_back(stoi(segment.id));
-        }
+// Removes a segment from the storage, indexes and incidence lists, along with its envelope.
+void Graph::removeSegmentAt(Handle handle) {
+    PROFILE_SCOPE("Graph::removeSegmentAt");
+    const Segment* seg = segments.get(handle);
+    if (!seg) {
+        return;
     }
-    //std::cout << "Connected Segments: " << connectedIds.size() << std::endl;
-    return connectedIds;
+    int id = handle.index;
+    topology.removeSegment(id, seg->a, seg->b);
+    snapIndex.removeSegment(seg->a, seg->b);
+    segmentIndex.remove(id);
+    roadEnvelopes.remove(segmentEnvelopes[id]);
+    segmentEnvelopes[id] = Handle();
+    segments.remove(handle);
+    markSegment(id);
+}
+
+// Gets the ids of the segments touching a point, in O(degree).
+std::vector<int> Graph::getConnectedSegmentIds(Handle point) {
+    return vertices.contains(point) ? topology.incident(point.index) : std::vector<int>();
 }
 
-std::vector<Segment>& Graph::getConnectedSegments(const Point& point) {
+// Gets copies of the segments touching a point, in O(degree).
+std::vector<Segment> Graph::getConnectedSegments(Handle point) {
     std::vector<Segment> connectedSegments;
-    for (const auto& segment : segments) {
-        if (segment.p1.id == point.id || segment.p2.id == point.id) {
-            connectedSegments.push_back(segment);
-        }
+    for (int id : getConnectedSegmentIds(point)) {
+        connectedSegments.push_back(*segments.getByIndex(id));
     }
-    //std::cout << "Connected Segments: " << connectedSegments.size() << std::endl;
     return connectedSegments;
 }
 
-Envelope* Graph::findEnvelope(const Segment& segment) {
-    for (Envelope& envelope : roadEnvelopes) {
-        if (envelope.getSkeleton().id == segment.id) {
-            return &envelope;
-        }
-    }
-    return nullptr; // If no matching envelope is found
+// Builds a compressed copy of the point to segment incidence lists.
+TopologySnapshot Graph::buildTopologySnapshot() const {
+    return topology.snapshot();
 }
 
-void Graph::updateEnvelope(Segment& segment) {
-    for (auto& envelope : roadEnvelopes) {
-        // Match the envelope with the segment using ID or pointers
-        if (envelope.getSkeleton().id == segment.id) {
-            // Update the skeleton of the envelope
-            envelope.updateSkeleton(segment);
-            break;
-        }
+// Creates the envelope of a newly stored segment and files it under the segment id.
+void Graph::attachEnvelope(const Segment& segment) {
+    PROFILE_SCOPE("Graph::attachEnvelope");
+    if (segmentEnvelopes.size() <= static_cast<size_t>(segment.id)) {
+        segmentEnvelopes.resize(segments.capacity());
     }
+    segmentEnvelopes[segment.id] = roadEnvelopes.insert(createRoadEnvelope(segment, ROAD_WIDTH));
 }
 
-Envelope Graph::createRoadEnvelope(const Segment& segment, double width) {
-    auto roadTexture = resourceManager.getTexture("roadTexture");
-
-    // Create the Envelope with the segment and width
-    Envelope envelope(segment, width);
+Envelope* Graph::findEnvelope(const Segment& segment) {
+    if (segment.id < 0 || static_cast<size_t>(segment.id) >= segmentEnvelopes.size()) {
+        return nullptr;
+    }
+    return roadEnvelopes.get(segmentEnvelopes[segment.id]);
+}
 
-    // Set the texture for the envelope
-    envelope.setTexture(roadTexture);
+Envelope* Graph::findEnvelope(Handle segment) {
+    const Segment* stored = segments.get(segment);
+    return stored ? findEnvelope(*stored) : nullptr;
+}
 
-    return envelope;
+Envelope Graph::createRoadEnvelope(const Segment& segment, double width) {
+    return Envelope(segment, width);
 }
 
+// Finds all crossings between segments with a sweep line.
 std::vector<Point> Graph::findIntersections() {
     std::vector<Point> intersections;
-    for (size_t i = 0; i < segments.size(); ++i) {
-        for (size_t j = i + 1; j < segments.size(); ++j) {
-            Point intersection = getIntersection(segments[i].p1, segments[i].p2, segments[j].p1, segments[j].p2);
-            if (intersection.x != -1 && intersection.y != -1) {
-                intersections.push_back(intersection);
-            }
-        }
+    for (const auto& crossing : findSegmentCrossings(segments.dense(), vertices)) {
+        intersections.push_back(crossing.point);
     }
     return intersections;
 }
-float Graph::calculateDistanceFromPointToSegment(const Point& point, const Segment& segment) {
-    float x = point.x;
-    float y = point.y;
-    float x1 = segment.p1.x;
-    float y1 = segment.p1.y;
-    float x2 = segment.p2.x;
-    float y2 = segment.p2.y;
 
-    // Calculate the differences
-    float dx = x2 - x1;
-    float dy = y2 - y1;
-
-    // Calculate the t that minimizes the distance.
-    float t = ((x - x1) * dx + (y - y1) * dy) / (dx * dx + dy * dy);
-
-    // See if this represents one of the segment's end points or a point in the middle.
-    t = std::max(0.0f, std::min(1.0f, t));
-
-    float nearestX = x1 + t * dx;
-    float nearestY = y1 + t * dy;
+// Finds the crossings of one segment, testing only segments whose bounds overlap it.
+std::vector<Point> Graph::findIntersections(const Segment& segment) {
+    PROFILE_SCOPE("Graph::findIntersections");
+    std::vector<Point> intersections;
+    AABB bounds = segmentBounds(segment, vertices, 0.0f);
+    segmentIndex.query(bounds, [&](int id) {
+        const Segment& other = *segments.getByIndex(id);
+        Point intersection;
+        if (other.id != segment.id && segmentsCross(segment, other, vertices, intersection)) {
+            intersections.push_back(intersection);
+        }
+        return true;
+    });
+    return intersections;
+}
 
-    // Calculate the distance to the nearest point
-    return std::sqrt((x - nearestX) * (x - nearestX) + (y - nearestY) * (y - nearestY));
+float Graph::calculateDistanceFromPointToSegment(const Point& point, const Segment& segment) const {
+    return distanceToSegment(point, vertices.point(segment.a), vertices.point(segment.b));
 }
 
 Segment* Graph::findNearestSegment(const Point& point) {
-    Segment* nearestSegment = nullptr;
-    float minDistance = std::numeric_limits<float>::max();
+    PROFILE_SCOPE("Graph::findNearestSegment");
+    int id = segmentIndex.nearest(point.x, point.y, [&](int candidate) {
+        return calculateDistanceFromPointToSegment(point, *segments.getByIndex(candidate));
+    });
+    return id < 0 ? nullptr : segments.getByIndex(id);
+}
 
-    for (auto& segment : segments) {
+// Finds the segment whose road envelope contains the point.
+Segment* Graph::findSegmentAt(const Point& point) {
+    Segment* hit = nullptr;
+    float hitDistance = ROAD_WIDTH / 2.0f;
+    segmentIndex.queryPoint(point.x, point.y, [&](int id) {
+        Segment& segment = *segments.getByIndex(id);
         float distance = calculateDistanceFromPointToSegment(point, segment);
-        if (distance < minDistance) {
-            minDistance = distance;
-            nearestSegment = &segment;
+        if (distance <= hitDistance) {
+            hitDistance = distance;
+            hit = &segment;
         }
-    }
-    return nearestSegment;
+        return true;
+    });
+    return hit;
 }
 
-// Checks if a given segment already exists in the graph.
-bool Graph::containsSegment(const Segment& seg) const {
-    return std::find_if(segments.begin(), segments.end(), [&seg](const Segment& s) {
-        return s.equals(seg);
-    }) != segments.end();
+// Finds all segments whose road envelope bounds overlap the rectangle spanned by two corners.
+std::vector<Segment*> Graph::findSegmentsInRect(const Point& topLeft, const Point& bottomRight) {
+    AABB area = {std::min(topLeft.x, bottomRight.x), std::min(topLeft.y, bottomRight.y),
+                 std::max(topLeft.x, bottomRight.x), std::max(topLeft.y, bottomRight.y)};
+    std::vector<Segment*> result;
+    segmentIndex.query(area, [&](int id) {
+        Segment& segment = *segments.getByIndex(id);
+        if (segmentBounds(segment, vertices).overlaps(area)) {
+            result.push_back(&segment);
+        }
+        return true;
+    });
+    return result;
 }
 
-// Draws all points and segments of the graph on an SFML render window.
-void Graph::draw(sf::RenderWindow& window) {
+Segment* Graph::findSegmentById(int id) {
+    return id < 0 ? nullptr : segments.getByIndex(id);
+}
 
-    for (const auto& seg : segments) {
-        seg.draw(window);
-    }
+void Graph::updateSegmentBounds(const Segment& segment) {
+    segmentIndex.update(segment.id, segmentBounds(segment, vertices));
+}
 
-    for (const auto& point : points) {
-        point.draw(window);
-    }
+// Checks if a segment joining the same end points, in either order, is already in the graph.
+bool Graph::containsSegment(const Segment& seg) const {
+    return snapIndex.findSegment(seg.a, seg.b) >= 0;
 }
@@ -1,28 +1,32 @@
 #include "GraphEditor.h"
 #include <cmath>
-#include <iostream>
 #include "utils.h"
 #include "Viewport.h"
 #include "Constants.h"
 #include "Envelope.h"
+#include "Drawing.h"
+#include "Log.h"
+#include "Profiler.h"
 
 // Constructor: Initializes the graph editor with a reference to the SFML window and the graph.
 GraphEditor::GraphEditor(sf::RenderWindow& window, Graph& graph, Viewport& viewport)
-    : window(window), graph(graph), viewport(viewport), selected(nullptr), hovered(nullptr), dragging(false) {}
+    : viewport(viewport), window(window), graph(graph), dragging(false) {}
 
 
 // Draws a temporary dashed segment from the selected point to the mouse cursor or nearest point.
 void GraphEditor::drawTemporarySegment() {
-    if (selected) {
+    if (graph.containsPoint(selected)) {
+        Point selectedPoint = graph.getPoint(selected);
         Point mousePoint = getMousePoint();
 
-        Point* nearest = graph.findNearestPoint(mousePoint);
-        sf::Vector2f start(selected->x, selected->y);
+        Handle nearest = graph.findNearestPoint(mousePoint);
+        sf::Vector2f start(selectedPoint.x, selectedPoint.y);
 
         float hoverDistanceThreshold = 25.0f;
-        bool isHoveringNearestPoint = nearest && distance(*nearest, mousePoint) < hoverDistanceThreshold;
+        bool isHoveringNearestPoint = !nearest.isNull() && distance(graph.getPoint(nearest), mousePoint) < hoverDistanceThreshold;
 
-        sf::Vector2f end = isHoveringNearestPoint ? sf::Vector2f(nearest->x, nearest->y) : sf::Vector2f(mousePoint.x, mousePoint.y);
+        Point nearestPoint = isHoveringNearestPoint ? graph.getPoint(nearest) : mousePoint;
+        sf::Vector2f end(nearestPoint.x, nearestPoint.y);
         drawDashedLine(start, end, sf::Color::Red, 2.5f);
     }
 }
@@ -39,7 +43,17 @@ void GraphEditor::drawDashedLine(const sf::Vector2f& start, const sf::Vector2f&
     direction /= lineLength; // Normalize
     sf::Vector2f perpendicular(-direction.y, direction.x); // Perpendicular vector for thickness
 
+    // Dashes off screen are skipped, a long preview line may only cross a corner of the view
+    sf::FloatRect visibleArea = viewport.getVisibleArea();
+    visibleArea.left -= dashLength + thickness;
+    visibleArea.top -= dashLength + thickness;
+    visibleArea.width += 2 * (dashLength + thickness);
+    visibleArea.height += 2 * (dashLength + thickness);
+
     for (float i = 0.0f; i < lineLength; i += dashLength + gapLength) {
+        if (!visibleArea.contains(start + direction * i)) {
+            continue;
+        }
 
         float currentDashLength = std::min(dashLength, lineLength - i);
         sf::RectangleShape dash(sf::Vector2f(currentDashLength, thickness));
@@ -68,9 +82,10 @@ void GraphEditor::drawTemporaryPoint() {
 
 void GraphEditor::handleShiftClick() {
     Point mousePoint = getMousePoint(); // Convert the mouse coordinates to the graph's coordinate system
-    Segment* nearestSegment = graph.findNearestSegment(mousePoint);
+    const Segment* nearestSegment = graph.findNearestSegment(mousePoint);
 
     if (nearestSegment) {
+        LOG_DEBUG("removing nearest segment id=%d", nearestSegment->id);
         graph.removeSegmentById(nearestSegment->id);
     }
 }
@@ -84,19 +99,13 @@ void GraphEditor::handleRightMouseDown(const sf::Event& event) {
                        sf::Keyboard::isKeyPressed(sf::Keyboard::RShift);
 
     if(shftPressed) {
-        Point mousePoint = getMousePoint();
-        Segment* tempSeg = graph.findNearestSegment(mousePoint);
-        std::cout << "Nearest Segment ID: (" << tempSeg->id << ")\n";
         handleShiftClick();
     }
 
-    if(selected != nullptr){
-        selected = nullptr;
-    }
+    selected = Handle();
 
-    if (ctrlPressed && hovered) {
-        if(hovered!= nullptr)
-            removePoint(hovered);
+    if (ctrlPressed && !hovered.isNull()) {
+        removePoint(hovered);
     }
 }
 
@@ -104,32 +113,32 @@ void GraphEditor::handleRightMouseDown(const sf::Event& event) {
 void GraphEditor::handleLeftMouseDown(const sf::Event& event) {
 
     Point mousePoint = getMousePoint();
-    Point* nearest = graph.findNearestPoint(mousePoint);
+    Handle nearest = graph.findNearestPoint(mousePoint);
 
     float hoverDistanceThreshold = 25.0f;
-    bool isHoveringNearestPoint = nearest && distance(*nearest, mousePoint) < hoverDistanceThreshold;
+    bool isHoveringNearestPoint = !nearest.isNull() && distance(graph.getPoint(nearest), mousePoint) < hoverDistanceThreshold;
 
+    const Segment* addedSegment = nullptr;
     if (isHoveringNearestPoint) {
-        if (selected && nearest != selected) {
-            graph.addSegment(Segment(*selected, *nearest));
-            //std::cout << "Segment added between selected and nearest point\n";
+        if (graph.containsPoint(selected) && nearest != selected) {
+            addedSegment = graph.getSegment(graph.addSegment(Segment(selected.index, nearest.index)));
+            LOG_DEBUG("segment added from selected point=%u to nearest point=%u", selected.index, nearest.index);
         }
         selected = nearest;
     } else {
-        graph.addPoint(mousePoint);
-        Point* newPoint = &graph.points.back();
-        if (selected) {
-            graph.addSegment(Segment(*selected, *newPoint));
-           // std::cout << "Segment added between selected and new point\n";
+        Handle newPoint = graph.addPoint(mousePoint);
+        if (graph.containsPoint(selected) && !newPoint.isNull()) {
+            addedSegment = graph.getSegment(graph.addSegment(Segment(selected.index, newPoint.index)));
+            LOG_DEBUG("segment added from selected point=%u to new point=%u", selected.index, newPoint.index);
         }
         selected = newPoint;
     }
 
-    if (selected) {
-        std::vector<Point> intersections = graph.findIntersections();
+    // Only the new segment can introduce crossings, so test it alone.
+    if (addedSegment) {
+        std::vector<Point> intersections = graph.findIntersections(*addedSegment);
         for (const auto& intersection : intersections) {
-            std::cout << "Intersection found at: ("
-                      << intersection.x << ", " << intersection.y << ")" << std::endl;
+            LOG_INFO("intersection x=%g y=%g segment=%d", intersection.x, intersection.y, addedSegment->id);
         }
     }
     dragging = true;
@@ -138,14 +147,11 @@ void GraphEditor::handleLeftMouseDown(const sf::Event& event) {
 
 // Handles different types of events like mouse movement and button presses.
 void GraphEditor::handleEvent(const sf::Event& event) {
+    PROFILE_SCOPE("GraphEditor::handleEvent");
     if (event.type == sf::Event::MouseMoved) {
         handleMouseMove(event);
     } else if (event.type == sf::Event::MouseButtonPressed) {
         if (event.mouseButton.button == sf::Mouse::Right) {
-                if(selected != nullptr)
-                    graph.getConnectedSegments(*selected);
-
-
             handleRightMouseDown(event);
         } else if (event.mouseButton.button == sf::Mouse::Left){
             handleLeftMouseDown(event);
@@ -162,37 +168,10 @@ void GraphEditor::handleMouseMove(const sf::Event& event) {
     sf::Vector2f worldMousePos = viewport.toWorldCoordinates(mouse);
 
     // If a point is selected and we are dragging it
-    if (dragging && selected) {
-        // Update the position of the selected point to where the mouse is
-        selected->x = worldMousePos.x;
-        selected->y = worldMousePos.y;
-
-        // Update the segments connected to this point
-        std::vector<int> connectedSegmentIds = graph.getConnectedSegmentIds(*selected);
-
-        for (int id : connectedSegmentIds) {
-            // Assuming that segment IDs are stored as integers and are unique
-            for (Segment& segment : graph.segments) {
-                if (std::stoi(segment.id) == id) {
-                    // Check which end of the segment the selected point corresponds to
-                    if (segment.p1.id == selected->id) {
-                        segment.p1.x = selected->x;
-                        segment.p1.y = selected->y;
-                    } else if (segment.p2.id == selected->id) {
-                        segment.p2.x = selected->x;
-                        segment.p2.y = selected->y;
-                    }
-                }
-            }
-        }
-
-        // After updating the segments, you should redraw the graph to reflect the changes
-        // Depending on how your rendering is set up, you might need to invalidate the current frame
-        // and trigger a redraw. This often involves calling a method to clear the screen and then
-        // redraw all elements. This might look something like this:
-        updateConnectedSegmentsAndEnvelopes(*selected);
-        window.clear(); // Clear the window or the drawing surface
-        graph.draw(window); // Redraw the entire graph
+    if (dragging && graph.containsPoint(selected)) {
+        // Move the selected point; its segments and envelopes see the new position through the vertex buffer.
+        // Over another point the move is refused and the point waits where it was.
+        graph.movePoint(selected, worldMousePos.x, worldMousePos.y);
     }
 
     // Update the hovered point to be the nearest point to the mouse cursor
@@ -201,75 +180,55 @@ void GraphEditor::handleMouseMove(const sf::Event& event) {
 }
 
 
-// Call this method whenever you move a point to update the connected segments and envelopes
-void GraphEditor::updateConnectedSegmentsAndEnvelopes(const Point& selectedPoint) {
-    std::vector<int> connectedSegmentIds = graph.getConnectedSegmentIds(selectedPoint);
-    for (int id : connectedSegmentIds) {
-        for (Segment& segment : graph.segments) {
-            if (segment.id == std::to_string(id)) {
-                // Update the segment points...
-                // ...
-                // Find the corresponding Envelope and update it
-                Envelope* env = graph.findEnvelope(segment);
-                if (env != nullptr) {
-                    env->updateSkeleton(segment);
-                    // Assuming you have a method to update the visual representation of the envelope:
-                    env->updateRoundedRect();
-                }
-            }
-        }
-    }
-}
 // Selects a given point.
-void GraphEditor::selectPoint(Point* point) {
-    if (selected && point != selected) {
-        graph.addSegment(Segment(*selected, *point));
+void GraphEditor::selectPoint(Handle point) {
+    if (graph.containsPoint(selected) && graph.containsPoint(point) && point != selected) {
+        graph.addSegment(Segment(selected.index, point.index));
     }
     selected = point;
 }
 
 // Removes a given point from the graph.
-void GraphEditor::removePoint(Point* point) {
-    if(graph.points.size() > 0){
-        if (point != nullptr) {
-            //std::cout << "Removing point: " << (point ? point->id : -1) << std::endl;
-            graph.removePoint(*point);
-
-            if (selected == point) {
-                selected = nullptr;
-            }
-            if (hovered == point) {
-                hovered = nullptr;
-            }
-        }
+void GraphEditor::removePoint(Handle point) {
+    LOG_DEBUG("removing point=%u", point.index);
+    graph.removePoint(point);
+
+    if (selected == point) {
+        selected = Handle();
+    }
+    if (hovered == point) {
+        hovered = Handle();
     }
 }
 
+void GraphEditor::clearSelection() {
+    selected = Handle();
+    hovered = Handle();
+    dragging = false;
+}
+
 Point GraphEditor::getMousePoint(){
     sf::Vector2f worldMousePos = viewport.toWorldCoordinates(mouse);
-    Point mousePoint(worldMousePos.x, worldMousePos.y, (graph.points.size() + 1));
-    //std::cout << "getMousePoint ID: " << mousePoint.id << std::endl;
+    // The mouse is not a point of the graph, so it gets no vertex id
+    Point mousePoint(worldMousePos.x, worldMousePos.y, -1);
     return mousePoint;
 }
 
 // Draws the graph, hovered points, and selected points.
 void GraphEditor::draw() {
+    PROFILE_SCOPE("GraphEditor::draw");
 
-    graph.draw(window);
-
-    for (const auto& envelope : graph.roadEnvelopes) {
-        envelope.draw(window);
-    }
+    renderer.drawCached(window, graph, viewport.getVisibleArea(), viewport.getZoom());
 
     Point mousePoint = getMousePoint();
-    Point* nearest = graph.findNearestPoint(mousePoint);
+    Handle nearest = graph.findNearestPoint(mousePoint);
     float hoverDistanceThreshold = 25.0f;
-    bool isHoveringNearestPoint = nearest && distance(*nearest, mousePoint) < hoverDistanceThreshold;
+    bool isHoveringNearestPoint = !nearest.isNull() && distance(graph.getPoint(nearest), mousePoint) < hoverDistanceThreshold;
 
-    if (hovered && isHoveringNearestPoint) {
-        hovered->draw(window, 13, sf::Color::Red);
+    if (graph.containsPoint(hovered) && isHoveringNearestPoint) {
+        drawPoint(window, graph.getPoint(hovered), 13, sf::Color::Red);
     }
-    if (selected) {
-        selected->draw(window, 13, sf::Color::Blue);
+    if (graph.containsPoint(selected)) {
+        drawPoint(window, graph.getPoint(selected), 13, sf::Color::Blue);
     }
 }
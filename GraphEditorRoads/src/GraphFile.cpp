@@ -0,0 +1,629 @@
+#include "GraphFile.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <cmath>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Constants.h"
+#include "Graph.h"
+#include "Profiler.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char Magic[8] = {'G', 'R', 'A', 'P', 'H', 'B', 'I', 'N'};
+const std::uint32_t ByteOrderMark = 0x01020304u;
+const std::uint64_t SectionAlignment = 64;
+
+enum SectionType : std::uint32_t {
+    VertexX = 1,
+    VertexY = 2,
+    Segments = 3,
+    SegmentTree = 4,
+};
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint64_t vertexCount;
+    std::uint64_t segmentCount;
+    float minX, minY, maxX, maxY;
+    std::uint32_t sectionCount;
+    std::uint32_t reserved;
+    // Zero in files written before journals, which read it as reserved space
+    std::uint64_t journalStamp;
+};
+
+struct SectionEntry {
+    std::uint32_t type;
+    std::uint32_t reserved;
+    std::uint64_t offset;
+    std::uint64_t bytes;
+};
+
+// Leads the SegmentTree section, followed by the nodes
+struct TreeHeader {
+    std::int32_t root;
+    float margin;
+    std::uint64_t nodeCount;
+};
+
+static_assert(sizeof(FileHeader) == 64, "graph file header layout changed");
+static_assert(sizeof(SectionEntry) == 24, "graph file section layout changed");
+static_assert(sizeof(TreeHeader) == 16, "graph file tree header layout changed");
+static_assert(sizeof(AABBTree::Node) == 36 && std::is_trivially_copyable<AABBTree::Node>::value,
+              "AABBTree::Node is stored in graph files as it is in memory");
+
+std::uint64_t alignUp(std::uint64_t offset) {
+    return (offset + SectionAlignment - 1) / SectionAlignment * SectionAlignment;
+}
+
+// Writes sections in the order they were planned, padding each to its offset. Large
+// arrays are converted a chunk at a time, so nothing the size of the graph is copied.
+class FileWriter {
+public:
+    explicit FileWriter(std::FILE* file) : file(file), position(0) {}
+
+    void write(const void* bytes, std::size_t count) {
+        if (count > 0 && std::fwrite(bytes, 1, count, file) != count) {
+            failed = true;
+        }
+        position += count;
+    }
+
+    void padTo(std::uint64_t offset) {
+        static const char zeros[SectionAlignment] = {};
+        while (position < offset) {
+            write(zeros, static_cast<std::size_t>(std::min<std::uint64_t>(offset - position, SectionAlignment)));
+        }
+    }
+
+    // fill(first, count, out) writes elements first to first + count - 1 into out.
+    template <typename T, typename Fill>
+    void writeChunked(std::size_t count, Fill fill) {
+        std::vector<T> chunk(std::min<std::size_t>(count, 1 << 14));
+        for (std::size_t first = 0; first < count; first += chunk.size()) {
+            std::size_t size = std::min(chunk.size(), count - first);
+            fill(first, size, chunk.data());
+            write(chunk.data(), size * sizeof(T));
+        }
+    }
+
+    bool ok() const { return !failed && !std::ferror(file); }
+
+private:
+    std::FILE* file;
+    std::uint64_t position;
+    bool failed = false;
+};
+
+// Plans the sections of a file and writes the header and section table.
+struct FileLayout {
+    FileHeader header;
+    std::vector<SectionEntry> sections;
+
+    FileLayout(std::size_t vertexCount, std::size_t segmentCount, float minX, float minY, float maxX, float maxY) {
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+        header.version = GraphFile::Version;
+        header.byteOrder = ByteOrderMark;
+        header.vertexCount = vertexCount;
+        header.segmentCount = segmentCount;
+        header.minX = minX;
+        header.minY = minY;
+        header.maxX = maxX;
+        header.maxY = maxY;
+    }
+
+    void add(std::uint32_t type, std::uint64_t bytes) {
+        sections.push_back({type, 0, 0, bytes});
+    }
+
+    void writeHeader(FileWriter& writer) {
+        header.sectionCount = static_cast<std::uint32_t>(sections.size());
+        std::uint64_t offset = sizeof(FileHeader) + sections.size() * sizeof(SectionEntry);
+        for (SectionEntry& section : sections) {
+            section.offset = alignUp(offset);
+            offset = section.offset + section.bytes;
+        }
+        writer.write(&header, sizeof(header));
+        writer.write(sections.data(), sections.size() * sizeof(SectionEntry));
+    }
+};
+
+// Checks that segments keep the graph's rules: none joins a point to itself, and no two
+// join the same points. ends(i) gives the end points of segment i. Returns what is wrong,
+// or nullptr.
+template <typename Ends>
+const char* findSegmentProblem(std::size_t count, Ends ends) {
+    std::vector<std::uint64_t> pairs(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::pair<std::uint32_t, std::uint32_t> end = ends(i);
+        if (end.first == end.second) {
+            return "segment joins a point to itself";
+        }
+        pairs[i] = static_cast<std::uint64_t>(std::min(end.first, end.second)) << 32 | std::max(end.first, end.second);
+    }
+    std::sort(pairs.begin(), pairs.end());
+    return std::adjacent_find(pairs.begin(), pairs.end()) != pairs.end() ? "duplicate segment" : nullptr;
+}
+
+// Checks that no two points lie within snap tolerance of each other, which the journal
+// relies on to name points by position. Points are chained per grid cell of the tolerance,
+// so each is compared only with those in the 3x3 cells around it. Returns what is wrong,
+// or nullptr.
+const char* findPointProblem(std::size_t count, const float* xs, const float* ys) {
+    const std::uint32_t None = 0xFFFFFFFFu;
+    auto cellKey = [](std::int64_t x, std::int64_t y) {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) | static_cast<std::uint32_t>(y);
+    };
+    float limit = SNAP_TOLERANCE * SNAP_TOLERANCE;
+    std::unordered_map<std::uint64_t, std::uint32_t> cellHeads;
+    cellHeads.reserve(count);
+    std::vector<std::uint32_t> next(count, None);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        std::int64_t cellX = static_cast<std::int64_t>(std::floor(xs[i] / SNAP_TOLERANCE));
+        std::int64_t cellY = static_cast<std::int64_t>(std::floor(ys[i] / SNAP_TOLERANCE));
+        for (std::int64_t dy = -1; dy <= 1; ++dy) {
+            for (std::int64_t dx = -1; dx <= 1; ++dx) {
+                auto head = cellHeads.find(cellKey(cellX + dx, cellY + dy));
+                for (std::uint32_t j = head == cellHeads.end() ? None : head->second; j != None; j = next[j]) {
+                    float ox = xs[j] - xs[i], oy = ys[j] - ys[i];
+                    if (ox * ox + oy * oy <= limit) {
+                        return "two points within snap tolerance";
+                    }
+                }
+            }
+        }
+        auto head = cellHeads.emplace(cellKey(cellX, cellY), None).first;
+        next[i] = head->second;
+        head->second = i;
+    }
+    return nullptr;
+}
+
+// Writes to a temporary file next to the target and moves it into place once it is
+// complete and on disk, so neither a failed save nor a power cut destroys the previous one.
+template <typename WriteSections>
+bool writeFile(const std::string& filename, WriteSections writeSections) {
+    std::string temporary = filename + ".tmp";
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Cannot write " << filename << std::endl;
+        return false;
+    }
+    std::setvbuf(file, nullptr, _IOFBF, 1 << 20);
+    FileWriter writer(file);
+    writeSections(writer);
+    // Otherwise the rename can reach the disk before the data it names
+    bool written = writer.ok() && syncFile(file);
+    written = std::fclose(file) == 0 && written;
+#ifdef _WIN32
+    // rename does not replace an existing file on Windows
+    bool moved = written && MoveFileExA(temporary.c_str(), filename.c_str(),
+                                        MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+    bool moved = written && std::rename(temporary.c_str(), filename.c_str()) == 0;
+#endif
+    if (!moved) {
+        std::cerr << "Failed writing " << filename << std::endl;
+        std::remove(temporary.c_str());
+        return false;
+    }
+    if (!syncDirectory(filename)) {
+        std::cerr << "Failed syncing the directory of " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool syncFile(std::FILE* file) {
+    if (std::fflush(file) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+bool syncDirectory(const std::string& filename) {
+#ifdef _WIN32
+    (void)filename;
+    return true;
+#else
+    std::string::size_type slash = filename.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : slash == 0 ? "/" : filename.substr(0, slash);
+    int descriptor = ::open(directory.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        return false;
+    }
+    bool synced = fsync(descriptor) == 0;
+    ::close(descriptor);
+    return synced;
+#endif
+}
+
+GraphFile::~GraphFile() {
+    close();
+}
+
+bool GraphFile::open(const std::string& filename) {
+    PROFILE_SCOPE("GraphFile::open");
+    close();
+#ifdef _WIN32
+    file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                       FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER fileSize;
+    if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &fileSize)) {
+        file = nullptr;
+        std::cerr << "Cannot open " << filename << std::endl;
+        return false;
+    }
+    size = static_cast<std::size_t>(fileSize.QuadPart);
+    if (size > 0) {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        data = mapping ? static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+    }
+#else
+    int descriptor = ::open(filename.c_str(), O_RDONLY);
+    struct stat status;
+    if (descriptor < 0 || fstat(descriptor, &status) != 0) {
+        if (descriptor >= 0) {
+            ::close(descriptor);
+        }
+        std::cerr << "Cannot open " << filename << std::endl;
+        return false;
+    }
+    size = static_cast<std::size_t>(status.st_size);
+    if (size > 0) {
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        data = mapped == MAP_FAILED ? nullptr : static_cast<const unsigned char*>(mapped);
+    }
+    // The mapping keeps the file open
+    ::close(descriptor);
+#endif
+    if (!data) {
+        std::cerr << "Cannot map " << filename << std::endl;
+        close();
+        return false;
+    }
+    if (!readSections(filename)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+// Finds the sections and checks that every index in them is in range, so the arrays can
+// be used without further checks.
+bool GraphFile::readSections(const std::string& filename) {
+    auto invalid = [&filename](const char* reason) {
+        std::cerr << filename << " is not a valid graph file: " << reason << std::endl;
+        return false;
+    };
+
+    FileHeader header;
+    if (size < sizeof(header)) {
+        return invalid("too short");
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0) {
+        return invalid("no GRAPHBIN header");
+    }
+    if (header.byteOrder != ByteOrderMark) {
+        return invalid("written on a machine of the other byte order");
+    }
+    if (header.version != Version) {
+        std::cerr << filename << " has graph file version " << header.version << ", expected " << Version
+                  << std::endl;
+        return false;
+    }
+    if (header.sectionCount > (size - sizeof(header)) / sizeof(SectionEntry)) {
+        return invalid("section table runs past the end");
+    }
+    if (header.vertexCount > 0xFFFFFFFFu || header.segmentCount > 0x7FFFFFFFu) {
+        return invalid("too many vertices or segments");
+    }
+    vertexCount = static_cast<std::size_t>(header.vertexCount);
+    segmentCount = static_cast<std::size_t>(header.segmentCount);
+    bounds = {header.minX, header.minY, header.maxX, header.maxY};
+    journalStamp = header.journalStamp;
+
+    const SectionEntry* sections = reinterpret_cast<const SectionEntry*>(data + sizeof(header));
+    for (std::uint32_t i = 0; i < header.sectionCount; ++i) {
+        const SectionEntry& section = sections[i];
+        if (section.offset % SectionAlignment != 0 || section.offset > size || section.bytes > size - section.offset) {
+            return invalid("section outside the file");
+        }
+        const unsigned char* start = data + section.offset;
+        switch (section.type) {
+            case VertexX:
+            case VertexY:
+                if (section.bytes != vertexCount * sizeof(float)) {
+                    return invalid("vertex section of the wrong size");
+                }
+                (section.type == VertexX ? xs : ys) = reinterpret_cast<const float*>(start);
+                break;
+            case Segments:
+                if (section.bytes != segmentCount * 2 * sizeof(std::uint32_t)) {
+                    return invalid("segment section of the wrong size");
+                }
+                segmentEnds = reinterpret_cast<const std::uint32_t*>(start);
+                break;
+            case SegmentTree: {
+                TreeHeader tree;
+                if (section.bytes < sizeof(tree)) {
+                    return invalid("segment tree section too short");
+                }
+                std::memcpy(&tree, start, sizeof(tree));
+                if (tree.nodeCount != (section.bytes - sizeof(tree)) / sizeof(AABBTree::Node)) {
+                    return invalid("segment tree section of the wrong size");
+                }
+                treeNodes = reinterpret_cast<const AABBTree::Node*>(start + sizeof(tree));
+                treeNodeCount = static_cast<std::size_t>(tree.nodeCount);
+                treeRoot = tree.root;
+                treeMargin = tree.margin;
+                break;
+            }
+            default:
+                // Written by a newer version; safe to ignore
+                break;
+        }
+    }
+    if ((!xs || !ys) && vertexCount > 0) {
+        return invalid("no vertices");
+    }
+    if (!segmentEnds && segmentCount > 0) {
+        return invalid("no segments");
+    }
+
+    for (std::size_t i = 0; i < 2 * segmentCount; ++i) {
+        if (segmentEnds[i] >= vertexCount) {
+            return invalid("segment end out of range");
+        }
+    }
+    // The graph takes the points and segments without its usual checks
+    if (const char* problem = findPointProblem(vertexCount, xs, ys)) {
+        return invalid(problem);
+    }
+    const std::uint32_t* ends = segmentEnds;
+    if (const char* problem = findSegmentProblem(segmentCount, [ends](std::size_t i) {
+            return std::make_pair(ends[2 * i], ends[2 * i + 1]);
+        })) {
+        return invalid(problem);
+    }
+    // A bad tree is only dropped; the graph rebuilds it
+    for (std::size_t i = 0; i < treeNodeCount; ++i) {
+        const AABBTree::Node& node = treeNodes[i];
+        if (node.height >= 0 && node.isLeaf() && (node.id < 0 || static_cast<std::size_t>(node.id) >= segmentCount)) {
+            std::cerr << filename << ": ignoring a damaged segment tree" << std::endl;
+            treeNodes = nullptr;
+            treeNodeCount = 0;
+            treeRoot = AABBTree::Null;
+            break;
+        }
+    }
+    return true;
+}
+
+void GraphFile::unmap() {
+#ifdef _WIN32
+    if (data) {
+        UnmapViewOfFile(data);
+    }
+    if (mapping) {
+        CloseHandle(mapping);
+    }
+    if (file) {
+        CloseHandle(file);
+    }
+    mapping = nullptr;
+    file = nullptr;
+#else
+    if (data) {
+        munmap(const_cast<unsigned char*>(data), size);
+    }
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+void GraphFile::close() {
+    unmap();
+    vertexCount = segmentCount = 0;
+    xs = ys = nullptr;
+    segmentEnds = nullptr;
+    bounds = {0, 0, 0, 0};
+    treeNodes = nullptr;
+    treeNodeCount = 0;
+    treeRoot = AABBTree::Null;
+    treeMargin = 0;
+    journalStamp = 0;
+}
+
+bool saveGraph(const std::string& filename, const Graph& graph, bool withSegmentTree, std::uint64_t journalStamp) {
+    PROFILE_SCOPE("saveGraph");
+    const VertexBuffer& vertices = graph.vertices;
+    const std::vector<Segment>& segments = graph.segments.dense();
+    const std::vector<AABBTree::Node>& nodes = graph.segmentIndex.getNodes();
+    withSegmentTree = withSegmentTree && graph.segmentIndex.size() == segments.size();
+
+    // Vertex slots are written in order with the free ones left out; segments need the
+    // new position of their end points only when there are free slots
+    bool compact = vertices.capacity() == vertices.size();
+    std::vector<std::uint32_t> position;
+    if (!compact) {
+        position.resize(vertices.capacity());
+        std::uint32_t next = 0;
+        for (std::uint32_t slot = 0; slot < vertices.capacity(); ++slot) {
+            position[slot] = vertices.isLive(slot) ? next++ : 0;
+        }
+    }
+    auto renumber = [&compact, &position](std::uint32_t slot) { return compact ? slot : position[slot]; };
+
+    FileLayout layout(vertices.size(), segments.size(), graph.minX, graph.minY, graph.maxX, graph.maxY);
+    layout.header.journalStamp = journalStamp;
+    layout.add(VertexX, vertices.size() * sizeof(float));
+    layout.add(VertexY, vertices.size() * sizeof(float));
+    layout.add(Segments, segments.size() * 2 * sizeof(std::uint32_t));
+    if (withSegmentTree) {
+        layout.add(SegmentTree, sizeof(TreeHeader) + nodes.size() * sizeof(AABBTree::Node));
+    }
+
+    return writeFile(filename, [&](FileWriter& writer) {
+        layout.writeHeader(writer);
+        std::size_t section = 0;
+        for (const float* coordinates : {vertices.xData(), vertices.yData()}) {
+            writer.padTo(layout.sections[section++].offset);
+            if (compact) {
+                writer.write(coordinates, vertices.size() * sizeof(float));
+                continue;
+            }
+            std::uint32_t slot = 0;
+            writer.writeChunked<float>(vertices.size(), [&](std::size_t, std::size_t count, float* out) {
+                for (std::size_t i = 0; i < count; ++slot) {
+                    if (vertices.isLive(slot)) {
+                        out[i++] = coordinates[slot];
+                    }
+                }
+            });
+        }
+
+        writer.padTo(layout.sections[section++].offset);
+        writer.writeChunked<std::uint32_t>(2 * segments.size(), [&](std::size_t first, std::size_t count,
+                                                                    std::uint32_t* out) {
+            for (std::size_t i = 0; i < count; ++i) {
+                const Segment& segment = segments[(first + i) / 2];
+                out[i] = renumber((first + i) % 2 == 0 ? segment.a : segment.b);
+            }
+        });
+
+        if (withSegmentTree) {
+            writer.padTo(layout.sections[section++].offset);
+            TreeHeader tree = {graph.segmentIndex.getRoot(), graph.segmentIndex.getMargin(), nodes.size()};
+            writer.write(&tree, sizeof(tree));
+            // Leaves hold segment slots, which become positions in the segment list
+            writer.writeChunked<AABBTree::Node>(nodes.size(), [&](std::size_t first, std::size_t count,
+                                                                  AABBTree::Node* out) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    out[i] = nodes[first + i];
+                    if (out[i].height >= 0 && out[i].isLeaf()) {
+                        out[i].id = static_cast<int>(graph.segments.getByIndex(out[i].id) - segments.data());
+                    }
+                }
+            });
+        }
+    });
+}
+
+bool saveGraph(const std::string& filename, const EdgeList& graph) {
+    PROFILE_SCOPE("saveGraph");
+    // Edge lists are not checked as they are built, and a file breaking the rules would not open
+    const std::vector<Segment>& segments = graph.segments;
+    if (const char* problem = findSegmentProblem(segments.size(), [&segments](std::size_t i) {
+            return std::make_pair(segments[i].a, segments[i].b);
+        })) {
+        std::cerr << "Cannot save " << filename << ": " << problem << ", dedupe the graph first" << std::endl;
+        return false;
+    }
+    std::vector<float> xs(graph.points.size()), ys(graph.points.size());
+    for (std::size_t i = 0; i < graph.points.size(); ++i) {
+        xs[i] = graph.points[i].x;
+        ys[i] = graph.points[i].y;
+    }
+    if (const char* problem = findPointProblem(xs.size(), xs.data(), ys.data())) {
+        std::cerr << "Cannot save " << filename << ": " << problem << ", dedupe the graph first" << std::endl;
+        return false;
+    }
+    float minX = 0, minY = 0, maxX = 0, maxY = 0;
+    if (!graph.points.empty()) {
+        minX = maxX = graph.points[0].x;
+        minY = maxY = graph.points[0].y;
+    }
+    for (const Point& point : graph.points) {
+        minX = std::min(minX, point.x);
+        maxX = std::max(maxX, point.x);
+        minY = std::min(minY, point.y);
+        maxY = std::max(maxY, point.y);
+    }
+
+    FileLayout layout(graph.points.size(), graph.segments.size(), minX, minY, maxX, maxY);
+    layout.add(VertexX, graph.points.size() * sizeof(float));
+    layout.add(VertexY, graph.points.size() * sizeof(float));
+    layout.add(Segments, graph.segments.size() * 2 * sizeof(std::uint32_t));
+
+    return writeFile(filename, [&](FileWriter& writer) {
+        layout.writeHeader(writer);
+        for (std::size_t section = 0; section < 2; ++section) {
+            writer.padTo(layout.sections[section].offset);
+            writer.writeChunked<float>(graph.points.size(), [&](std::size_t first, std::size_t count, float* out) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    const Point& point = graph.points[first + i];
+                    out[i] = section == 0 ? point.x : point.y;
+                }
+            });
+        }
+        writer.padTo(layout.sections[2].offset);
+        writer.writeChunked<std::uint32_t>(2 * graph.segments.size(), [&](std::size_t first, std::size_t count,
+                                                                          std::uint32_t* out) {
+            for (std::size_t i = 0; i < count; ++i) {
+                const Segment& segment = graph.segments[(first + i) / 2];
+                out[i] = (first + i) % 2 == 0 ? segment.a : segment.b;
+            }
+        });
+    });
+}
+
+bool loadGraph(const std::string& filename, Graph& graph) {
+    PROFILE_SCOPE("loadGraph");
+    GraphFile file;
+    if (!file.open(filename)) {
+        return false;
+    }
+    loadGraph(file, graph);
+    return true;
+}
+
+void loadGraph(const GraphFile& file, Graph& graph) {
+    // A tree padded by another margin would refit differently from the graph's own
+    bool useTree = file.getTreeNodes() && file.getTreeMargin() == graph.segmentIndex.getMargin();
+    graph.assign(file.getXs(), file.getYs(), file.getVertexCount(), file.getSegmentEnds(), file.getSegmentCount(),
+                 useTree ? file.getTreeNodes() : nullptr, useTree ? file.getTreeNodeCount() : 0, file.getTreeRoot());
+}
+
+bool loadGraph(const std::string& filename, EdgeList& graph) {
+    PROFILE_SCOPE("loadGraph");
+    GraphFile file;
+    if (!file.open(filename)) {
+        return false;
+    }
+    graph.points.resize(file.getVertexCount());
+    for (std::size_t i = 0; i < graph.points.size(); ++i) {
+        graph.points[i] = Point(file.getXs()[i], file.getYs()[i]);
+    }
+    graph.segments.resize(file.getSegmentCount());
+    for (std::size_t i = 0; i < graph.segments.size(); ++i) {
+        graph.segments[i] = Segment(file.getSegmentEnds()[2 * i], file.getSegmentEnds()[2 * i + 1]);
+    }
+    return true;
+}
@@ -0,0 +1,72 @@
+#include "GraphIO.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+bool loadObj(const std::string& filename, EdgeList& graph) {
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "Cannot open " << filename << std::endl;
+        return false;
+    }
+    graph.points.clear();
+    graph.segments.clear();
+    std::string line;
+    std::size_t lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        const char* text = line.c_str();
+        char* end = nullptr;
+        if (std::strncmp(text, "v ", 2) == 0) {
+            float x = std::strtof(text + 2, &end);
+            float y = std::strtof(end, &end);
+            graph.points.push_back(Point(x, y));
+        } else if (std::strncmp(text, "l ", 2) == 0) {
+            long previous = 0;
+            for (const char* cursor = text + 2;; cursor = end) {
+                long index = std::strtol(cursor, &end, 10);
+                if (end == cursor) {
+                    break;
+                }
+                // "l 3/7" carries a texture index after the slash
+                while (*end && *end != ' ' && *end != '\t') {
+                    ++end;
+                }
+                index = index < 0 ? static_cast<long>(graph.points.size()) + index + 1 : index;
+                if (index < 1 || index > static_cast<long>(graph.points.size())) {
+                    std::cerr << filename << ":" << lineNumber << ": vertex " << index << " does not exist" << std::endl;
+                    return false;
+                }
+                if (previous > 0) {
+                    graph.segments.push_back(Segment(static_cast<std::uint32_t>(previous - 1),
+                                                     static_cast<std::uint32_t>(index - 1)));
+                }
+                previous = index;
+            }
+        }
+    }
+    return true;
+}
+
+bool saveObj(const std::string& filename, const EdgeList& graph) {
+    std::FILE* file = std::fopen(filename.c_str(), "w");
+    if (!file) {
+        std::cerr << "Cannot write " << filename << std::endl;
+        return false;
+    }
+    // Nine significant digits keep every float exact
+    for (const Point& point : graph.points) {
+        std::fprintf(file, "v %.9g %.9g 0\n", point.x, point.y);
+    }
+    for (const Segment& segment : graph.segments) {
+        std::fprintf(file, "l %u %u\n", segment.a + 1, segment.b + 1);
+    }
+    bool written = !std::ferror(file);
+    written = std::fclose(file) == 0 && written;
+    if (!written) {
+        std::cerr << "Failed writing " << filename << std::endl;
+    }
+    return written;
+}
@@ -0,0 +1,139 @@
+#include "GraphOverview.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+GraphOverview::GraphOverview()
+    : lines(sf::Lines), linesEpoch(0), linesVersion(0), hasLines(false), densityQuads(sf::Triangles),
+      densityEpoch(0), densityVersion(0), densityCellSize(0), visibleLines(sf::Lines), stamp(0) {}
+
+// Walks from a vertex away from a segment while the road carries straight on through a
+// node of degree two, marking every segment taken. Returns the vertex the walk stops at.
+static std::uint32_t extendRun(const Graph& graph, std::uint32_t vertex, int segmentId,
+                               float dirX, float dirY, std::vector<int>& lineOfSegment, int line) {
+    float cosMerge = std::cos(GraphOverview::MergeAngle);
+    while (graph.topology.degree(vertex) == 2) {
+        const std::vector<int>& incident = graph.topology.incident(vertex);
+        int nextId = incident[0] == segmentId ? incident[1] : incident[0];
+        if (lineOfSegment[nextId] >= 0) {
+            break; // Closed loop back to the start
+        }
+        const Segment& next = *graph.segments.getByIndex(nextId);
+        std::uint32_t far = next.other(vertex);
+        float dx = graph.vertices.x(far) - graph.vertices.x(vertex);
+        float dy = graph.vertices.y(far) - graph.vertices.y(vertex);
+        float length = std::sqrt(dx * dx + dy * dy);
+        // Compare against the direction of the whole run so gentle curves do not drift
+        if (length == 0 || (dx * dirX + dy * dirY) / length < cosMerge) {
+            break;
+        }
+        lineOfSegment[nextId] = line;
+        segmentId = nextId;
+        vertex = far;
+    }
+    return vertex;
+}
+
+void GraphOverview::updateCenterlines(const Graph& graph) {
+    if (hasLines && linesEpoch == graph.epoch && linesVersion == graph.version) {
+        return;
+    }
+    lines.clear();
+    lineOfSegment.assign(graph.segments.capacity(), -1);
+
+    for (const Segment& segment : graph.segments) {
+        if (lineOfSegment[segment.id] >= 0) {
+            continue;
+        }
+        int line = static_cast<int>(lines.getVertexCount() / 2);
+        lineOfSegment[segment.id] = line;
+
+        float dx = graph.vertices.x(segment.b) - graph.vertices.x(segment.a);
+        float dy = graph.vertices.y(segment.b) - graph.vertices.y(segment.a);
+        float length = std::sqrt(dx * dx + dy * dy);
+        std::uint32_t start = segment.a, end = segment.b;
+        if (length > 0) {
+            dx /= length;
+            dy /= length;
+            end = extendRun(graph, segment.b, segment.id, dx, dy, lineOfSegment, line);
+            start = extendRun(graph, segment.a, segment.id, -dx, -dy, lineOfSegment, line);
+        }
+        lines.append(sf::Vertex(sf::Vector2f(graph.vertices.x(start), graph.vertices.y(start)), sf::Color::Black));
+        lines.append(sf::Vertex(sf::Vector2f(graph.vertices.x(end), graph.vertices.y(end)), sf::Color::Black));
+    }
+    lineStamps.assign(getLineCount(), 0);
+    linesEpoch = graph.epoch;
+    linesVersion = graph.version;
+    hasLines = true;
+}
+
+void GraphOverview::drawCenterlines(sf::RenderTarget& target, const Graph& graph, const sf::FloatRect& visibleArea) {
+    AABB area = {visibleArea.left, visibleArea.top,
+                 visibleArea.left + visibleArea.width, visibleArea.top + visibleArea.height};
+    if (area.contains({graph.minX, graph.minY, graph.maxX, graph.maxY})) {
+        target.draw(lines);
+        return;
+    }
+    std::vector<int> visible;
+    graph.segmentIndex.query(area, [&visible](int id) {
+        visible.push_back(id);
+        return true;
+    });
+    if (visible.size() * 2 > graph.segments.size()) {
+        target.draw(lines);
+        return;
+    }
+
+    // Several segments of the view may share a merged line; draw it once.
+    if (++stamp == 0) {
+        std::fill(lineStamps.begin(), lineStamps.end(), 0);
+        stamp = 1;
+    }
+    visibleLines.clear();
+    for (int id : visible) {
+        int line = id < static_cast<int>(lineOfSegment.size()) ? lineOfSegment[id] : -1;
+        if (line < 0 || lineStamps[line] == stamp) {
+            continue;
+        }
+        lineStamps[line] = stamp;
+        visibleLines.append(lines[2 * line]);
+        visibleLines.append(lines[2 * line + 1]);
+    }
+    target.draw(visibleLines);
+}
+
+void GraphOverview::updateDensity(const Graph& graph, float cellSize) {
+    if (densityEpoch == graph.epoch && densityVersion == graph.version && densityCellSize == cellSize &&
+        densityQuads.getVertexCount() > 0) {
+        return;
+    }
+    std::unordered_map<std::uint64_t, int> counts;
+    int maxCount = 1;
+    for (std::uint32_t index : graph.vertices.live()) {
+        std::int32_t cx = static_cast<std::int32_t>(std::floor(graph.vertices.x(index) / cellSize));
+        std::int32_t cy = static_cast<std::int32_t>(std::floor(graph.vertices.y(index) / cellSize));
+        int count = ++counts[(static_cast<std::uint64_t>(static_cast<std::uint32_t>(cx)) << 32) | static_cast<std::uint32_t>(cy)];
+        maxCount = std::max(maxCount, count);
+    }
+
+    densityQuads.clear();
+    for (const auto& cell : counts) {
+        float x = static_cast<float>(static_cast<std::int32_t>(cell.first >> 32)) * cellSize;
+        float y = static_cast<float>(static_cast<std::int32_t>(cell.first & 0xFFFFFFFFu)) * cellSize;
+        // Square root shading keeps sparse suburbs visible next to a dense centre
+        float share = std::sqrt(static_cast<float>(cell.second) / maxCount);
+        sf::Color color(40, 40, 40, static_cast<sf::Uint8>(60 + 195 * share));
+        sf::Vector2f corners[4] = {{x, y}, {x + cellSize, y}, {x + cellSize, y + cellSize}, {x, y + cellSize}};
+        int order[6] = {0, 1, 2, 0, 2, 3};
+        for (int i : order) {
+            densityQuads.append(sf::Vertex(corners[i], color));
+        }
+    }
+    densityEpoch = graph.epoch;
+    densityVersion = graph.version;
+    densityCellSize = cellSize;
+}
+
+void GraphOverview::drawDensity(sf::RenderTarget& target) {
+    target.draw(densityQuads);
+}
@@ -0,0 +1,326 @@
+#include "GraphProcessing.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+#include "Intersections.h"
+#include "Profiler.h"
+#include "VertexBuffer.h"
+
+static const std::uint32_t NoPoint = 0xFFFFFFFFu;
+
+static std::uint64_t cellKey(std::int64_t x, std::int64_t y) {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) | static_cast<std::uint32_t>(y);
+}
+
+// Drops the points not kept and renumbers the segments. Segments must only use kept points.
+static void compactPoints(EdgeList& graph, const std::vector<bool>& keep) {
+    std::vector<std::uint32_t> position(graph.points.size(), NoPoint);
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < graph.points.size(); ++i) {
+        if (keep[i]) {
+            position[i] = static_cast<std::uint32_t>(kept);
+            graph.points[kept++] = graph.points[i];
+        }
+    }
+    graph.points.resize(kept);
+    for (Segment& segment : graph.segments) {
+        segment = Segment(position[segment.a], position[segment.b]);
+    }
+}
+
+// Drops zero-length segments and repeats of a segment, in either direction.
+static void removeRepeatedSegments(EdgeList& graph) {
+    std::unordered_set<std::uint64_t> seen;
+    seen.reserve(graph.segments.size());
+    std::size_t kept = 0;
+    for (const Segment& segment : graph.segments) {
+        std::uint64_t key = (static_cast<std::uint64_t>(std::min(segment.a, segment.b)) << 32) |
+                            std::max(segment.a, segment.b);
+        if (segment.a != segment.b && seen.insert(key).second) {
+            graph.segments[kept++] = segment;
+        }
+    }
+    graph.segments.resize(kept);
+}
+
+void dedupe(EdgeList& graph, float tolerance) {
+    PROFILE_SCOPE("dedupe");
+    std::size_t count = graph.points.size();
+    // With no tolerance only equal points merge; any cell size finds them.
+    float cellSize = tolerance > 0 ? tolerance : 1.0f;
+    float limit = tolerance > 0 ? tolerance * tolerance : 0.0f;
+
+    // Kept points chained per grid cell: the first in cellHeads, the rest through next
+    std::unordered_map<std::uint64_t, std::uint32_t> cellHeads;
+    cellHeads.reserve(count);
+    std::vector<std::uint32_t> next(count, NoPoint);
+    std::vector<std::uint32_t> representative(count);
+    std::vector<bool> keep(count, false);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        const Point& point = graph.points[i];
+        std::int64_t cellX = static_cast<std::int64_t>(std::floor(point.x / cellSize));
+        std::int64_t cellY = static_cast<std::int64_t>(std::floor(point.y / cellSize));
+        std::uint32_t found = NoPoint;
+        for (std::int64_t dy = -1; dy <= 1 && found == NoPoint; ++dy) {
+            for (std::int64_t dx = -1; dx <= 1 && found == NoPoint; ++dx) {
+                auto head = cellHeads.find(cellKey(cellX + dx, cellY + dy));
+                for (std::uint32_t j = head == cellHeads.end() ? NoPoint : head->second; j != NoPoint; j = next[j]) {
+                    float ox = graph.points[j].x - point.x, oy = graph.points[j].y - point.y;
+                    if (ox * ox + oy * oy <= limit) {
+                        found = j;
+                        break;
+                    }
+                }
+            }
+        }
+        if (found != NoPoint) {
+            representative[i] = found;
+            continue;
+        }
+        representative[i] = i;
+        keep[i] = true;
+        auto head = cellHeads.emplace(cellKey(cellX, cellY), NoPoint).first;
+        next[i] = head->second;
+        head->second = i;
+    }
+
+    for (Segment& segment : graph.segments) {
+        segment = Segment(representative[segment.a], representative[segment.b]);
+    }
+    compactPoints(graph, keep);
+    removeRepeatedSegments(graph);
+}
+
+std::size_t splitCrossings(EdgeList& graph) {
+    PROFILE_SCOPE("splitCrossings");
+    VertexBuffer vertices;
+    vertices.reserve(graph.points.size());
+    for (const Point& point : graph.points) {
+        vertices.add(point.x, point.y);
+    }
+    std::vector<SegmentCrossing> crossings = findSegmentCrossings(graph.segments, vertices);
+    if (crossings.empty()) {
+        return 0;
+    }
+
+    // A crossing at a segment's end point, where one road ends on another, reuses that point.
+    auto pointAt = [&graph](const Segment& first, const Segment& second, const Point& crossing) {
+        for (std::uint32_t end : {first.a, first.b, second.a, second.b}) {
+            float dx = graph.points[end].x - crossing.x, dy = graph.points[end].y - crossing.y;
+            if (dx * dx + dy * dy <= SNAP_TOLERANCE * SNAP_TOLERANCE) {
+                return end;
+            }
+        }
+        graph.points.push_back(Point(crossing.x, crossing.y));
+        return static_cast<std::uint32_t>(graph.points.size() - 1);
+    };
+    auto along = [&graph](const Segment& segment, std::uint32_t point) {
+        const Point& a = graph.points[segment.a];
+        const Point& b = graph.points[segment.b];
+        float dx = b.x - a.x, dy = b.y - a.y;
+        float length = dx * dx + dy * dy;
+        return length > 0 ? ((graph.points[point].x - a.x) * dx + (graph.points[point].y - a.y) * dy) / length : 0.0f;
+    };
+
+    struct Split {
+        std::size_t segment;
+        float along;
+        std::uint32_t point;
+    };
+    std::vector<Split> splits;
+    splits.reserve(2 * crossings.size());
+    for (const SegmentCrossing& crossing : crossings) {
+        const Segment& first = graph.segments[crossing.first];
+        const Segment& second = graph.segments[crossing.second];
+        std::uint32_t point = pointAt(first, second, crossing.point);
+        splits.push_back({crossing.first, along(first, point), point});
+        splits.push_back({crossing.second, along(second, point), point});
+    }
+    std::sort(splits.begin(), splits.end(), [](const Split& a, const Split& b) {
+        return a.segment != b.segment ? a.segment < b.segment : a.along < b.along;
+    });
+
+    std::vector<Segment> pieces;
+    pieces.reserve(graph.segments.size() + splits.size());
+    auto split = splits.begin();
+    for (std::size_t i = 0; i < graph.segments.size(); ++i) {
+        std::uint32_t from = graph.segments[i].a;
+        for (; split != splits.end() && split->segment == i; ++split) {
+            if (split->point != from) {
+                pieces.push_back(Segment(from, split->point));
+                from = split->point;
+            }
+        }
+        if (graph.segments[i].b != from) {
+            pieces.push_back(Segment(from, graph.segments[i].b));
+        }
+    }
+    graph.segments.swap(pieces);
+
+    // Three or more roads crossing at one spot gave one point per pair
+    dedupe(graph, SNAP_TOLERANCE);
+    return crossings.size();
+}
+
+// Distance from p to the segment ab, or to a when a and b are the same point.
+static float distanceToSegment(const Point& p, const Point& a, const Point& b) {
+    float dx = b.x - a.x, dy = b.y - a.y;
+    float length = dx * dx + dy * dy;
+    float t = length > 0 ? std::max(0.0f, std::min(1.0f, ((p.x - a.x) * dx + (p.y - a.y) * dy) / length)) : 0.0f;
+    float ox = a.x + t * dx - p.x, oy = a.y + t * dy - p.y;
+    return std::sqrt(ox * ox + oy * oy);
+}
+
+// Douglas-Peucker over one chain of points, appending the segments between the points
+// kept and marking the others for removal.
+static void simplifyChain(const EdgeList& graph, const std::vector<std::uint32_t>& chain, float tolerance,
+                          std::vector<bool>& keepPoint, std::vector<Segment>& result) {
+    std::size_t count = chain.size();
+    std::vector<bool> kept(count, false);
+    kept[0] = kept[count - 1] = true;
+    std::vector<std::pair<std::size_t, std::size_t>> ranges = {{0, count - 1}};
+    while (!ranges.empty()) {
+        std::size_t first = ranges.back().first, last = ranges.back().second;
+        ranges.pop_back();
+        float farthest = tolerance;
+        std::size_t split = 0;
+        for (std::size_t i = first + 1; i < last; ++i) {
+            float distance = distanceToSegment(graph.points[chain[i]], graph.points[chain[first]], graph.points[chain[last]]);
+            if (distance > farthest) {
+                farthest = distance;
+                split = i;
+            }
+        }
+        if (split != 0) {
+            kept[split] = true;
+            ranges.push_back({first, split});
+            ranges.push_back({split, last});
+        }
+    }
+    // A loop needs two points besides its start to stay a loop
+    if (chain.front() == chain.back() && count > 3 &&
+        std::count(kept.begin() + 1, kept.end() - 1, true) < 2) {
+        kept[count / 3] = kept[2 * count / 3] = true;
+    }
+
+    std::size_t from = 0;
+    for (std::size_t i = 1; i < count; ++i) {
+        if (kept[i]) {
+            result.push_back(Segment(chain[from], chain[i]));
+            from = i;
+        } else {
+            keepPoint[chain[i]] = false;
+        }
+    }
+}
+
+void simplify(EdgeList& graph, float tolerance) {
+    PROFILE_SCOPE("simplify");
+    removeRepeatedSegments(graph);
+    std::size_t count = graph.points.size();
+
+    // The segments at each point, as one array cut up by offsets
+    std::vector<std::uint32_t> offsets(count + 1, 0);
+    for (const Segment& segment : graph.segments) {
+        ++offsets[segment.a + 1];
+        ++offsets[segment.b + 1];
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    std::vector<std::uint32_t> incident(offsets[count]);
+    std::vector<std::uint32_t> filled(offsets.begin(), offsets.end() - 1);
+    for (std::uint32_t i = 0; i < graph.segments.size(); ++i) {
+        incident[filled[graph.segments[i].a]++] = i;
+        incident[filled[graph.segments[i].b]++] = i;
+    }
+    auto degree = [&offsets](std::uint32_t point) { return offsets[point + 1] - offsets[point]; };
+
+    std::vector<bool> visited(graph.segments.size(), false);
+    std::vector<bool> keepPoint(count, true);
+    std::vector<Segment> result;
+    result.reserve(graph.segments.size());
+    std::vector<std::uint32_t> chain;
+    // Follows segments from a point through points of degree two, up to the next other point
+    auto walk = [&](std::uint32_t start, std::uint32_t segment) {
+        chain.assign(1, start);
+        std::uint32_t current = start;
+        while (true) {
+            visited[segment] = true;
+            current = graph.segments[segment].other(current);
+            chain.push_back(current);
+            if (degree(current) != 2 || current == start) {
+                break;
+            }
+            std::uint32_t first = incident[offsets[current]], second = incident[offsets[current] + 1];
+            segment = first == segment ? second : first;
+        }
+        simplifyChain(graph, chain, tolerance, keepPoint, result);
+    };
+
+    for (std::uint32_t point = 0; point < count; ++point) {
+        if (degree(point) == 2) {
+            continue;
+        }
+        for (std::uint32_t i = offsets[point]; i < offsets[point + 1]; ++i) {
+            if (!visited[incident[i]]) {
+                walk(point, incident[i]);
+            }
+        }
+    }
+    // What is left are loops with no junction on them
+    for (std::uint32_t i = 0; i < graph.segments.size(); ++i) {
+        if (!visited[i]) {
+            walk(graph.segments[i].a, i);
+        }
+    }
+
+    graph.segments.swap(result);
+    compactPoints(graph, keepPoint);
+    // Chains simplified to a straight segment can repeat one already there
+    removeRepeatedSegments(graph);
+}
+
+GraphStats computeStats(const EdgeList& graph) {
+    PROFILE_SCOPE("computeStats");
+    GraphStats stats;
+    stats.points = graph.points.size();
+    stats.segments = graph.segments.size();
+
+    std::vector<std::uint32_t> degrees(graph.points.size(), 0);
+    // Union-find over the points, joined by every segment
+    std::vector<std::uint32_t> parent(graph.points.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    auto root = [&parent](std::uint32_t point) {
+        while (parent[point] != point) {
+            parent[point] = parent[parent[point]];
+            point = parent[point];
+        }
+        return point;
+    };
+    for (const Segment& segment : graph.segments) {
+        ++degrees[segment.a];
+        ++degrees[segment.b];
+        parent[root(segment.a)] = root(segment.b);
+        float dx = graph.points[segment.b].x - graph.points[segment.a].x;
+        float dy = graph.points[segment.b].y - graph.points[segment.a].y;
+        stats.totalLength += std::sqrt(static_cast<double>(dx) * dx + static_cast<double>(dy) * dy);
+    }
+
+    for (std::uint32_t i = 0; i < graph.points.size(); ++i) {
+        std::uint32_t degree = degrees[i];
+        stats.isolatedPoints += degree == 0 ? 1 : 0;
+        stats.deadEnds += degree == 1 ? 1 : 0;
+        stats.junctions += degree >= 3 ? 1 : 0;
+        stats.maxDegree = std::max<std::size_t>(stats.maxDegree, degree);
+        stats.components += root(i) == i ? 1 : 0;
+
+        const Point& point = graph.points[i];
+        stats.minX = i == 0 ? point.x : std::min(stats.minX, point.x);
+        stats.minY = i == 0 ? point.y : std::min(stats.minY, point.y);
+        stats.maxX = i == 0 ? point.x : std::max(stats.maxX, point.x);
+        stats.maxY = i == 0 ? point.y : std::max(stats.maxY, point.y);
+    }
+    return stats;
+}
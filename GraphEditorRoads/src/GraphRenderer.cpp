@@ -0,0 +1,325 @@
+#include "GraphRenderer.h"
+#include <cmath>
+#include "Constants.h"
+#include "Profiler.h"
+
+// Vertices written per segment (two triangles), per point (a fan of triangles)
+// and per envelope (its convex outline split into a fan)
+static const std::size_t SegmentVertices = 6;
+static const std::size_t PointVertices = 3 * GraphRenderer::DiscSides;
+static const std::size_t EnvelopePoints = 4 * Envelope::CornerPoints;
+static const std::size_t EnvelopeVertices = 3 * (EnvelopePoints - 2);
+
+GraphRenderer::GraphRenderer(float segmentWidth, float pointRadius, sf::Color segmentColor, sf::Color pointColor,
+                             sf::Color borderColor)
+    : segmentWidth(segmentWidth), pointRadius(pointRadius), segmentColor(segmentColor), pointColor(pointColor),
+      borderColor(borderColor), segmentTriangles(sf::Triangles), pointTriangles(sf::Triangles),
+      envelopeTriangles(sf::Triangles), borderLines(sf::Lines), borderLinesStale(true), everythingDirty(true),
+      visibleSegmentTriangles(sf::Triangles), visiblePointTriangles(sf::Triangles),
+      visibleEnvelopeTriangles(sf::Triangles), visibleBorderLines(sf::Lines), syncedEpoch(0), syncedVersion(0) {
+    roadTexture = resourceManager.loadTexture("roadTexture", "Assets/road.png");
+    for (int i = 0; i < DiscSides; ++i) {
+        float angle = static_cast<float>(2 * MY_PI * i / DiscSides);
+        disc[i] = sf::Vector2f(std::cos(angle), std::sin(angle));
+    }
+}
+
+void GraphRenderer::sync(Graph& graph) {
+    PROFILE_SCOPE("GraphRenderer::sync");
+    // A replaced graph shares no slots with the one drawn, whatever its version says
+    if (graph.epoch != syncedEpoch) {
+        rebuild(graph);
+        return;
+    }
+    segmentTriangles.resize(graph.segments.capacity() * SegmentVertices);
+    pointTriangles.resize(graph.vertices.capacity() * PointVertices);
+    envelopeTriangles.resize(graph.segments.capacity() * EnvelopeVertices);
+
+    // The envelope covers its segment, so its old and new areas cover every changed pixel.
+    for (std::uint32_t slot : graph.changedSegments) {
+        addDirtyArea(envelopeTriangles, slot, EnvelopeVertices);
+        writeSegment(graph, slot);
+        writeEnvelope(graph, slot);
+        addDirtyArea(envelopeTriangles, slot, EnvelopeVertices);
+    }
+    for (std::uint32_t slot : graph.changedVertices) {
+        addDirtyArea(pointTriangles, slot, PointVertices);
+        writePoint(graph, slot);
+        addDirtyArea(pointTriangles, slot, PointVertices);
+    }
+    // Borders only change inside the old and new areas of the changed envelopes, which
+    // the dirty areas above already cover.
+    if (!graph.changedSegments.empty()) {
+        borders.update(graph, graph.changedSegments);
+        borderLinesStale = true;
+    }
+    graph.clearChanges();
+    syncedVersion = graph.version;
+}
+
+void GraphRenderer::rebuild(Graph& graph) {
+    PROFILE_SCOPE("GraphRenderer::rebuild");
+    segmentTriangles.clear();
+    pointTriangles.clear();
+    envelopeTriangles.clear();
+    segmentTriangles.resize(graph.segments.capacity() * SegmentVertices);
+    pointTriangles.resize(graph.vertices.capacity() * PointVertices);
+    envelopeTriangles.resize(graph.segments.capacity() * EnvelopeVertices);
+    for (std::uint32_t slot = 0; slot < graph.segments.capacity(); ++slot) {
+        writeSegment(graph, slot);
+    }
+    // Free slots keep the default, degenerate vertices resize gave them.
+    const std::vector<Envelope>& envelopes = graph.roadEnvelopes.dense();
+    envelopeOutlines.resize(envelopes.size() * EnvelopePoints);
+    Envelope::getPolygons(graph.vertices, envelopes.data(), envelopes.size(), envelopeOutlines.data());
+    for (std::size_t i = 0; i < envelopes.size(); ++i) {
+        writeEnvelope(graph, envelopes[i].getSkeleton().id, &envelopeOutlines[i * EnvelopePoints]);
+    }
+    for (std::uint32_t slot = 0; slot < graph.vertices.capacity(); ++slot) {
+        writePoint(graph, slot);
+    }
+    borders.rebuild(graph);
+    borderLinesStale = true;
+    dirtyAreas.clear();
+    everythingDirty = true;
+    graph.clearChanges();
+    syncedEpoch = graph.epoch;
+    syncedVersion = graph.version;
+}
+
+void GraphRenderer::draw(sf::RenderTarget& target, Graph& graph) {
+    sync(graph);
+    target.draw(segmentTriangles);
+    target.draw(pointTriangles);
+    target.draw(envelopeTriangles, sf::RenderStates(roadTexture.get()));
+    if (borderLinesStale) {
+        borderLines.clear();
+        for (std::uint32_t slot = 0; slot < graph.segments.capacity(); ++slot) {
+            appendBorders(borderLines, slot);
+        }
+        borderLinesStale = false;
+    }
+    target.draw(borderLines);
+}
+
+void GraphRenderer::appendBorders(sf::VertexArray& lines, std::uint32_t slot) const {
+    for (const BorderEdge& edge : borders.getEdges(slot)) {
+        lines.append(sf::Vertex(sf::Vector2f(edge.a.x, edge.a.y), borderColor));
+        lines.append(sf::Vertex(sf::Vector2f(edge.b.x, edge.b.y), borderColor));
+    }
+}
+
+GraphRenderer::DetailLevel GraphRenderer::detailLevelFor(float zoom) {
+    if (zoom >= DensityZoom) return DetailLevel::Density;
+    if (zoom >= CenterlineZoom) return DetailLevel::Centerlines;
+    return DetailLevel::Full;
+}
+
+void GraphRenderer::draw(sf::RenderTarget& target, Graph& graph, const sf::FloatRect& visibleArea, float zoom) {
+    PROFILE_SCOPE("GraphRenderer::draw");
+    sync(graph);
+
+    DetailLevel level = detailLevelFor(zoom);
+    if (level == DetailLevel::Density) {
+        // Cells about 16 pixels wide, snapped to powers of two so zooming rarely rebins
+        float cellSize = std::exp2(std::ceil(std::log2(16.0f * zoom)));
+        overview.updateDensity(graph, cellSize);
+        overview.drawDensity(target);
+        return;
+    }
+    if (level == DetailLevel::Centerlines) {
+        overview.updateCenterlines(graph);
+        overview.drawCenterlines(target, graph, visibleArea);
+        return;
+    }
+
+    AABB area = {visibleArea.left, visibleArea.top,
+                 visibleArea.left + visibleArea.width, visibleArea.top + visibleArea.height};
+    if (area.contains({graph.minX - ROAD_WIDTH, graph.minY - ROAD_WIDTH, graph.maxX + ROAD_WIDTH, graph.maxY + ROAD_WIDTH})) {
+        draw(target, graph);
+        return;
+    }
+    visibleSegments.clear();
+    graph.segmentIndex.query(area, [this](int id) {
+        visibleSegments.push_back(id);
+        return true;
+    });
+    // Copying most of the graph costs more than drawing all of it.
+    if (visibleSegments.size() * 2 > graph.segments.size() && graph.segments.size() > 0) {
+        draw(target, graph);
+        return;
+    }
+    std::vector<int> visiblePoints = graph.pointIndex.queryRect(area.minX - pointRadius, area.minY - pointRadius,
+                                                                area.maxX + pointRadius, area.maxY + pointRadius);
+
+    copySlots(segmentTriangles, visibleSegmentTriangles, visibleSegments, SegmentVertices);
+    copySlots(pointTriangles, visiblePointTriangles, visiblePoints, PointVertices);
+    copySlots(envelopeTriangles, visibleEnvelopeTriangles, visibleSegments, EnvelopeVertices);
+    visibleBorderLines.clear();
+    for (int slot : visibleSegments) {
+        appendBorders(visibleBorderLines, static_cast<std::uint32_t>(slot));
+    }
+    target.draw(visibleSegmentTriangles);
+    target.draw(visiblePointTriangles);
+    target.draw(visibleEnvelopeTriangles, sf::RenderStates(roadTexture.get()));
+    target.draw(visibleBorderLines);
+}
+
+void GraphRenderer::drawCached(sf::RenderTarget& target, Graph& graph, const sf::FloatRect& visibleArea, float zoom) {
+    PROFILE_SCOPE("GraphRenderer::drawCached");
+    unsigned long long previousVersion = syncedVersion;
+    sync(graph);
+
+    // Merged centerlines and density shading can change far from an edit, so the
+    // zoomed out levels redraw every tile after any edit.
+    if (everythingDirty || (detailLevelFor(zoom) != DetailLevel::Full && graph.version != previousVersion)) {
+        tileCache.invalidateAll();
+    } else {
+        for (const AABB& area : dirtyAreas) {
+            tileCache.invalidate(area);
+        }
+    }
+    dirtyAreas.clear();
+    everythingDirty = false;
+
+    tileCache.draw(target, visibleArea, zoom, [&](sf::RenderTarget& tile, const sf::FloatRect& area) {
+        draw(tile, graph, area, zoom);
+    });
+}
+
+void GraphRenderer::addDirtyArea(const sf::VertexArray& array, std::uint32_t slot, std::size_t verticesPerSlot) {
+    std::size_t first = static_cast<std::size_t>(slot) * verticesPerSlot;
+    if (first + verticesPerSlot > array.getVertexCount()) {
+        return;
+    }
+    AABB area = {array[first].position.x, array[first].position.y, array[first].position.x, array[first].position.y};
+    for (std::size_t i = first + 1; i < first + verticesPerSlot; ++i) {
+        area = AABB::merge(area, {array[i].position.x, array[i].position.y, array[i].position.x, array[i].position.y});
+    }
+    // Free slots are collapsed to a point and draw nothing.
+    if (area.minX < area.maxX || area.minY < area.maxY) {
+        dirtyAreas.push_back(area);
+    }
+}
+
+// Gathers the vertex runs of the given slots into one array.
+void GraphRenderer::copySlots(const sf::VertexArray& from, sf::VertexArray& to,
+                              const std::vector<int>& slots, std::size_t verticesPerSlot) {
+    to.resize(slots.size() * verticesPerSlot);
+    std::size_t next = 0;
+    for (int slot : slots) {
+        std::size_t first = static_cast<std::size_t>(slot) * verticesPerSlot;
+        if (first + verticesPerSlot > from.getVertexCount()) {
+            continue;
+        }
+        for (std::size_t i = 0; i < verticesPerSlot; ++i) {
+            to[next++] = from[first + i];
+        }
+    }
+    to.resize(next);
+}
+
+// Writes the quad of a segment slot as two triangles centred on the segment.
+void GraphRenderer::writeSegment(const Graph& graph, std::uint32_t slot) {
+    if (static_cast<std::size_t>(slot) * SegmentVertices >= segmentTriangles.getVertexCount()) {
+        return;
+    }
+    sf::Vertex* quad = &segmentTriangles[slot * SegmentVertices];
+    const Segment* segment = graph.segments.getByIndex(slot);
+    if (!segment) {
+        for (std::size_t i = 0; i < SegmentVertices; ++i) {
+            quad[i] = sf::Vertex();
+        }
+        return;
+    }
+
+    sf::Vector2f a(graph.vertices.x(segment->a), graph.vertices.y(segment->a));
+    sf::Vector2f b(graph.vertices.x(segment->b), graph.vertices.y(segment->b));
+    sf::Vector2f direction = b - a;
+    float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+    sf::Vector2f normal = length > 0 ? sf::Vector2f(-direction.y, direction.x) * (segmentWidth / 2.0f / length)
+                                     : sf::Vector2f(0, 0);
+
+    quad[0] = sf::Vertex(a + normal, segmentColor);
+    quad[1] = sf::Vertex(b + normal, segmentColor);
+    quad[2] = sf::Vertex(b - normal, segmentColor);
+    quad[3] = sf::Vertex(a + normal, segmentColor);
+    quad[4] = sf::Vertex(b - normal, segmentColor);
+    quad[5] = sf::Vertex(a - normal, segmentColor);
+}
+
+// Writes the disc of a point slot as a fan of triangles around its centre.
+void GraphRenderer::writePoint(const Graph& graph, std::uint32_t slot) {
+    if (static_cast<std::size_t>(slot) * PointVertices >= pointTriangles.getVertexCount()) {
+        return;
+    }
+    sf::Vertex* fan = &pointTriangles[slot * PointVertices];
+    if (!graph.vertices.isLive(slot)) {
+        for (std::size_t i = 0; i < PointVertices; ++i) {
+            fan[i] = sf::Vertex();
+        }
+        return;
+    }
+
+    sf::Vector2f centre(graph.vertices.x(slot), graph.vertices.y(slot));
+    for (int i = 0; i < DiscSides; ++i) {
+        fan[3 * i] = sf::Vertex(centre, pointColor);
+        fan[3 * i + 1] = sf::Vertex(centre + disc[i] * pointRadius, pointColor);
+        fan[3 * i + 2] = sf::Vertex(centre + disc[(i + 1) % DiscSides] * pointRadius, pointColor);
+    }
+}
+
+// Writes the envelope of a segment slot. Texture coordinates run along the road in
+// texels, scaled so the texture's height spans the road's width, and rely on the
+// texture repeating to tile it along the road.
+void GraphRenderer::writeEnvelope(const Graph& graph, std::uint32_t slot) {
+    if (static_cast<std::size_t>(slot) * EnvelopeVertices >= envelopeTriangles.getVertexCount()) {
+        return;
+    }
+    sf::Vertex* mesh = &envelopeTriangles[slot * EnvelopeVertices];
+    const Segment* segment = graph.segments.getByIndex(slot);
+    const Envelope* envelope = segment ? graph.roadEnvelopes.get(graph.segmentEnvelopes[slot]) : nullptr;
+    if (!envelope) {
+        for (std::size_t i = 0; i < EnvelopeVertices; ++i) {
+            mesh[i] = sf::Vertex();
+        }
+        return;
+    }
+
+    Point outline[EnvelopePoints];
+    envelope->getPolygon(graph.vertices, outline);
+    writeEnvelope(graph, slot, outline);
+}
+
+void GraphRenderer::writeEnvelope(const Graph& graph, std::uint32_t slot, const Point* outline) {
+    if (static_cast<std::size_t>(slot) * EnvelopeVertices >= envelopeTriangles.getVertexCount()) {
+        return;
+    }
+    sf::Vertex* mesh = &envelopeTriangles[slot * EnvelopeVertices];
+    const Segment* segment = graph.segments.getByIndex(slot);
+    const Envelope* envelope = segment ? graph.roadEnvelopes.get(graph.segmentEnvelopes[slot]) : nullptr;
+    if (!envelope) {
+        return;
+    }
+
+    float ax = graph.vertices.x(segment->a), ay = graph.vertices.y(segment->a);
+    float bx = graph.vertices.x(segment->b), by = graph.vertices.y(segment->b);
+    float length = std::sqrt((bx - ax) * (bx - ax) + (by - ay) * (by - ay));
+    float dx = length > 0 ? (bx - ax) / length : 1.0f;
+    float dy = length > 0 ? (by - ay) / length : 0.0f;
+    float halfWidth = static_cast<float>(envelope->getWidth()) / 2.0f;
+    float scale = roadTexture->getSize().y / static_cast<float>(envelope->getWidth());
+
+    sf::Vertex corners[EnvelopePoints];
+    for (std::size_t i = 0; i < EnvelopePoints; ++i) {
+        float along = (outline[i].x - ax) * dx + (outline[i].y - ay) * dy;
+        float across = (outline[i].y - ay) * dx - (outline[i].x - ax) * dy;
+        corners[i] = sf::Vertex(sf::Vector2f(outline[i].x, outline[i].y),
+                                sf::Vector2f(along * scale, (across + halfWidth) * scale));
+    }
+    for (std::size_t i = 0; i + 2 < EnvelopePoints; ++i) {
+        mesh[3 * i] = corners[0];
+        mesh[3 * i + 1] = corners[i + 1];
+        mesh[3 * i + 2] = corners[i + 2];
+    }
+}
@@ -0,0 +1,295 @@
+#include "Intersections.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <queue>
+#include <set>
+#include <unordered_set>
+#include "utils.h"
+
+bool segmentsCross(const Segment& a, const Segment& b, const VertexBuffer& vertices, Point& crossing) {
+    Point a1 = vertices.point(a.a), a2 = vertices.point(a.b);
+    Point b1 = vertices.point(b.a), b2 = vertices.point(b.b);
+    if (a1.equals(b1) || a1.equals(b2) || a2.equals(b1) || a2.equals(b2)) {
+        return false;
+    }
+    return getSegmentIntersection(a1, a2, b1, b2, crossing);
+}
+
+namespace {
+
+// The sweep runs over a copy of the input rotated by a small angle, so that
+// vertical segments and endpoints sharing an x coordinate (common in grid
+// layouts) do not need special cases. Crossings themselves are rotation invariant.
+const double SweepAngle = 0.0137;
+
+struct SweepSegment {
+    double x1, y1, x2, y2; // Left end point first
+    double slope;
+};
+
+struct Event {
+    enum Kind { Start, Cross, End };
+    double x, y;
+    Kind kind;
+    int a, b;
+};
+
+struct EventAfter {
+    bool operator()(const Event& lhs, const Event& rhs) const {
+        if (lhs.x != rhs.x) return lhs.x > rhs.x;
+        return lhs.y > rhs.y;
+    }
+};
+
+class Sweep {
+public:
+    Sweep(const std::vector<Segment>& input, const VertexBuffer& vertices);
+    std::vector<SegmentCrossing> run();
+
+private:
+    // Orders segments by their height where they meet the sweep line, and by
+    // slope when they meet it at the same point (the order just after the point).
+    struct Below {
+        const Sweep* sweep;
+        bool operator()(int lhs, int rhs) const;
+    };
+    typedef std::set<int, Below> Status;
+
+    double yAt(int segment) const;
+    void check(int lower, int upper);
+    int walk(Status::iterator from, int stamp, bool down, Status::iterator& edge);
+
+    const std::vector<Segment>& input;
+    const VertexBuffer& vertices;
+    std::vector<SweepSegment> segments;
+    double sweepX, sweepY;
+    // Extra point-like segment used to search the status at an event point
+    int probe;
+
+    Status status;
+    std::vector<Status::iterator> where;
+    std::vector<char> active;
+    std::vector<int> marks;
+
+    std::priority_queue<Event, std::vector<Event>, EventAfter> events;
+    std::unordered_set<std::uint64_t> seenPairs;
+    std::vector<SegmentCrossing> crossings;
+};
+
+Sweep::Sweep(const std::vector<Segment>& input, const VertexBuffer& vertices)
+    : input(input), vertices(vertices), sweepX(-std::numeric_limits<double>::max()), sweepY(-std::numeric_limits<double>::max()),
+      probe(static_cast<int>(input.size())), status(Below{this}),
+      where(input.size() + 1), active(input.size() + 1, 0), marks(input.size() + 1, 0) {
+    double c = std::cos(SweepAngle);
+    double s = std::sin(SweepAngle);
+    segments.resize(input.size() + 1);
+    for (size_t i = 0; i < input.size(); ++i) {
+        const Segment& seg = input[i];
+        double x1 = vertices.x(seg.a), y1 = vertices.y(seg.a);
+        double x2 = vertices.x(seg.b), y2 = vertices.y(seg.b);
+        double ax = x1 * c - y1 * s, ay = x1 * s + y1 * c;
+        double bx = x2 * c - y2 * s, by = x2 * s + y2 * c;
+        if (bx < ax || (bx == ax && by < ay)) {
+            std::swap(ax, bx);
+            std::swap(ay, by);
+        }
+        SweepSegment& sweepSegment = segments[i];
+        sweepSegment = {ax, ay, bx, by, bx != ax ? (by - ay) / (bx - ax) : std::numeric_limits<double>::infinity()};
+
+        if (ax == bx && ay == by) {
+            continue; // Degenerate segments cannot cross anything
+        }
+        events.push({ax, ay, Event::Start, static_cast<int>(i), -1});
+        events.push({bx, by, Event::End, static_cast<int>(i), -1});
+    }
+}
+
+double Sweep::yAt(int index) const {
+    const SweepSegment& segment = segments[index];
+    if (segment.x1 == segment.x2) {
+        return std::min(std::max(sweepY, segment.y1), segment.y2);
+    }
+    if (sweepX <= segment.x1) return segment.y1;
+    if (sweepX >= segment.x2) return segment.y2;
+    return segment.y1 + (sweepX - segment.x1) * segment.slope;
+}
+
+bool Sweep::Below::operator()(int lhs, int rhs) const {
+    if (lhs == rhs) {
+        return false;
+    }
+    double lhsY = sweep->yAt(lhs);
+    double rhsY = sweep->yAt(rhs);
+    double tolerance = 1e-9 * std::max(1.0, std::max(std::fabs(lhsY), std::fabs(rhsY)));
+    if (lhsY < rhsY - tolerance) return true;
+    if (lhsY > rhsY + tolerance) return false;
+
+    double lhsSlope = sweep->segments[lhs].slope;
+    double rhsSlope = sweep->segments[rhs].slope;
+    if (lhsSlope != rhsSlope) return lhsSlope < rhsSlope;
+    return lhs < rhs;
+}
+
+// Tests two status neighbours and schedules their crossing if it lies ahead of the sweep line.
+void Sweep::check(int lower, int upper) {
+    if (lower < 0 || upper < 0) {
+        return;
+    }
+    std::uint64_t key = (static_cast<std::uint64_t>(std::min(lower, upper)) << 32) |
+                        static_cast<std::uint32_t>(std::max(lower, upper));
+    if (seenPairs.count(key)) {
+        return;
+    }
+
+    Point crossing;
+    if (!segmentsCross(input[lower], input[upper], vertices, crossing)) {
+        return;
+    }
+    seenPairs.insert(key);
+    crossings.push_back({static_cast<size_t>(std::min(lower, upper)), static_cast<size_t>(std::max(lower, upper)), crossing});
+
+    // Locate the crossing in sweep space to know when the pair swaps order.
+    const SweepSegment& a = segments[lower];
+    const SweepSegment& b = segments[upper];
+    double rx = a.x2 - a.x1, ry = a.y2 - a.y1;
+    double sx = b.x2 - b.x1, sy = b.y2 - b.y1;
+    double denominator = rx * sy - ry * sx;
+    if (denominator == 0) {
+        return;
+    }
+    double t = ((b.x1 - a.x1) * sy - (b.y1 - a.y1) * sx) / denominator;
+    double x = a.x1 + t * rx;
+    double y = a.y1 + t * ry;
+    if (x > sweepX || (x == sweepX && y > sweepY)) {
+        events.push({x, y, Event::Cross, lower, upper});
+    }
+}
+
+// Walks from an element of the status towards one end while the neighbours carry the
+// given mark. Leaves edge on the last marked element and returns the first unmarked
+// neighbour beyond it, or -1 if the walk reached the end of the status.
+int Sweep::walk(Status::iterator from, int stamp, bool down, Status::iterator& edge) {
+    edge = from;
+    if (down) {
+        while (edge != status.begin() && marks[*std::prev(edge)] == stamp) --edge;
+        return edge == status.begin() ? -1 : *std::prev(edge);
+    }
+    while (std::next(edge) != status.end() && marks[*std::next(edge)] == stamp) ++edge;
+    return std::next(edge) == status.end() ? -1 : *std::next(edge);
+}
+
+std::vector<SegmentCrossing> Sweep::run() {
+    int stamp = 0;
+    std::vector<int> starting, ending, crossing;
+
+    while (!events.empty()) {
+        Event event = events.top();
+        starting.clear();
+        ending.clear();
+        crossing.clear();
+
+        // Gather everything that happens at this event point.
+        while (!events.empty() && events.top().x == event.x && events.top().y == event.y) {
+            const Event& next = events.top();
+            if (next.kind == Event::Start) {
+                starting.push_back(next.a);
+            } else if (next.kind == Event::End) {
+                ending.push_back(next.a);
+            } else {
+                crossing.push_back(next.a);
+                crossing.push_back(next.b);
+            }
+            events.pop();
+        }
+
+        // Find every active segment passing through the event point. Crossing events
+        // only name one pair, but several roads may meet in the same spot.
+        sweepX = event.x;
+        sweepY = event.y;
+        segments[probe] = {event.x, event.y, event.x, event.y, -std::numeric_limits<double>::infinity()};
+        double tolerance = 1e-9 * std::max(1.0, std::fabs(event.y));
+        Status::iterator first = status.lower_bound(probe);
+        while (first != status.begin() && std::fabs(yAt(*std::prev(first)) - event.y) <= tolerance) --first;
+        for (Status::iterator it = first; it != status.end() && std::fabs(yAt(*it) - event.y) <= tolerance; ++it) {
+            crossing.push_back(*it);
+        }
+
+        // Segments ending here or passing through the point leave the status.
+        ++stamp;
+        std::vector<int> leaving;
+        for (int segment : ending) {
+            if (active[segment] && marks[segment] != stamp) {
+                marks[segment] = stamp;
+                leaving.push_back(segment);
+            }
+        }
+        for (int segment : crossing) {
+            if (active[segment] && marks[segment] != stamp) {
+                marks[segment] = stamp;
+                leaving.push_back(segment);
+            }
+        }
+        int below = -1, above = -1;
+        if (!leaving.empty()) {
+            Status::iterator edge;
+            below = walk(where[leaving.front()], stamp, true, edge);
+            above = walk(where[leaving.front()], stamp, false, edge);
+        }
+        for (int segment : leaving) {
+            status.erase(where[segment]);
+            active[segment] = 0;
+        }
+        if ((below >= 0 && marks[below] == stamp) || (above >= 0 && marks[above] == stamp)) {
+            below = above = -1;
+        }
+
+        // Everything meeting at this point crosses unless it shares the point as an end point.
+        for (size_t i = 0; i < leaving.size(); ++i) {
+            for (size_t j = i + 1; j < leaving.size(); ++j) check(leaving[i], leaving[j]);
+            for (int segment : starting) check(leaving[i], segment);
+        }
+
+        // Starting segments and those continuing past the crossing are inserted in
+        // their order just after the event point.
+        int endingStamp = stamp;
+        ++stamp;
+        std::vector<int> entering;
+        for (int segment : starting) {
+            if (marks[segment] != stamp) {
+                marks[segment] = stamp;
+                entering.push_back(segment);
+            }
+        }
+        for (int segment : crossing) {
+            bool endsHere = std::find(ending.begin(), ending.end(), segment) != ending.end();
+            if (!endsHere && marks[segment] == endingStamp) {
+                marks[segment] = stamp;
+                entering.push_back(segment);
+            }
+        }
+        for (int segment : entering) {
+            where[segment] = status.insert(segment).first;
+            active[segment] = 1;
+        }
+
+        if (entering.empty()) {
+            check(below, above);
+        } else {
+            Status::iterator lowest, highest;
+            int lower = walk(where[entering.front()], stamp, true, lowest);
+            int upper = walk(where[entering.front()], stamp, false, highest);
+            check(lower, *lowest);
+            check(*highest, upper);
+        }
+    }
+    return crossings;
+}
+
+} // namespace
+
+std::vector<SegmentCrossing> findSegmentCrossings(const std::vector<Segment>& segments, const VertexBuffer& vertices) {
+    Sweep sweep(segments, vertices);
+    return sweep.run();
+}
@@ -0,0 +1,192 @@
+#include "Log.h"
+#include <chrono>
+#include <cstdarg>
+#include <iostream>
+
+static std::int64_t nowNanoseconds() {
+    // Relative to the first call, so times read as seconds since startup
+    static const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+// Small sequential ids read better in the log than native thread ids.
+static unsigned threadNumber() {
+    static std::atomic<unsigned> next(0);
+    thread_local unsigned number = next.fetch_add(1, std::memory_order_relaxed);
+    return number;
+}
+
+static const char* levelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::Trace: return "TRACE";
+        case LogLevel::Debug: return "DEBUG";
+        case LogLevel::Info: return "INFO";
+        case LogLevel::Warn: return "WARN";
+        case LogLevel::Error: return "ERROR";
+        default: return "";
+    }
+}
+
+// __FILE__ may hold the whole build path; the file name is enough.
+static const char* baseName(const char* path) {
+    const char* name = path;
+    for (const char* c = path; *c; ++c) {
+        if (*c == '/' || *c == '\\') {
+            name = c + 1;
+        }
+    }
+    return name;
+}
+
+Log& Log::instance() {
+    static Log log;
+    return log;
+}
+
+Log::Log()
+    : records(new Record[Capacity]), head(0), tail(0), reportedDrops(0), written(0), dropped(0),
+      minLevel(static_cast<LogLevel>(GRAPH_LOG_LEVEL)), running(true), output(stderr) {
+    for (std::size_t i = 0; i < Capacity; ++i) {
+        records[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    nowNanoseconds();
+    writer = std::thread(&Log::run, this);
+}
+
+Log::~Log() {
+    {
+        // Under the lock, so the writer cannot miss it between checking and sleeping
+        std::lock_guard<std::mutex> lock(mutex);
+        running.store(false);
+        wake.notify_one();
+    }
+    writer.join();
+    if (output != stderr) {
+        std::fclose(output);
+    }
+}
+
+void Log::setLevel(LogLevel level) {
+    minLevel.store(level, std::memory_order_relaxed);
+}
+
+LogLevel Log::getLevel() const {
+    return minLevel.load(std::memory_order_relaxed);
+}
+
+bool Log::setOutput(const std::string& filename) {
+    std::FILE* file = std::fopen(filename.c_str(), "a");
+    if (!file) {
+        std::cerr << "Cannot write log to " << filename << std::endl;
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    drain();
+    if (output != stderr) {
+        std::fclose(output);
+    }
+    output = file;
+    return true;
+}
+
+void Log::write(LogLevel level, const char* file, int line, const char* format, ...) {
+    // Claim a position; the record there is free once the writer has moved a lap past it
+    std::uint64_t position = head.load(std::memory_order_relaxed);
+    Record* record;
+    for (;;) {
+        record = &records[position & (Capacity - 1)];
+        std::uint64_t sequence = record->sequence.load(std::memory_order_acquire);
+        if (sequence == position) {
+            if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (sequence < position) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            position = head.load(std::memory_order_relaxed);
+        }
+    }
+
+    record->time = nowNanoseconds();
+    record->level = level;
+    record->thread = threadNumber();
+    record->file = file;
+    record->line = line;
+    va_list arguments;
+    va_start(arguments, format);
+    std::vsnprintf(record->message, MessageSize, format, arguments);
+    va_end(arguments);
+    record->sequence.store(position + 1, std::memory_order_release);
+
+    // The writer sleeps while the buffer is empty, so the first record wakes it, under the
+    // lock so the wake-up cannot fall between its check and its wait. Later records wait
+    // for its next pass, unless they are warnings or the buffer is filling up.
+    std::uint64_t queued = position - written.load(std::memory_order_acquire);
+    if (queued == 0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        wake.notify_one();
+    } else if (level >= LogLevel::Warn || queued >= Capacity / 2) {
+        wake.notify_one();
+    }
+}
+
+// Writes out the records published so far, in order. Called with the mutex held.
+std::size_t Log::drain() {
+    std::size_t count = 0;
+    for (;;) {
+        Record& record = records[tail & (Capacity - 1)];
+        if (record.sequence.load(std::memory_order_acquire) != tail + 1) {
+            break;
+        }
+        std::fprintf(output, "%12.6f %-5s t%u %s:%d %s\n", record.time / 1e9, levelName(record.level),
+                     record.thread, baseName(record.file), record.line, record.message);
+        record.sequence.store(tail + Capacity, std::memory_order_release);
+        ++tail;
+        ++count;
+    }
+    std::uint64_t drops = dropped.load(std::memory_order_relaxed);
+    if (drops != reportedDrops) {
+        std::fprintf(output, "%12.6f %-5s log dropped=%llu\n", nowNanoseconds() / 1e9, levelName(LogLevel::Warn),
+                     static_cast<unsigned long long>(drops - reportedDrops));
+        reportedDrops = drops;
+        ++count;
+    }
+    if (count > 0) {
+        std::fflush(output);
+        written.store(tail, std::memory_order_release);
+        flushed.notify_all();
+    }
+    return count;
+}
+
+void Log::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        bool stopping = !running.load();
+        if (drain() == 0) {
+            bool empty = tail == head.load();
+            if (stopping && empty) {
+                return;
+            }
+            // Empty, sleep until a record arrives; otherwise one is claimed but not yet
+            // published, or was left for this pass, so look again shortly
+            if (empty) {
+                wake.wait(lock);
+            } else {
+                wake.wait_for(lock, std::chrono::milliseconds(10));
+            }
+        }
+    }
+}
+
+void Log::flush() {
+    std::uint64_t target = head.load();
+    std::unique_lock<std::mutex> lock(mutex);
+    wake.notify_one();
+    flushed.wait(lock, [this, target] { return written.load(std::memory_order_acquire) >= target; });
+}
+
+std::uint64_t Log::getDropped() const {
+    return dropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,164 @@
+#include "OsmImport.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include "GraphProcessing.h"
+#include "Log.h"
+#include "OsmReader.h"
+#include "Profiler.h"
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+std::ptrdiff_t OsmNodes::find(std::int64_t id, std::size_t& hint) const {
+    std::size_t first = 0, last = ids.size();
+    if (hint < ids.size() && ids[hint] <= id) {
+        // Ahead of the previous hit: widen the range until it passes the id
+        first = hint;
+        std::size_t step = 1;
+        last = hint + 1;
+        while (last < ids.size() && ids[last] < id) {
+            first = last;
+            step *= 2;
+            last = hint + step;
+        }
+        last = std::min(last + 1, ids.size());
+    } else if (hint < ids.size()) {
+        last = hint;
+    }
+    std::size_t position = std::lower_bound(ids.begin() + first, ids.begin() + last, id) - ids.begin();
+    hint = position;
+    return position < ids.size() && ids[position] == id ? static_cast<std::ptrdiff_t>(position) : -1;
+}
+
+bool isImportedHighway(const OsmImportOptions& options, const char* value, std::size_t length) {
+    return options.highways.empty() || options.highways.count(std::string(value, length)) != 0;
+}
+
+void reportProgress(const OsmImportOptions& options, const char* phase, std::uint64_t bytesRead,
+                    std::uint64_t totalBytes, std::size_t ways, std::size_t nodes) {
+    if (options.progress) {
+        options.progress({phase, bytesRead, totalBytes, ways, nodes});
+    }
+}
+
+std::uint64_t fileSize(const std::string& filename) {
+#ifdef _WIN32
+    struct _stati64 status;
+    return _stati64(filename.c_str(), &status) == 0 ? static_cast<std::uint64_t>(status.st_size) : 0;
+#else
+    struct stat status;
+    return stat(filename.c_str(), &status) == 0 ? static_cast<std::uint64_t>(status.st_size) : 0;
+#endif
+}
+
+bool seekFile(std::FILE* file, std::uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+static bool endsWith(const std::string& text, const char* suffix) {
+    std::size_t length = std::strlen(suffix);
+    return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+}
+
+// Web Mercator y in radians; latitudes past the projection's limit are clamped.
+static double mercatorY(double lat) {
+    const double pi = 3.14159265358979323846;
+    double clamped = std::max(-85.05112878, std::min(85.05112878, lat));
+    return std::log(std::tan(pi / 4 + clamped * pi / 360));
+}
+
+bool importOsm(const std::string& filename, EdgeList& graph, const OsmImportOptions& options) {
+    PROFILE_SCOPE("importOsm");
+    bool pbf = endsWith(filename, ".pbf");
+    OsmWays ways;
+    if (!(pbf ? readPbfWays(filename, options, ways) : readXmlWays(filename, options, ways))) {
+        return false;
+    }
+
+    OsmNodes nodes;
+    nodes.ids = ways.refs;
+    std::sort(nodes.ids.begin(), nodes.ids.end());
+    nodes.ids.erase(std::unique(nodes.ids.begin(), nodes.ids.end()), nodes.ids.end());
+    nodes.ids.shrink_to_fit();
+    nodes.lat.resize(nodes.ids.size());
+    nodes.lon.resize(nodes.ids.size());
+    nodes.found.assign(nodes.ids.size(), 0);
+    if (!(pbf ? readPbfNodes(filename, options, ways, nodes) : readXmlNodes(filename, options, ways, nodes))) {
+        return false;
+    }
+
+    // Nodes outside a clipped extract are missing; the roads are cut where they leave it
+    std::vector<std::uint32_t> point(nodes.ids.size());
+    std::size_t found = 0;
+    double minLat = 90, maxLat = -90, minLon = 180, maxLon = -180;
+    for (std::size_t i = 0; i < nodes.ids.size(); ++i) {
+        point[i] = static_cast<std::uint32_t>(found);
+        if (nodes.found[i]) {
+            ++found;
+            minLat = std::min(minLat, nodes.lat[i]);
+            maxLat = std::max(maxLat, nodes.lat[i]);
+            minLon = std::min(minLon, nodes.lon[i]);
+            maxLon = std::max(maxLon, nodes.lon[i]);
+        }
+    }
+    if (found < nodes.ids.size()) {
+        LOG_WARN("osm missing nodes=%zu of=%zu", nodes.ids.size() - found, nodes.ids.size());
+    }
+
+    // Positions relative to the origin keep float precision for country sized maps
+    const double pi = 3.14159265358979323846, earthRadius = 6378137.0;
+    double originLat = std::isnan(options.originLat) ? (found ? (minLat + maxLat) / 2 : 0) : options.originLat;
+    double originLon = std::isnan(options.originLon) ? (found ? (minLon + maxLon) / 2 : 0) : options.originLon;
+    double metres = earthRadius * std::cos(originLat * pi / 180) * options.scale;
+    double originY = mercatorY(originLat);
+    graph.points.clear();
+    graph.points.reserve(found);
+    for (std::size_t i = 0; i < nodes.ids.size(); ++i) {
+        if (nodes.found[i]) {
+            graph.points.push_back(Point(static_cast<float>((nodes.lon[i] - originLon) * pi / 180 * metres),
+                                         static_cast<float>(-(mercatorY(nodes.lat[i]) - originY) * metres)));
+        }
+    }
+
+    // Ways that share a stretch of road would give it twice
+    std::vector<std::uint64_t> keys;
+    keys.reserve(ways.refs.size());
+    // Consecutive nodes of a way are usually close in id, so each lookup gallops from the last
+    std::size_t start = 0, hint = 0;
+    for (std::size_t end : ways.ends) {
+        std::ptrdiff_t a = start < end ? nodes.find(ways.refs[start], hint) : -1;
+        for (std::size_t i = start + 1; i < end; ++i) {
+            std::ptrdiff_t b = nodes.find(ways.refs[i], hint);
+            if (a >= 0 && b >= 0 && a != b && nodes.found[a] && nodes.found[b]) {
+                std::uint64_t first = point[std::min(a, b)], second = point[std::max(a, b)];
+                keys.push_back(first << 32 | second);
+            }
+            a = b;
+        }
+        start = end;
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    graph.segments.resize(keys.size());
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        graph.segments[i] = Segment(static_cast<std::uint32_t>(keys[i] >> 32), static_cast<std::uint32_t>(keys[i]));
+    }
+
+    // Separate nodes at one spot, and nodes float rounding brings together, would break the
+    // rule that a position names one point
+    std::size_t projected = graph.points.size();
+    dedupe(graph, SNAP_TOLERANCE);
+    if (graph.points.size() < projected) {
+        LOG_INFO("osm merged nodes=%zu tolerance=%g", projected - graph.points.size(), SNAP_TOLERANCE);
+    }
+    LOG_INFO("osm imported file=%s ways=%zu points=%zu segments=%zu", filename.c_str(), ways.ends.size(),
+             graph.points.size(), graph.segments.size());
+    return true;
+}
@@ -0,0 +1,539 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include "OsmReader.h"
+#include "Profiler.h"
+
+#ifdef GRAPH_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+// An .osm.pbf file is a sequence of blobs, each a 4 byte big endian header length, a
+// BlobHeader and a Blob, which holds one zlib compressed PrimitiveBlock of up to 8000
+// nodes or ways. Only the handful of protobuf fields importOsm needs are decoded.
+namespace {
+
+// The format's own limits on header and blob sizes
+const std::uint32_t MaxHeaderSize = 64 * 1024;
+const std::uint32_t MaxBlobSize = 32 * 1024 * 1024;
+
+// Decodes protobuf wire format. Reading past the end marks the reader broken instead of
+// throwing, so callers check failed() once when done.
+class ProtoReader {
+public:
+    ProtoReader() = default;
+    ProtoReader(const std::uint8_t* data, std::size_t size) : cursor(data), end(data + size) {}
+
+    bool atEnd() const { return cursor >= end; }
+    bool failed() const { return broken; }
+
+    // Reads the key of the next field. Returns false at the end.
+    bool next(std::uint32_t& field, std::uint32_t& wireType) {
+        if (broken || cursor >= end) {
+            return false;
+        }
+        std::uint64_t key = varint();
+        field = static_cast<std::uint32_t>(key >> 3);
+        wireType = static_cast<std::uint32_t>(key & 7);
+        return !broken;
+    }
+
+    std::uint64_t varint() {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64 && cursor < end; shift += 7) {
+            std::uint8_t byte = *cursor++;
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        broken = true;
+        return 0;
+    }
+
+    // sint64, zigzag encoded
+    std::int64_t svarint() {
+        std::uint64_t value = varint();
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    // A length delimited field: a nested message, string or packed array.
+    ProtoReader bytes() {
+        std::uint64_t size = varint();
+        if (broken || size > static_cast<std::uint64_t>(end - cursor)) {
+            broken = true;
+            return ProtoReader();
+        }
+        ProtoReader field(cursor, static_cast<std::size_t>(size));
+        cursor += size;
+        return field;
+    }
+
+    void skip(std::uint32_t wireType) {
+        std::size_t size = 0;
+        switch (wireType) {
+            case 0: varint(); return;
+            case 1: size = 8; break;
+            case 2: bytes(); return;
+            case 5: size = 4; break;
+            default: broken = true; return;
+        }
+        if (size > static_cast<std::size_t>(end - cursor)) {
+            broken = true;
+            return;
+        }
+        cursor += size;
+    }
+
+    const std::uint8_t* data() const { return cursor; }
+    std::size_t size() const { return end - cursor; }
+
+private:
+    const std::uint8_t* cursor = nullptr;
+    const std::uint8_t* end = nullptr;
+    bool broken = false;
+};
+
+// Calls read(reader) for each value of a repeated field, packed or not.
+template <typename Read>
+void forEachValue(ProtoReader& message, std::uint32_t wireType, Read read) {
+    if (wireType == 2) {
+        ProtoReader packed = message.bytes();
+        while (!packed.atEnd() && !packed.failed()) {
+            read(packed);
+        }
+    } else {
+        read(message);
+    }
+}
+
+struct Blob {
+    std::uint64_t offset = 0;
+    bool isData = false;
+    std::vector<std::uint8_t> data;
+};
+
+// Reads the blob at the file's current position. Returns false at the end of the file or
+// on an error, which is written to error.
+bool readBlob(std::FILE* file, std::uint64_t& position, Blob& blob, std::string& error) {
+    std::uint8_t length[4];
+    std::size_t read = std::fread(length, 1, 4, file);
+    if (read == 0 && std::feof(file)) {
+        return false;
+    }
+    std::uint32_t headerSize = static_cast<std::uint32_t>(length[0]) << 24 | length[1] << 16 | length[2] << 8 | length[3];
+    if (read != 4 || headerSize > MaxHeaderSize) {
+        error = "bad blob header";
+        return false;
+    }
+    std::vector<std::uint8_t> header(headerSize);
+    if (std::fread(header.data(), 1, headerSize, file) != headerSize) {
+        error = "truncated blob header";
+        return false;
+    }
+    ProtoReader reader(header.data(), header.size());
+    std::uint32_t field, wireType;
+    std::uint64_t dataSize = 0;
+    bool isData = false;
+    while (reader.next(field, wireType)) {
+        if (field == 1 && wireType == 2) {
+            ProtoReader type = reader.bytes();
+            isData = type.size() == 7 && std::memcmp(type.data(), "OSMData", 7) == 0;
+        } else if (field == 3 && wireType == 0) {
+            dataSize = reader.varint();
+        } else {
+            reader.skip(wireType);
+        }
+    }
+    if (reader.failed() || dataSize > MaxBlobSize) {
+        error = "bad blob header";
+        return false;
+    }
+    blob.offset = position;
+    blob.isData = isData;
+    blob.data.resize(static_cast<std::size_t>(dataSize));
+    if (std::fread(blob.data.data(), 1, blob.data.size(), file) != blob.data.size()) {
+        error = "truncated blob";
+        return false;
+    }
+    position += 4 + headerSize + dataSize;
+    return true;
+}
+
+// Unpacks a Blob message into the PrimitiveBlock it holds.
+bool inflateBlob(const Blob& blob, std::vector<std::uint8_t>& block, std::string& error) {
+    ProtoReader reader(blob.data.data(), blob.data.size());
+    std::uint32_t field, wireType;
+    std::uint64_t rawSize = 0;
+    ProtoReader raw, zlibData;
+    bool hasRaw = false, hasZlib = false, hasOther = false;
+    while (reader.next(field, wireType)) {
+        if (field == 1 && wireType == 2) {
+            raw = reader.bytes();
+            hasRaw = true;
+        } else if (field == 2 && wireType == 0) {
+            rawSize = reader.varint();
+        } else if (field == 3 && wireType == 2) {
+            zlibData = reader.bytes();
+            hasZlib = true;
+        } else {
+            hasOther = hasOther || wireType == 2;
+            reader.skip(wireType);
+        }
+    }
+    if (reader.failed()) {
+        error = "bad blob";
+        return false;
+    }
+    if (hasRaw) {
+        block.assign(raw.data(), raw.data() + raw.size());
+        return true;
+    }
+    if (!hasZlib) {
+        error = hasOther ? "blob compressed with something other than zlib" : "empty blob";
+        return false;
+    }
+#ifdef GRAPH_HAVE_ZLIB
+    if (rawSize > MaxBlobSize) {
+        error = "blob too large";
+        return false;
+    }
+    block.resize(static_cast<std::size_t>(rawSize));
+    uLongf size = static_cast<uLongf>(rawSize);
+    if (uncompress(block.data(), &size, zlibData.data(), static_cast<uLong>(zlibData.size())) != Z_OK ||
+        size != rawSize) {
+        error = "corrupt zlib data";
+        return false;
+    }
+    return true;
+#else
+    (void)rawSize;
+    error = "blob is zlib compressed, but this build has no zlib (GRAPH_HAVE_ZLIB)";
+    return false;
+#endif
+}
+
+// The parts of a PrimitiveBlock both passes need.
+struct PrimitiveBlock {
+    std::vector<ProtoReader> strings;
+    std::vector<ProtoReader> groups;
+    std::int64_t granularity = 100;
+    std::int64_t latOffset = 0, lonOffset = 0;
+};
+
+bool parseBlock(const std::vector<std::uint8_t>& data, PrimitiveBlock& block) {
+    ProtoReader reader(data.data(), data.size());
+    std::uint32_t field, wireType;
+    while (reader.next(field, wireType)) {
+        if (field == 1 && wireType == 2) {
+            ProtoReader table = reader.bytes();
+            std::uint32_t entry, entryType;
+            while (table.next(entry, entryType)) {
+                if (entry == 1 && entryType == 2) {
+                    block.strings.push_back(table.bytes());
+                } else {
+                    table.skip(entryType);
+                }
+            }
+            if (table.failed()) {
+                return false;
+            }
+        } else if (field == 2 && wireType == 2) {
+            block.groups.push_back(reader.bytes());
+        } else if (field == 17 && wireType == 0) {
+            block.granularity = static_cast<std::int64_t>(reader.varint());
+        } else if (field == 19 && wireType == 0) {
+            block.latOffset = static_cast<std::int64_t>(reader.varint());
+        } else if (field == 20 && wireType == 0) {
+            block.lonOffset = static_cast<std::int64_t>(reader.varint());
+        } else {
+            reader.skip(wireType);
+        }
+    }
+    return !reader.failed();
+}
+
+bool stringEquals(const ProtoReader& string, const char* text) {
+    std::size_t length = std::strlen(text);
+    return string.size() == length && std::memcmp(string.data(), text, length) == 0;
+}
+
+// Ways a block adds in the ways pass.
+struct WaysResult {
+    OsmWays ways;
+    bool hasNodes = false;
+};
+
+bool decodeWays(const std::vector<std::uint8_t>& data, const OsmImportOptions& options, WaysResult& result) {
+    PrimitiveBlock block;
+    if (!parseBlock(data, block)) {
+        return false;
+    }
+    // Tags are indexes into the block's string table, so the filter is worked out per string
+    const std::uint32_t None = 0xFFFFFFFFu;
+    std::uint32_t highwayKey = None, areaKey = None, yes = None;
+    std::vector<char> imported(block.strings.size(), 0);
+    for (std::size_t i = 0; i < block.strings.size(); ++i) {
+        const ProtoReader& string = block.strings[i];
+        highwayKey = stringEquals(string, "highway") ? static_cast<std::uint32_t>(i) : highwayKey;
+        areaKey = stringEquals(string, "area") ? static_cast<std::uint32_t>(i) : areaKey;
+        yes = stringEquals(string, "yes") ? static_cast<std::uint32_t>(i) : yes;
+        imported[i] = isImportedHighway(options, reinterpret_cast<const char*>(string.data()), string.size());
+    }
+
+    OsmWays& ways = result.ways;
+    std::vector<std::uint32_t> keys, values;
+    for (ProtoReader group : block.groups) {
+        std::uint32_t field, wireType;
+        while (group.next(field, wireType)) {
+            if (field == 1 || field == 2) {
+                result.hasNodes = true;
+                group.skip(wireType);
+                continue;
+            }
+            if (field != 3 || wireType != 2 || highwayKey == None) {
+                group.skip(wireType);
+                continue;
+            }
+            ProtoReader way = group.bytes();
+            keys.clear();
+            values.clear();
+            std::size_t start = ways.refs.size();
+            std::int64_t ref = 0;
+            std::uint32_t wayField, wayType;
+            while (way.next(wayField, wayType)) {
+                if (wayField == 2) {
+                    forEachValue(way, wayType, [&keys](ProtoReader& r) { keys.push_back(static_cast<std::uint32_t>(r.varint())); });
+                } else if (wayField == 3) {
+                    forEachValue(way, wayType, [&values](ProtoReader& r) { values.push_back(static_cast<std::uint32_t>(r.varint())); });
+                } else if (wayField == 8) {
+                    // Node ids are delta coded
+                    forEachValue(way, wayType, [&ways, &ref](ProtoReader& r) { ways.refs.push_back(ref += r.svarint()); });
+                } else {
+                    way.skip(wayType);
+                }
+            }
+            bool highway = false, area = false;
+            for (std::size_t i = 0; i < keys.size() && i < values.size(); ++i) {
+                if (values[i] >= imported.size()) {
+                    continue;
+                }
+                highway = highway || (keys[i] == highwayKey && imported[values[i]]);
+                area = area || (keys[i] == areaKey && values[i] == yes);
+            }
+            if (way.failed() || !highway || area || ways.refs.size() - start < 2) {
+                ways.refs.resize(start);
+            } else {
+                ways.ends.push_back(ways.refs.size());
+            }
+        }
+        if (group.failed()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Degrees from a block's coordinates, which are in granularity steps of nanodegrees
+double toDegrees(const PrimitiveBlock& block, std::int64_t offset, std::int64_t value) {
+    return 1e-9 * static_cast<double>(offset + block.granularity * value);
+}
+
+// Fills in the wanted nodes of a block in the nodes pass. Each node id has its own
+// position in the arrays, so blocks decoded at the same time never write to the same one.
+bool decodeNodes(const std::vector<std::uint8_t>& data, OsmNodes& nodes, std::size_t& found) {
+    PrimitiveBlock block;
+    if (!parseBlock(data, block)) {
+        return false;
+    }
+    std::size_t hint = 0;
+    auto store = [&](std::int64_t id, std::int64_t lat, std::int64_t lon) {
+        std::ptrdiff_t position = nodes.find(id, hint);
+        if (position >= 0 && !nodes.found[position]) {
+            nodes.lat[position] = toDegrees(block, block.latOffset, lat);
+            nodes.lon[position] = toDegrees(block, block.lonOffset, lon);
+            nodes.found[position] = 1;
+            ++found;
+        }
+    };
+
+    for (ProtoReader group : block.groups) {
+        std::uint32_t field, wireType;
+        while (group.next(field, wireType)) {
+            if (field == 2 && wireType == 2) {
+                // DenseNodes: ids, latitudes and longitudes in three delta coded arrays
+                ProtoReader dense = group.bytes();
+                ProtoReader ids, lats, lons;
+                std::uint32_t denseField, denseType;
+                while (dense.next(denseField, denseType)) {
+                    if (denseType == 2 && (denseField == 1 || denseField == 8 || denseField == 9)) {
+                        (denseField == 1 ? ids : denseField == 8 ? lats : lons) = dense.bytes();
+                    } else {
+                        dense.skip(denseType);
+                    }
+                }
+                std::int64_t id = 0, lat = 0, lon = 0;
+                while (!ids.atEnd() && !lats.atEnd() && !lons.atEnd()) {
+                    id += ids.svarint();
+                    lat += lats.svarint();
+                    lon += lons.svarint();
+                    store(id, lat, lon);
+                }
+                if (dense.failed() || ids.failed() || lats.failed() || lons.failed()) {
+                    return false;
+                }
+            } else if (field == 1 && wireType == 2) {
+                ProtoReader node = group.bytes();
+                std::int64_t id = 0, lat = 0, lon = 0;
+                std::uint32_t nodeField, nodeType;
+                while (node.next(nodeField, nodeType)) {
+                    if (nodeType == 0 && (nodeField == 1 || nodeField == 8 || nodeField == 9)) {
+                        (nodeField == 1 ? id : nodeField == 8 ? lat : lon) = node.svarint();
+                    } else {
+                        node.skip(nodeType);
+                    }
+                }
+                if (node.failed()) {
+                    return false;
+                }
+                store(id, lat, lon);
+            } else {
+                group.skip(wireType);
+            }
+        }
+        if (group.failed()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Reads data blobs in batches of a few per thread and decodes each batch in parallel with
+// decode(block, result), then hands the results to merge(blob, result) in file order and
+// calls report with the offset reached. Only one batch is in memory at a time. With
+// offsets, reads just the blobs starting there.
+template <typename Result, typename Decode, typename Merge, typename Report>
+bool decodeBlobs(const std::string& filename, const OsmImportOptions& options, const std::vector<std::uint64_t>* offsets,
+                 Decode decode, Merge merge, Report report) {
+    std::FILE* file = std::fopen(filename.c_str(), "rb");
+    if (!file) {
+        std::cerr << "Cannot open " << filename << std::endl;
+        return false;
+    }
+    unsigned threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<Blob> blobs(threads * 4);
+    std::vector<Result> results(blobs.size());
+    std::vector<std::string> errors(blobs.size());
+    std::uint64_t position = 0;
+    std::size_t nextOffset = 0;
+    std::string error;
+    bool done = false;
+    while (!done && error.empty()) {
+        // Read a batch; the header blob holds no data and is passed over
+        std::size_t count = 0;
+        while (count < blobs.size()) {
+            if (offsets) {
+                if (nextOffset == offsets->size()) {
+                    done = true;
+                    break;
+                }
+                position = (*offsets)[nextOffset++];
+                if (!seekFile(file, position)) {
+                    error = "cannot seek";
+                    break;
+                }
+            }
+            if (!readBlob(file, position, blobs[count], error)) {
+                done = true;
+                break;
+            }
+            count += blobs[count].isData ? 1 : 0;
+        }
+        if (!error.empty()) {
+            break;
+        }
+
+        std::atomic<std::size_t> nextBlob(0);
+        std::atomic<bool> failed(false);
+        auto work = [&]() {
+            std::vector<std::uint8_t> block;
+            for (std::size_t i = nextBlob++; i < count && !failed; i = nextBlob++) {
+                results[i] = Result();
+                errors[i].clear();
+                if (!inflateBlob(blobs[i], block, errors[i]) || !decode(block, results[i])) {
+                    if (errors[i].empty()) {
+                        errors[i] = "bad block";
+                    }
+                    failed = true;
+                }
+            }
+        };
+        std::vector<std::thread> workers;
+        for (unsigned i = 1; i < threads && i < count; ++i) {
+            workers.emplace_back(work);
+        }
+        work();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+
+        for (std::size_t i = 0; i < count && error.empty(); ++i) {
+            if (!errors[i].empty()) {
+                error = errors[i] + " at offset " + std::to_string(blobs[i].offset);
+            } else {
+                merge(blobs[i], results[i]);
+            }
+        }
+        report(position);
+    }
+    std::fclose(file);
+    if (!error.empty()) {
+        std::cerr << filename << ": " << error << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool readPbfWays(const std::string& filename, const OsmImportOptions& options, OsmWays& ways) {
+    PROFILE_SCOPE("readPbfWays");
+    std::uint64_t total = fileSize(filename);
+    bool ok = decodeBlobs<WaysResult>(
+        filename, options, nullptr,
+        [&options](const std::vector<std::uint8_t>& block, WaysResult& result) {
+            return decodeWays(block, options, result);
+        },
+        [&ways](const Blob& blob, const WaysResult& result) {
+            if (result.hasNodes) {
+                ways.nodeBlocks.push_back(blob.offset);
+            }
+            std::size_t base = ways.refs.size();
+            ways.refs.insert(ways.refs.end(), result.ways.refs.begin(), result.ways.refs.end());
+            for (std::size_t end : result.ways.ends) {
+                ways.ends.push_back(base + end);
+            }
+        },
+        [&](std::uint64_t position) { reportProgress(options, "ways", position, total, ways.ends.size(), 0); });
+    return ok;
+}
+
+bool readPbfNodes(const std::string& filename, const OsmImportOptions& options, const OsmWays& ways, OsmNodes& nodes) {
+    PROFILE_SCOPE("readPbfNodes");
+    std::uint64_t total = fileSize(filename);
+    std::size_t found = 0;
+    bool ok = decodeBlobs<std::size_t>(
+        filename, options, &ways.nodeBlocks,
+        [&nodes](const std::vector<std::uint8_t>& block, std::size_t& blockFound) {
+            return decodeNodes(block, nodes, blockFound);
+        },
+        [&found](const Blob&, std::size_t blockFound) { found += blockFound; },
+        [&](std::uint64_t position) {
+            // Blocks after the last one holding nodes are never read
+            bool finished = ways.nodeBlocks.empty() || position > ways.nodeBlocks.back();
+            reportProgress(options, "nodes", finished ? total : position, total, ways.ends.size(), found);
+        });
+    return ok;
+}
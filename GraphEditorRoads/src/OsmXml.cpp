@@ -0,0 +1,292 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "OsmReader.h"
+#include "Profiler.h"
+
+namespace {
+
+// Reads the tags of an XML file one at a time through a fixed buffer, ignoring text. It
+// knows just enough XML for OSM files: attributes, empty tags, comments and declarations.
+class XmlScanner {
+public:
+    struct Attribute {
+        const char* name;
+        std::size_t nameLength;
+        const char* value;
+        std::size_t valueLength;
+    };
+
+    XmlScanner(std::FILE* file, const std::string& filename)
+        : file(file), filename(filename), buffer(BufferSize), begin(0), end(0), offset(0) {}
+
+    // Moves to the next start, empty or end tag. Returns false at the end of the file or
+    // on an error, which is reported.
+    bool next() {
+        for (;;) {
+            const char* start = static_cast<const char*>(std::memchr(buffer.data() + begin, '<', end - begin));
+            if (!start) {
+                offset += end - begin;
+                begin = end;
+                if (!fill()) {
+                    return false;
+                }
+                continue;
+            }
+            offset += start - (buffer.data() + begin);
+            begin = start - buffer.data();
+
+            std::size_t close = findClose();
+            if (close == 0) {
+                if (!fill()) {
+                    if (!broken) {
+                        std::cerr << filename << " ends inside a tag" << std::endl;
+                        broken = true;
+                    }
+                    return false;
+                }
+                continue;
+            }
+            bool parsed = parse(buffer.data() + begin, buffer.data() + close);
+            offset += close + 1 - begin;
+            begin = close + 1;
+            if (parsed) {
+                return true;
+            }
+        }
+    }
+
+    bool failed() const { return broken || std::ferror(file); }
+
+    // Offset of the byte after the current tag
+    std::uint64_t position() const { return offset; }
+
+    bool is(const char* tag) const {
+        return nameLength == std::strlen(tag) && std::memcmp(name, tag, nameLength) == 0;
+    }
+    bool isEndTag() const { return endTag; }
+    bool isEmptyTag() const { return emptyTag; }
+
+    // Finds an attribute of the current tag; the value is not unescaped.
+    const Attribute* attribute(const char* key) const {
+        std::size_t length = std::strlen(key);
+        for (const Attribute& attribute : attributes) {
+            if (attribute.nameLength == length && std::memcmp(attribute.name, key, length) == 0) {
+                return &attribute;
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    static const std::size_t BufferSize = 1 << 20;
+
+    // Moves what is left to the front of the buffer and reads more after it.
+    bool fill() {
+        if (begin == 0 && end == buffer.size()) {
+            std::cerr << filename << ": tag longer than " << BufferSize << " bytes" << std::endl;
+            broken = true;
+            return false;
+        }
+        std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+        end -= begin;
+        begin = 0;
+        std::size_t read = std::fread(buffer.data() + end, 1, buffer.size() - end, file);
+        end += read;
+        return read > 0;
+    }
+
+    // Position of the '>' closing the tag at begin, or 0 if it is not in the buffer yet.
+    // Quoted attribute values may hold '>', and comments may hold anything.
+    std::size_t findClose() const {
+        const char* text = buffer.data();
+        if (end - begin >= 4 && std::memcmp(text + begin, "<!--", 4) == 0) {
+            for (std::size_t i = begin + 4; i + 2 < end; ++i) {
+                if (text[i] == '-' && text[i + 1] == '-' && text[i + 2] == '>') {
+                    return i + 2;
+                }
+            }
+            return 0;
+        }
+        char quote = 0;
+        for (std::size_t i = begin + 1; i < end; ++i) {
+            char c = text[i];
+            if (quote) {
+                quote = c == quote ? 0 : quote;
+            } else if (c == '"' || c == '\'') {
+                quote = c;
+            } else if (c == '>') {
+                return i;
+            }
+        }
+        return 0;
+    }
+
+    // Splits the tag between '<' and '>' into its name and attributes. Returns false for
+    // comments and declarations.
+    bool parse(const char* text, const char* close) {
+        if (text[1] == '!' || text[1] == '?') {
+            return false;
+        }
+        endTag = text[1] == '/';
+        emptyTag = close[-1] == '/';
+        const char* cursor = text + (endTag ? 2 : 1);
+        if (emptyTag) {
+            --close;
+        }
+        name = cursor;
+        while (cursor < close && !isSpace(*cursor)) {
+            ++cursor;
+        }
+        nameLength = cursor - name;
+
+        attributes.clear();
+        for (;;) {
+            while (cursor < close && isSpace(*cursor)) {
+                ++cursor;
+            }
+            const char* key = cursor;
+            while (cursor < close && *cursor != '=' && !isSpace(*cursor)) {
+                ++cursor;
+            }
+            std::size_t keyLength = cursor - key;
+            while (cursor < close && (*cursor == '=' || isSpace(*cursor))) {
+                ++cursor;
+            }
+            if (keyLength == 0 || cursor >= close || (*cursor != '"' && *cursor != '\'')) {
+                break;
+            }
+            char quote = *cursor++;
+            const char* value = cursor;
+            while (cursor < close && *cursor != quote) {
+                ++cursor;
+            }
+            attributes.push_back({key, keyLength, value, static_cast<std::size_t>(cursor - value)});
+            ++cursor;
+        }
+        return true;
+    }
+
+    static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+    std::FILE* file;
+    const std::string& filename;
+    std::vector<char> buffer;
+    // The unread part of the buffer
+    std::size_t begin, end;
+    // Offset in the file of buffer[begin]
+    std::uint64_t offset;
+    bool broken = false;
+
+    const char* name = nullptr;
+    std::size_t nameLength = 0;
+    bool endTag = false, emptyTag = false;
+    std::vector<Attribute> attributes;
+};
+
+bool equals(const XmlScanner::Attribute* attribute, const char* text) {
+    return attribute && attribute->valueLength == std::strlen(text) &&
+           std::memcmp(attribute->value, text, attribute->valueLength) == 0;
+}
+
+// Attribute values end in their quote, which stops strtoll and strtod.
+std::int64_t toInteger(const XmlScanner::Attribute* attribute) {
+    return attribute ? std::strtoll(attribute->value, nullptr, 10) : 0;
+}
+
+double toDouble(const XmlScanner::Attribute* attribute) {
+    return attribute ? std::strtod(attribute->value, nullptr) : 0.0;
+}
+
+const std::uint64_t ProgressInterval = 16 << 20;
+
+} // namespace
+
+bool readXmlWays(const std::string& filename, const OsmImportOptions& options, OsmWays& ways) {
+    PROFILE_SCOPE("readXmlWays");
+    std::FILE* file = std::fopen(filename.c_str(), "rb");
+    if (!file) {
+        std::cerr << "Cannot open " << filename << std::endl;
+        return false;
+    }
+    std::uint64_t total = fileSize(filename), reported = 0;
+    XmlScanner scanner(file, filename);
+    bool inWay = false, highway = false, area = false;
+    std::size_t wayStart = 0;
+    while (scanner.next()) {
+        if (scanner.is("node")) {
+            ways.nodesEnd = scanner.position();
+        } else if (scanner.is("way")) {
+            if (!scanner.isEndTag()) {
+                inWay = true;
+                highway = area = false;
+                wayStart = ways.refs.size();
+            }
+            if (scanner.isEndTag() || scanner.isEmptyTag()) {
+                if (inWay && highway && !area && ways.refs.size() - wayStart >= 2) {
+                    ways.ends.push_back(ways.refs.size());
+                } else {
+                    ways.refs.resize(wayStart);
+                }
+                inWay = false;
+            }
+        } else if (inWay && scanner.is("nd")) {
+            ways.refs.push_back(toInteger(scanner.attribute("ref")));
+        } else if (inWay && scanner.is("tag")) {
+            const XmlScanner::Attribute* key = scanner.attribute("k");
+            const XmlScanner::Attribute* value = scanner.attribute("v");
+            if (equals(key, "highway") && value) {
+                highway = isImportedHighway(options, value->value, value->valueLength);
+            } else if (equals(key, "area")) {
+                area = equals(value, "yes");
+            }
+        }
+        if (scanner.position() - reported >= ProgressInterval) {
+            reported = scanner.position();
+            reportProgress(options, "ways", reported, total, ways.ends.size(), 0);
+        }
+    }
+    bool failed = scanner.failed();
+    std::fclose(file);
+    if (failed) {
+        std::cerr << "Failed reading " << filename << std::endl;
+        return false;
+    }
+    reportProgress(options, "ways", total, total, ways.ends.size(), 0);
+    return true;
+}
+
+bool readXmlNodes(const std::string& filename, const OsmImportOptions& options, const OsmWays& ways, OsmNodes& nodes) {
+    PROFILE_SCOPE("readXmlNodes");
+    std::FILE* file = std::fopen(filename.c_str(), "rb");
+    if (!file) {
+        std::cerr << "Cannot open " << filename << std::endl;
+        return false;
+    }
+    std::uint64_t total = fileSize(filename), reported = 0;
+    XmlScanner scanner(file, filename);
+    std::size_t hint = 0, found = 0;
+    while (scanner.position() < ways.nodesEnd && scanner.next()) {
+        if (scanner.is("node") && !scanner.isEndTag()) {
+            std::ptrdiff_t position = nodes.find(toInteger(scanner.attribute("id")), hint);
+            if (position >= 0 && !nodes.found[position]) {
+                nodes.lat[position] = toDouble(scanner.attribute("lat"));
+                nodes.lon[position] = toDouble(scanner.attribute("lon"));
+                nodes.found[position] = 1;
+                ++found;
+            }
+        }
+        if (scanner.position() - reported >= ProgressInterval) {
+            reported = scanner.position();
+            reportProgress(options, "nodes", reported, total, ways.ends.size(), found);
+        }
+    }
+    bool failed = scanner.failed();
+    std::fclose(file);
+    if (failed) {
+        std::cerr << "Failed reading " << filename << std::endl;
+        return false;
+    }
+    reportProgress(options, "nodes", total, total, ways.ends.size(), found);
+    return true;
+}
@@ -0,0 +1,195 @@
+#include "Polygon.h"
+#include <algorithm>
+#include <limits>
+
+Polygon::Polygon() {
+    clear();
+}
+
+Polygon::Polygon(const std::vector<Point>& points) {
+    assign(points.data(), points.size());
+}
+
+Polygon::Polygon(const Point* points, std::size_t count) {
+    assign(points, count);
+}
+
+void Polygon::assign(const Point* points, std::size_t count) {
+    if (count > 1 && points[count - 1].x == points[0].x && points[count - 1].y == points[0].y) {
+        --count;
+    }
+    if (count == 0) {
+        clear();
+        return;
+    }
+    // Written in place rather than through addPoint, as outlines are rebuilt many times over
+    xs.resize(count + 1);
+    ys.resize(count + 1);
+    bounds = {points[0].x, points[0].y, points[0].x, points[0].y};
+    for (std::size_t i = 0; i < count; ++i) {
+        xs[i] = points[i].x;
+        ys[i] = points[i].y;
+        bounds = AABB::merge(bounds, {points[i].x, points[i].y, points[i].x, points[i].y});
+    }
+    xs[count] = xs[0];
+    ys[count] = ys[0];
+}
+
+void Polygon::addPoint(float x, float y) {
+    // Overwrite the repeated first vertex, then repeat it again after the new one.
+    if (xs.empty()) {
+        xs = {x, x};
+        ys = {y, y};
+        bounds = {x, y, x, y};
+        return;
+    }
+    xs.back() = x;
+    ys.back() = y;
+    xs.push_back(xs[0]);
+    ys.push_back(ys[0]);
+    bounds = AABB::merge(bounds, {x, y, x, y});
+}
+
+void Polygon::clear() {
+    xs.clear();
+    ys.clear();
+    float inf = std::numeric_limits<float>::infinity();
+    bounds = {inf, inf, -inf, -inf};
+}
+
+// Casts a ray towards +x and counts the edges it crosses. The division in the usual
+// intercept test is replaced by a cross product, and the count is accumulated without
+// branches so the loop vectorizes.
+bool Polygon::contains(float x, float y) const {
+    if (!bounds.contains(x, y)) {
+        return false;
+    }
+    const float* px = xs.data();
+    const float* py = ys.data();
+    std::size_t n = size();
+    unsigned crossings = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        float xi = px[i], yi = py[i], xj = px[i + 1], yj = py[i + 1];
+        bool straddles = (yi > y) != (yj > y);
+        float side = (xj - xi) * (y - yi) - (x - xi) * (yj - yi);
+        crossings += straddles & ((side > 0) == (yj > yi));
+    }
+    return crossings & 1;
+}
+
+// A point is inside a convex polygon when it lies on the same side of every edge. Edges
+// of zero length, as outlines of very short roads have, take no side.
+bool Polygon::containsStrictly(float x, float y) const {
+    if (!bounds.contains(x, y)) {
+        return false;
+    }
+    const float* px = xs.data();
+    const float* py = ys.data();
+    std::size_t n = size();
+    bool positive = false, negative = false, onEdge = false;
+    for (std::size_t i = 0; i < n; ++i) {
+        float ex = px[i + 1] - px[i], ey = py[i + 1] - py[i];
+        float side = ex * (y - py[i]) - ey * (x - px[i]);
+        float length = ex * ex + ey * ey;
+        bool near = side * side <= 1e-6f * length;
+        onEdge |= near & (length > 0);
+        positive |= !near & (side > 0);
+        negative |= !near & (side < 0);
+    }
+    return !onEdge && !(positive && negative);
+}
+
+// Walks the edges in the outer loop and the points in the inner one, which runs over
+// contiguous arrays with no branches. Points go in blocks small enough to stay in
+// cache while every edge passes over them.
+void Polygon::contains(const float* x, const float* y, std::size_t count, std::uint8_t* inside) const {
+    static const std::size_t BlockSize = 512;
+    std::fill(inside, inside + count, 0);
+    const float* px = xs.data();
+    const float* py = ys.data();
+    std::size_t n = size();
+    for (std::size_t first = 0; first < count; first += BlockSize) {
+        std::size_t last = std::min(first + BlockSize, count);
+        for (std::size_t i = 0; i < n; ++i) {
+            float xi = px[i], yi = py[i], xj = px[i + 1], yj = py[i + 1];
+            float dx = xj - xi, dy = yj - yi;
+            bool upward = yj > yi;
+            for (std::size_t k = first; k < last; ++k) {
+                bool straddles = (yi > y[k]) != (yj > y[k]);
+                float side = dx * (y[k] - yi) - (x[k] - xi) * dy;
+                inside[k] ^= static_cast<std::uint8_t>(straddles & ((side > 0) == upward));
+            }
+        }
+    }
+}
+
+bool Polygon::crossesEdges(float ax, float ay, float bx, float by) const {
+    const float* px = xs.data();
+    const float* py = ys.data();
+    std::size_t n = size();
+    float dx = bx - ax, dy = by - ay;
+    bool any = false;
+    for (std::size_t i = 0; i < n; ++i) {
+        float xi = px[i], yi = py[i], xj = px[i + 1], yj = py[i + 1];
+        // The edge's end points lie on opposite sides of the segment and the other way round.
+        float d1 = dx * (yi - ay) - dy * (xi - ax);
+        float d2 = dx * (yj - ay) - dy * (xj - ax);
+        float ex = xj - xi, ey = yj - yi;
+        float d3 = ex * (ay - yi) - ey * (ax - xi);
+        float d4 = ex * (by - yi) - ey * (bx - xi);
+        any |= (d1 * d2 <= 0) & (d3 * d4 <= 0) & ((d1 != 0) | (d2 != 0) | (d3 != 0) | (d4 != 0));
+    }
+    return any;
+}
+
+bool Polygon::intersects(const Point& a, const Point& b) const {
+    if (empty()) {
+        return false;
+    }
+    AABB segment = {std::min(a.x, b.x), std::min(a.y, b.y), std::max(a.x, b.x), std::max(a.y, b.y)};
+    if (!bounds.overlaps(segment)) {
+        return false;
+    }
+    // A segment that crosses no edge is either wholly inside or wholly outside.
+    return crossesEdges(a.x, a.y, b.x, b.y) || contains(a);
+}
+
+bool Polygon::overlaps(const Polygon& other) const {
+    if (empty() || other.empty() || !bounds.overlaps(other.bounds)) {
+        return false;
+    }
+    // Walk the edges of the polygon with fewer of them against the other one.
+    const Polygon& fewer = size() <= other.size() ? *this : other;
+    const Polygon& more = size() <= other.size() ? other : *this;
+    for (std::size_t i = 0; i < fewer.size(); ++i) {
+        float ax = fewer.xs[i], ay = fewer.ys[i], bx = fewer.xs[i + 1], by = fewer.ys[i + 1];
+        AABB edge = {std::min(ax, bx), std::min(ay, by), std::max(ax, bx), std::max(ay, by)};
+        if (more.bounds.overlaps(edge) && more.crossesEdges(ax, ay, bx, by)) {
+            return true;
+        }
+    }
+    // No edges cross, so either one polygon holds the other or they are apart.
+    return contains(other.xs[0], other.ys[0]) || other.contains(xs[0], ys[0]);
+}
+
+bool Polygon::crossEdge(std::size_t i, const Point& c, const Point& d, float& alongEdge, float& alongOther) const {
+    float px = xs[i], py = ys[i];
+    float rx = xs[i + 1] - px, ry = ys[i + 1] - py;
+    float sx = d.x - c.x, sy = d.y - c.y;
+    float denominator = rx * sy - ry * sx;
+    if (denominator == 0.0f) {
+        return false;
+    }
+    float cx = c.x - px, cy = c.y - py;
+    alongEdge = (cx * sy - cy * sx) / denominator;
+    alongOther = (cx * ry - cy * rx) / denominator;
+    return true;
+}
+
+float Polygon::area() const {
+    float sum = 0;
+    for (std::size_t i = 0; i < size(); ++i) {
+        sum += xs[i] * ys[i + 1] - xs[i + 1] * ys[i];
+    }
+    return sum / 2.0f;
+}
@@ -0,0 +1,144 @@
+#include "Profiler.h"
+
+#ifdef GRAPH_ENABLE_PROFILER
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler() : frameStart(now()) {}
+
+std::int64_t Profiler::now() {
+    // Relative to the first call, so traces start near zero
+    static const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+// The buffer is shared with the profiler so its scopes outlive the thread that recorded them.
+Profiler::ThreadBuffer& Profiler::threadBuffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        buffer = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(mutex);
+        buffer->thread = static_cast<unsigned>(buffers.size());
+        buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+void Profiler::record(const char* name, std::int64_t start, std::int64_t end) {
+    ThreadBuffer& buffer = threadBuffer();
+    // Only contended while a trace is being written
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (buffer.scopes.size() >= MaxScopesPerThread) {
+        ++buffer.dropped;
+        return;
+    }
+    buffer.scopes.push_back({name, start, end - start});
+}
+
+void Profiler::beginFrame() {
+    std::int64_t start = now();
+    std::lock_guard<std::mutex> lock(mutex);
+    frameStart = start;
+}
+
+void Profiler::endFrame() {
+    std::int64_t end = now();
+    ThreadBuffer& buffer = threadBuffer();
+    std::vector<PhaseTime> phases;
+    {
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        for (std::size_t i = buffer.firstInFrame; i < buffer.scopes.size(); ++i) {
+            const Scope& scope = buffer.scopes[i];
+            auto phase = std::find_if(phases.begin(), phases.end(),
+                                      [&scope](const PhaseTime& time) {
+                                          return time.name == scope.name || std::strcmp(time.name, scope.name) == 0;
+                                      });
+            if (phase == phases.end()) {
+                phases.push_back({scope.name, 0.0, 0});
+                phase = phases.end() - 1;
+            }
+            phase->milliseconds += scope.duration / 1e6;
+            ++phase->calls;
+        }
+        buffer.firstInFrame = buffer.scopes.size();
+    }
+    std::sort(phases.begin(), phases.end(),
+              [](const PhaseTime& a, const PhaseTime& b) { return a.milliseconds > b.milliseconds; });
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (frameTimes.size() == FrameHistory) {
+        frameTimes.erase(frameTimes.begin());
+    }
+    frameTimes.push_back((end - frameStart) / 1e6);
+    lastFrame = std::move(phases);
+}
+
+std::vector<double> Profiler::getFrameTimes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return frameTimes;
+}
+
+std::vector<Profiler::PhaseTime> Profiler::getLastFrame() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lastFrame;
+}
+
+// Scope names are identifiers and fixed strings, but quotes and backslashes are escaped anyway.
+static void writeName(std::FILE* file, const char* name) {
+    std::fputc('"', file);
+    for (const char* c = name; *c; ++c) {
+        if (*c == '"' || *c == '\\') {
+            std::fputc('\\', file);
+        }
+        std::fputc(*c, file);
+    }
+    std::fputc('"', file);
+}
+
+bool Profiler::writeChromeTrace(const std::string& filename) const {
+    std::FILE* file = std::fopen(filename.c_str(), "w");
+    if (!file) {
+        std::cerr << "Cannot write profile to " << filename << std::endl;
+        return false;
+    }
+    std::vector<std::shared_ptr<ThreadBuffer>> threads;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        threads = buffers;
+    }
+
+    // Complete events ("ph":"X") with times in microseconds
+    std::fputs("{\"traceEvents\":[", file);
+    bool first = true;
+    for (const std::shared_ptr<ThreadBuffer>& buffer : threads) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        for (const Scope& scope : buffer->scopes) {
+            std::fputs(first ? "\n{\"name\":" : ",\n{\"name\":", file);
+            writeName(file, scope.name);
+            std::fprintf(file, ",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", buffer->thread,
+                         scope.start / 1e3, scope.duration / 1e3);
+            first = false;
+        }
+        if (buffer->dropped > 0) {
+            std::cerr << "Profiler dropped " << buffer->dropped << " scopes on thread " << buffer->thread << std::endl;
+        }
+    }
+    std::fputs("\n],\"displayTimeUnit\":\"ms\"}\n", file);
+
+    bool written = !std::ferror(file);
+    written = std::fclose(file) == 0 && written;
+    if (!written) {
+        std::cerr << "Failed writing profile to " << filename << std::endl;
+    }
+    return written;
+}
+
+#endif // GRAPH_ENABLE_PROFILER
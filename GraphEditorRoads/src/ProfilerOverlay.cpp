@@ -0,0 +1,67 @@
+#include "ProfilerOverlay.h"
+
+#ifdef GRAPH_ENABLE_PROFILER
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+// Size of the overlay in pixels, and the frame time shown at the graph's full height
+static const float Width = 320.0f;
+static const float GraphHeight = 60.0f;
+static const double GraphMilliseconds = 33.3;
+
+ProfilerOverlay::ProfilerOverlay() : graph(sf::Lines), visible(true) {
+    font.loadFromFile("res/font.ttf");
+    text.setFont(font);
+    text.setCharacterSize(14);
+    text.setFillColor(sf::Color::White);
+    background.setFillColor(sf::Color(0, 0, 0, 160));
+}
+
+void ProfilerOverlay::draw(sf::RenderTarget& target) {
+    if (!visible) {
+        return;
+    }
+    Profiler& profiler = Profiler::instance();
+    std::vector<double> frames = profiler.getFrameTimes();
+    std::vector<Profiler::PhaseTime> phases = profiler.getLastFrame();
+
+    double average = 0.0, worst = 0.0;
+    for (double frame : frames) {
+        average += frame;
+        worst = std::max(worst, frame);
+    }
+    average = frames.empty() ? 0.0 : average / frames.size();
+
+    char line[128];
+    std::snprintf(line, sizeof(line), "frame %.2f ms avg, %.2f ms worst\n", average, worst);
+    std::string lines = line;
+    for (std::size_t i = 0; i < phases.size() && i < ShownPhases; ++i) {
+        std::snprintf(line, sizeof(line), "%8.3f ms %4u x  %s\n", phases[i].milliseconds, phases[i].calls, phases[i].name);
+        lines += line;
+    }
+    text.setString(lines);
+
+    // One bar per frame, newest on the right, turning red past the top of the graph
+    float left = 10.0f, top = 10.0f;
+    float barWidth = Width / Profiler::FrameHistory;
+    graph.clear();
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        float x = left + Width - (frames.size() - i) * barWidth;
+        float height = static_cast<float>(std::min(frames[i] / GraphMilliseconds, 1.0) * GraphHeight);
+        sf::Color color = frames[i] > GraphMilliseconds ? sf::Color::Red : sf::Color::Green;
+        graph.append(sf::Vertex(sf::Vector2f(x, top + GraphHeight), color));
+        graph.append(sf::Vertex(sf::Vector2f(x, top + GraphHeight - height), color));
+    }
+    text.setPosition(left, top + GraphHeight + 4.0f);
+
+    sf::FloatRect bounds = text.getGlobalBounds();
+    background.setPosition(left - 4.0f, top - 4.0f);
+    background.setSize(sf::Vector2f(std::max(Width, bounds.width) + 8.0f, GraphHeight + 12.0f + bounds.height));
+    target.draw(background);
+    target.draw(graph);
+    target.draw(text);
+}
+
+#endif // GRAPH_ENABLE_PROFILER
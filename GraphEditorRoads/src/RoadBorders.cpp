@@ -0,0 +1,250 @@
+#include "RoadBorders.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include "Constants.h"
+#include "Profiler.h"
+
+bool RoadBorders::buildOutline(const Graph& graph, std::uint32_t slot, Outline& outline) const {
+    const Segment* segment = graph.segments.getByIndex(slot);
+    if (!segment || slot >= graph.segmentEnvelopes.size()) {
+        return false;
+    }
+    const Envelope* envelope = graph.roadEnvelopes.get(graph.segmentEnvelopes[slot]);
+    if (!envelope) {
+        return false;
+    }
+    outline.slot = slot;
+    envelope->getOutline(graph.vertices, outline.polygon);
+    return true;
+}
+
+void RoadBorders::rebuild(const Graph& graph) {
+    PROFILE_SCOPE("RoadBorders::rebuild");
+    edges.assign(graph.segments.capacity(), std::vector<BorderEdge>());
+    bounds.assign(graph.segments.capacity(), AABB());
+    hasBounds.assign(graph.segments.capacity(), false);
+    edgeCount = 0;
+    recomputed = 0;
+    for (std::uint32_t slot = 0; slot < graph.segments.capacity(); ++slot) {
+        recompute(graph, slot);
+    }
+}
+
+void RoadBorders::update(const Graph& graph, const std::vector<std::uint32_t>& changedSegments) {
+    PROFILE_SCOPE("RoadBorders::update");
+    if (edges.size() < graph.segments.capacity()) {
+        edges.resize(graph.segments.capacity());
+        bounds.resize(graph.segments.capacity());
+        hasBounds.resize(graph.segments.capacity(), false);
+    }
+    recomputed = 0;
+
+    // The pieces of a neighbour only change where the edited envelope was or now is.
+    std::vector<std::uint32_t> affected;
+    for (std::uint32_t slot : changedSegments) {
+        if (slot >= edges.size()) {
+            continue;
+        }
+        affected.push_back(slot);
+        auto collect = [&](const AABB& area) {
+            graph.segmentIndex.query(area, [&](int id) {
+                affected.push_back(static_cast<std::uint32_t>(id));
+                return true;
+            });
+        };
+        if (hasBounds[slot]) {
+            collect(bounds[slot]);
+        }
+        if (buildOutline(graph, slot, self)) {
+            collect(self.polygon.getBounds());
+        }
+    }
+    std::sort(affected.begin(), affected.end());
+    affected.erase(std::unique(affected.begin(), affected.end()), affected.end());
+    for (std::uint32_t slot : affected) {
+        if (slot < edges.size()) {
+            recompute(graph, slot);
+        }
+    }
+}
+
+// Cuts a slot's outline against every overlapping envelope and keeps what lies outside them.
+void RoadBorders::recompute(const Graph& graph, std::uint32_t slot) {
+    ++recomputed;
+    edgeCount -= edges[slot].size();
+    edges[slot].clear();
+    hasBounds[slot] = false;
+
+    if (!buildOutline(graph, slot, self)) {
+        return;
+    }
+    const AABB& selfBounds = self.polygon.getBounds();
+    bounds[slot] = selfBounds;
+    hasBounds[slot] = true;
+
+    neighbourCount = 0;
+    graph.segmentIndex.query(selfBounds, [&](int id) {
+        if (static_cast<std::uint32_t>(id) != slot) {
+            if (neighbourCount == neighbours.size()) {
+                neighbours.emplace_back();
+            }
+            Outline& other = neighbours[neighbourCount];
+            if (buildOutline(graph, id, other) && other.polygon.getBounds().overlaps(selfBounds)) {
+                ++neighbourCount;
+            }
+        }
+        return true;
+    });
+
+    for (std::size_t i = 0; i < self.polygon.size(); ++i) {
+        Point p = self.polygon.getPoint(i);
+        Point q = self.polygon.getPoint(i + 1);
+        if (p.x == q.x && p.y == q.y) {
+            continue;
+        }
+        AABB edgeBounds = {std::min(p.x, q.x), std::min(p.y, q.y), std::max(p.x, q.x), std::max(p.y, q.y)};
+
+        cuts.clear();
+        cuts.push_back({0.0f, p});
+        cuts.push_back({1.0f, q});
+        for (std::size_t n = 0; n < neighbourCount; ++n) {
+            const Outline& other = neighbours[n];
+            if (!other.polygon.getBounds().overlaps(edgeBounds)) {
+                continue;
+            }
+            for (std::size_t j = 0; j < other.polygon.size(); ++j) {
+                Point c = other.polygon.getPoint(j);
+                Point d = other.polygon.getPoint(j + 1);
+                if (std::max(c.x, d.x) < edgeBounds.minX || std::min(c.x, d.x) > edgeBounds.maxX ||
+                    std::max(c.y, d.y) < edgeBounds.minY || std::min(c.y, d.y) > edgeBounds.maxY) {
+                    continue;
+                }
+                // Both envelopes must agree on the crossing point to the bit so their
+                // pieces chain up, so it is always computed from the lower slot's edge.
+                float along, alongOther;
+                Point crossing;
+                if (slot < other.slot) {
+                    if (!self.polygon.crossEdge(i, c, d, along, alongOther)) continue;
+                    crossing = Point(p.x + along * (q.x - p.x), p.y + along * (q.y - p.y));
+                } else {
+                    if (!other.polygon.crossEdge(j, p, q, alongOther, along)) continue;
+                    crossing = Point(c.x + alongOther * (d.x - c.x), c.y + alongOther * (d.y - c.y));
+                }
+                // A crossing through the other outline's corner is counted once, by the edge it starts.
+                if (along > 0.0f && along < 1.0f && alongOther >= 0.0f && alongOther < 1.0f) {
+                    cuts.push_back({along, crossing});
+                }
+            }
+        }
+        std::sort(cuts.begin(), cuts.end(), [](const std::pair<float, Point>& a, const std::pair<float, Point>& b) {
+            return a.first < b.first;
+        });
+
+        for (std::size_t k = 0; k + 1 < cuts.size(); ++k) {
+            const Point& a = cuts[k].second;
+            const Point& b = cuts[k + 1].second;
+            if (a.x == b.x && a.y == b.y) {
+                continue;
+            }
+            Point middle((a.x + b.x) / 2.0f, (a.y + b.y) / 2.0f);
+            bool covered = false;
+            for (std::size_t n = 0; n < neighbourCount; ++n) {
+                if (neighbours[n].polygon.containsStrictly(middle.x, middle.y)) {
+                    covered = true;
+                    break;
+                }
+            }
+            if (!covered) {
+                edges[slot].push_back({a, b});
+            }
+        }
+    }
+    edgeCount += edges[slot].size();
+}
+
+const std::vector<BorderEdge>& RoadBorders::getEdges(std::uint32_t slot) const {
+    static const std::vector<BorderEdge> none;
+    return slot < edges.size() ? edges[slot] : none;
+}
+
+// Key of the snap tolerance sized cell holding a point. Pieces that meet share their
+// end point to the bit or to within rounding, so chaining looks in the neighbouring cells too.
+static std::uint64_t cellKey(std::int64_t x, std::int64_t y) {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) | static_cast<std::uint32_t>(y);
+}
+
+static std::int64_t cellOf(float coordinate) {
+    return static_cast<std::int64_t>(std::floor(coordinate / SNAP_TOLERANCE));
+}
+
+std::vector<std::vector<Point>> RoadBorders::getPolylines() const {
+    std::vector<const BorderEdge*> all;
+    all.reserve(edgeCount);
+    for (const auto& slotEdges : edges) {
+        for (const BorderEdge& edge : slotEdges) {
+            all.push_back(&edge);
+        }
+    }
+    std::unordered_multimap<std::uint64_t, std::size_t> starts, ends;
+    starts.reserve(all.size());
+    ends.reserve(all.size());
+    for (std::size_t i = 0; i < all.size(); ++i) {
+        starts.insert({cellKey(cellOf(all[i]->a.x), cellOf(all[i]->a.y)), i});
+        ends.insert({cellKey(cellOf(all[i]->b.x), cellOf(all[i]->b.y)), i});
+    }
+
+    // Finds a piece in the map whose point is within snap tolerance, preferring an exact match.
+    auto findNear = [&](const std::unordered_multimap<std::uint64_t, std::size_t>& map, const Point& point,
+                        bool atStart, const std::vector<bool>* used) -> std::size_t {
+        std::size_t best = all.size();
+        float bestDistance = SNAP_TOLERANCE * SNAP_TOLERANCE;
+        std::int64_t cx = cellOf(point.x), cy = cellOf(point.y);
+        for (std::int64_t x = cx - 1; x <= cx + 1; ++x) {
+            for (std::int64_t y = cy - 1; y <= cy + 1; ++y) {
+                auto range = map.equal_range(cellKey(x, y));
+                for (auto it = range.first; it != range.second; ++it) {
+                    if (used && (*used)[it->second]) continue;
+                    const Point& other = atStart ? all[it->second]->a : all[it->second]->b;
+                    float dx = other.x - point.x, dy = other.y - point.y;
+                    if (dx * dx + dy * dy <= bestDistance) {
+                        bestDistance = dx * dx + dy * dy;
+                        best = it->second;
+                    }
+                }
+            }
+        }
+        return best;
+    };
+
+    // Open chains are walked from a piece nothing leads into, so they come out whole.
+    std::vector<std::size_t> order;
+    order.reserve(all.size());
+    for (std::size_t i = 0; i < all.size(); ++i) {
+        if (findNear(ends, all[i]->a, false, nullptr) == all.size()) order.push_back(i);
+    }
+    for (std::size_t i = 0; i < all.size(); ++i) {
+        order.push_back(i);
+    }
+
+    std::vector<bool> used(all.size(), false);
+    std::vector<std::vector<Point>> polylines;
+    for (std::size_t first : order) {
+        if (used[first]) {
+            continue;
+        }
+        used[first] = true;
+        std::vector<Point> polyline = {all[first]->a, all[first]->b};
+        for (std::size_t next = findNear(starts, polyline.back(), true, &used); next < all.size();
+             next = findNear(starts, polyline.back(), true, &used)) {
+            used[next] = true;
+            polyline.push_back(all[next]->b);
+        }
+        float dx = polyline.back().x - polyline.front().x, dy = polyline.back().y - polyline.front().y;
+        if (dx * dx + dy * dy <= SNAP_TOLERANCE * SNAP_TOLERANCE) {
+            polyline.back() = polyline.front();
+        }
+        polylines.push_back(std::move(polyline));
+    }
+    return polylines;
+}
@@ -1,6 +1,7 @@
 #include "RoundedRectangleShape.h"
 #include <cmath>
 #include <iostream>
+#include <map>
 namespace sf
 {
 
@@ -47,6 +48,26 @@ std::size_t RoundedRectangleShape::getPointCount() const
     return myCornerPointCount*4;
 }
 
+const std::vector<Vector2f>& RoundedRectangleShape::getCornerDirections(unsigned int cornerPointCount)
+{
+    static std::map<unsigned int, std::vector<Vector2f>> tables;
+    std::vector<Vector2f>& directions = tables[cornerPointCount];
+    if (directions.empty() && cornerPointCount > 0)
+    {
+        static const float pi = 3.141592654f;
+        float deltaAngle = cornerPointCount > 1 ? 90.0f/(cornerPointCount-1) : 0.0f;
+        directions.resize(cornerPointCount*4);
+        for (std::size_t index = 0; index < directions.size(); ++index)
+        {
+            // Each corner starts where the previous one ended, a quarter turn further on.
+            std::size_t centerIndex = index/cornerPointCount;
+            float angle = deltaAngle*(index-centerIndex)*pi/180;
+            directions[index] = Vector2f(std::cos(angle), -std::sin(angle));
+        }
+    }
+    return directions;
+}
+
 sf::Vector2f RoundedRectangleShape::getPoint(std::size_t index) const{
     if (index >= myCornerPointCount * 4) {
         // This should actually never happen if the index is correct.
@@ -55,14 +76,8 @@ sf::Vector2f RoundedRectangleShape::getPoint(std::size_t index) const{
         return sf::Vector2f(0, 0);
     }
 
-    float deltaAngle = 90.0f/(myCornerPointCount-1);
     sf::Vector2f center;
     unsigned int centerIndex = index/myCornerPointCount;
-    static const float pi = 3.141592654f;
-    sf::Vector2f calculatedPoint = sf::Vector2f(myRadius * cos(deltaAngle * (index - centerIndex) * pi / 180) + center.x,
-                                                -myRadius * sin(deltaAngle * (index - centerIndex) * pi / 180) + center.y);
-    //std::cout << "Point " << index << ": " << calculatedPoint.x << ", " << calculatedPoint.y << std::endl;
-
     switch(centerIndex)
     {
         case 0: center.x = mySize.x - myRadius; center.y = myRadius; break;
@@ -71,7 +86,6 @@ sf::Vector2f RoundedRectangleShape::getPoint(std::size_t index) const{
         case 3: center.x = mySize.x - myRadius; center.y = mySize.y - myRadius; break;
     }
 
-    return sf::Vector2f(myRadius*cos(deltaAngle*(index-centerIndex)*pi/180)+center.x,
-                        -myRadius*sin(deltaAngle*(index-centerIndex)*pi/180)+center.y);
+    return center + getCornerDirections(myCornerPointCount)[index] * myRadius;
 }
 } // namespace sf
@@ -0,0 +1,121 @@
+#include "SnapIndex.h"
+#include <algorithm>
+#include <cmath>
+
+// A zero tolerance still needs a finite cell size; such points only merge when equal.
+static const float MinCellSize = 1e-6f;
+
+SnapIndex::SnapIndex(float tolerance)
+    : tolerance(std::max(tolerance, 0.0f)), cellSize(std::max(tolerance, MinCellSize)), points(0) {}
+
+void SnapIndex::setTolerance(float newTolerance) {
+    std::vector<Entry> entries;
+    entries.reserve(points);
+    for (const auto& cell : cells) {
+        entries.insert(entries.end(), cell.second.begin(), cell.second.end());
+    }
+    tolerance = std::max(newTolerance, 0.0f);
+    cellSize = std::max(tolerance, MinCellSize);
+    cells.clear();
+    points = 0;
+    for (const Entry& entry : entries) {
+        insertPoint(entry.vertex, entry.x, entry.y);
+    }
+}
+
+float SnapIndex::getTolerance() const {
+    return tolerance;
+}
+
+long long SnapIndex::cellCoord(float value) const {
+    return static_cast<long long>(std::floor(static_cast<double>(value) / cellSize));
+}
+
+// Cells far apart may share a key; lookups compare real positions, so that only costs a probe.
+std::uint64_t SnapIndex::cellKey(long long cellX, long long cellY) {
+    return static_cast<std::uint64_t>(cellX) * 0x9E3779B97F4A7C15ull ^ static_cast<std::uint64_t>(cellY);
+}
+
+std::uint64_t SnapIndex::pairKey(std::uint32_t a, std::uint32_t b) {
+    return (static_cast<std::uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+}
+
+void SnapIndex::insertPoint(std::uint32_t vertex, float x, float y) {
+    cells[cellKey(cellCoord(x), cellCoord(y))].push_back({vertex, x, y});
+    ++points;
+}
+
+void SnapIndex::removePoint(std::uint32_t vertex, float x, float y) {
+    auto cell = cells.find(cellKey(cellCoord(x), cellCoord(y)));
+    if (cell == cells.end()) {
+        return;
+    }
+    std::vector<Entry>& entries = cell->second;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].vertex == vertex) {
+            entries[i] = entries.back();
+            entries.pop_back();
+            --points;
+            break;
+        }
+    }
+    if (entries.empty()) {
+        cells.erase(cell);
+    }
+}
+
+void SnapIndex::movePoint(std::uint32_t vertex, float fromX, float fromY, float toX, float toY) {
+    removePoint(vertex, fromX, fromY);
+    insertPoint(vertex, toX, toY);
+}
+
+int SnapIndex::findPoint(float x, float y, int except) const {
+    long long cx = cellCoord(x);
+    long long cy = cellCoord(y);
+    int best = -1;
+    float bestDistance = tolerance * tolerance;
+    for (long long i = cx - 1; i <= cx + 1; ++i) {
+        for (long long j = cy - 1; j <= cy + 1; ++j) {
+            auto cell = cells.find(cellKey(i, j));
+            if (cell == cells.end()) continue;
+            for (const Entry& entry : cell->second) {
+                if (static_cast<int>(entry.vertex) == except) continue;
+                float dx = entry.x - x;
+                float dy = entry.y - y;
+                float distance = dx * dx + dy * dy;
+                if (distance <= bestDistance && (best < 0 || distance < bestDistance)) {
+                    best = static_cast<int>(entry.vertex);
+                    bestDistance = distance;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+void SnapIndex::insertSegment(std::uint32_t a, std::uint32_t b, int segmentId) {
+    segmentPairs[pairKey(a, b)] = segmentId;
+}
+
+void SnapIndex::removeSegment(std::uint32_t a, std::uint32_t b) {
+    segmentPairs.erase(pairKey(a, b));
+}
+
+int SnapIndex::findSegment(std::uint32_t a, std::uint32_t b) const {
+    auto found = segmentPairs.find(pairKey(a, b));
+    return found == segmentPairs.end() ? -1 : found->second;
+}
+
+void SnapIndex::clear() {
+    cells.clear();
+    segmentPairs.clear();
+    points = 0;
+}
+
+std::size_t SnapIndex::pointCount() const {
+    return points;
+}
+
+std::size_t SnapIndex::segmentCount() const {
+    return segmentPairs.size();
+}
@@ -0,0 +1,200 @@
+#include "SoftwareRenderer.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "Constants.h"
+#include "GraphRenderer.h"
+
+SoftwareRenderer::SoftwareRenderer(const Graph& graph, const RoadBorders* borders, float segmentWidth, float pointRadius)
+    : backgroundColor(0, 163, 108), segmentColor(sf::Color::Black), pointColor(sf::Color::Black),
+      roadColor(96, 96, 96), borderColor(sf::Color::White), graph(graph), borders(borders),
+      segmentWidth(segmentWidth), pointRadius(pointRadius), hasRoadTexture(false) {}
+
+bool SoftwareRenderer::loadRoadTexture(const std::string& filename) {
+    hasRoadTexture = roadTexture.loadFromFile(filename) && roadTexture.getSize().x > 0 && roadTexture.getSize().y > 0;
+    return hasRoadTexture;
+}
+
+void SoftwareRenderer::render(const sf::FloatRect& area, unsigned width, unsigned height, sf::Image& image) const {
+    std::vector<std::uint8_t> pixels;
+    render(area, width, height, pixels);
+    image.create(width, height, pixels.data());
+}
+
+void SoftwareRenderer::render(const sf::FloatRect& area, unsigned width, unsigned height,
+                              std::vector<std::uint8_t>& pixels) const {
+    pixels.resize(static_cast<std::size_t>(width) * height * 4);
+    for (std::size_t i = 0; i < pixels.size(); i += 4) {
+        pixels[i] = backgroundColor.r;
+        pixels[i + 1] = backgroundColor.g;
+        pixels[i + 2] = backgroundColor.b;
+        pixels[i + 3] = backgroundColor.a;
+    }
+    if (width == 0 || height == 0 || area.width <= 0 || area.height <= 0) {
+        return;
+    }
+    Canvas canvas = {pixels.data(), static_cast<int>(width), static_cast<int>(height),
+                     area.left, area.top, width / area.width, height / area.height};
+
+    float padding = std::max(ROAD_WIDTH, pointRadius);
+    AABB bounds = {area.left - padding, area.top - padding,
+                   area.left + area.width + padding, area.top + area.height + padding};
+    std::vector<int> visibleSegments;
+    graph.segmentIndex.query(bounds, [&visibleSegments](int id) {
+        visibleSegments.push_back(id);
+        return true;
+    });
+    // Draw in slot order, as the GraphRenderer's arrays do, so overlaps look the same.
+    std::sort(visibleSegments.begin(), visibleSegments.end());
+
+    auto toPixelX = [&canvas](float x) { return (x - canvas.left) * canvas.scaleX; };
+    auto toPixelY = [&canvas](float y) { return (y - canvas.top) * canvas.scaleY; };
+
+    // Zoomed out, roads are single pixel centerlines. Density shading is not reproduced.
+    if (GraphRenderer::detailLevelFor(area.width / width) != GraphRenderer::DetailLevel::Full) {
+        for (int id : visibleSegments) {
+            const Segment& segment = *graph.segments.getByIndex(id);
+            drawLine(canvas, toPixelX(graph.vertices.x(segment.a)), toPixelY(graph.vertices.y(segment.a)),
+                     toPixelX(graph.vertices.x(segment.b)), toPixelY(graph.vertices.y(segment.b)), 1.0f, segmentColor);
+        }
+        return;
+    }
+
+    for (int id : visibleSegments) {
+        const Segment& segment = *graph.segments.getByIndex(id);
+        drawLine(canvas, toPixelX(graph.vertices.x(segment.a)), toPixelY(graph.vertices.y(segment.a)),
+                 toPixelX(graph.vertices.x(segment.b)), toPixelY(graph.vertices.y(segment.b)),
+                 std::max(1.0f, segmentWidth * canvas.scaleX), segmentColor);
+    }
+    std::vector<int> visiblePoints = graph.pointIndex.queryRect(bounds.minX, bounds.minY, bounds.maxX, bounds.maxY);
+    std::sort(visiblePoints.begin(), visiblePoints.end());
+    for (int id : visiblePoints) {
+        drawDisc(canvas, toPixelX(graph.vertices.x(id)), toPixelY(graph.vertices.y(id)),
+                 pointRadius * canvas.scaleX, pointColor);
+    }
+    for (int id : visibleSegments) {
+        const Segment& segment = *graph.segments.getByIndex(id);
+        const Envelope* envelope = graph.roadEnvelopes.get(graph.segmentEnvelopes[id]);
+        if (envelope) {
+            drawEnvelope(canvas, segment, *envelope);
+        }
+    }
+    if (borders) {
+        for (int id : visibleSegments) {
+            for (const BorderEdge& edge : borders->getEdges(id)) {
+                drawLine(canvas, toPixelX(edge.a.x), toPixelY(edge.a.y), toPixelX(edge.b.x), toPixelY(edge.b.y),
+                         1.0f, borderColor);
+            }
+        }
+    }
+}
+
+template <typename Shader>
+void SoftwareRenderer::fillConvex(Canvas& canvas, const float* xs, const float* ys, int count, Shader shade) {
+    float minY = ys[0], maxY = ys[0];
+    for (int i = 1; i < count; ++i) {
+        minY = std::min(minY, ys[i]);
+        maxY = std::max(maxY, ys[i]);
+    }
+    int firstRow = std::max(0, static_cast<int>(std::ceil(minY - 0.5f)));
+    int lastRow = std::min(canvas.height - 1, static_cast<int>(std::ceil(maxY - 0.5f)) - 1);
+    for (int row = firstRow; row <= lastRow; ++row) {
+        // A convex outline crosses each row in one span
+        float centre = row + 0.5f;
+        float left = std::numeric_limits<float>::max(), right = std::numeric_limits<float>::lowest();
+        for (int i = 0; i < count; ++i) {
+            int j = i + 1 == count ? 0 : i + 1;
+            if ((ys[i] <= centre) == (ys[j] <= centre)) {
+                continue;
+            }
+            float x = xs[i] + (centre - ys[i]) * (xs[j] - xs[i]) / (ys[j] - ys[i]);
+            left = std::min(left, x);
+            right = std::max(right, x);
+        }
+        int firstColumn = std::max(0, static_cast<int>(std::ceil(left - 0.5f)));
+        int lastColumn = std::min(canvas.width - 1, static_cast<int>(std::ceil(right - 0.5f)) - 1);
+        std::uint8_t* pixel = canvas.pixels + (static_cast<std::size_t>(row) * canvas.width + firstColumn) * 4;
+        for (int column = firstColumn; column <= lastColumn; ++column, pixel += 4) {
+            blend(pixel, shade(column, row));
+        }
+    }
+}
+
+// Draws a colour over the pixel with its alpha, like the window's default blend mode.
+void SoftwareRenderer::blend(std::uint8_t* pixel, const sf::Color& color) {
+    if (color.a == 255) {
+        pixel[0] = color.r;
+        pixel[1] = color.g;
+        pixel[2] = color.b;
+        pixel[3] = 255;
+        return;
+    }
+    unsigned alpha = color.a, keep = 255 - color.a;
+    pixel[0] = static_cast<std::uint8_t>((color.r * alpha + pixel[0] * keep) / 255);
+    pixel[1] = static_cast<std::uint8_t>((color.g * alpha + pixel[1] * keep) / 255);
+    pixel[2] = static_cast<std::uint8_t>((color.b * alpha + pixel[2] * keep) / 255);
+    pixel[3] = static_cast<std::uint8_t>(alpha + pixel[3] * keep / 255);
+}
+
+// Draws a line of the given width in pixels as a quad, in pixel coordinates.
+void SoftwareRenderer::drawLine(Canvas& canvas, float ax, float ay, float bx, float by, float width,
+                                const sf::Color& color) const {
+    float dx = bx - ax, dy = by - ay;
+    float length = std::sqrt(dx * dx + dy * dy);
+    if (length == 0) {
+        return;
+    }
+    float nx = -dy / length * width / 2.0f, ny = dx / length * width / 2.0f;
+    float xs[4] = {ax + nx, bx + nx, bx - nx, ax - nx};
+    float ys[4] = {ay + ny, by + ny, by - ny, ay - ny};
+    fillConvex(canvas, xs, ys, 4, [&color](int, int) { return color; });
+}
+
+void SoftwareRenderer::drawDisc(Canvas& canvas, float x, float y, float radius, const sf::Color& color) const {
+    float xs[GraphRenderer::DiscSides], ys[GraphRenderer::DiscSides];
+    for (int i = 0; i < GraphRenderer::DiscSides; ++i) {
+        float angle = static_cast<float>(2 * MY_PI * i / GraphRenderer::DiscSides);
+        xs[i] = x + radius * std::cos(angle);
+        ys[i] = y + radius * std::sin(angle);
+    }
+    fillConvex(canvas, xs, ys, GraphRenderer::DiscSides, [&color](int, int) { return color; });
+}
+
+// Fills an envelope outline, mapping the road texture the way GraphRenderer::writeEnvelope
+// does: repeating along the road, with the texture's height spanning the road's width.
+void SoftwareRenderer::drawEnvelope(Canvas& canvas, const Segment& segment, const Envelope& envelope) const {
+    Point outline[4 * Envelope::CornerPoints];
+    envelope.getPolygon(graph.vertices, outline);
+    float xs[4 * Envelope::CornerPoints], ys[4 * Envelope::CornerPoints];
+    for (int i = 0; i < 4 * Envelope::CornerPoints; ++i) {
+        xs[i] = (outline[i].x - canvas.left) * canvas.scaleX;
+        ys[i] = (outline[i].y - canvas.top) * canvas.scaleY;
+    }
+
+    if (!hasRoadTexture) {
+        sf::Color color = roadColor;
+        fillConvex(canvas, xs, ys, 4 * Envelope::CornerPoints, [&color](int, int) { return color; });
+        return;
+    }
+    float ax = graph.vertices.x(segment.a), ay = graph.vertices.y(segment.a);
+    float bx = graph.vertices.x(segment.b), by = graph.vertices.y(segment.b);
+    float length = std::sqrt((bx - ax) * (bx - ax) + (by - ay) * (by - ay));
+    float dx = length > 0 ? (bx - ax) / length : 1.0f;
+    float dy = length > 0 ? (by - ay) / length : 0.0f;
+    float halfWidth = static_cast<float>(envelope.getWidth()) / 2.0f;
+    int textureWidth = static_cast<int>(roadTexture.getSize().x);
+    int textureHeight = static_cast<int>(roadTexture.getSize().y);
+    float scale = textureHeight / static_cast<float>(envelope.getWidth());
+    const std::uint8_t* texels = roadTexture.getPixelsPtr();
+
+    fillConvex(canvas, xs, ys, 4 * Envelope::CornerPoints, [&](int column, int row) {
+        float x = canvas.left + (column + 0.5f) / canvas.scaleX - ax;
+        float y = canvas.top + (row + 0.5f) / canvas.scaleY - ay;
+        int u = static_cast<int>(std::floor((x * dx + y * dy) * scale)) % textureWidth;
+        int v = static_cast<int>(std::floor((y * dx - x * dy + halfWidth) * scale)) % textureHeight;
+        u += u < 0 ? textureWidth : 0;
+        v += v < 0 ? textureHeight : 0;
+        const std::uint8_t* texel = texels + (static_cast<std::size_t>(v) * textureWidth + u) * 4;
+        return sf::Color(texel[0], texel[1], texel[2], texel[3]);
+    });
+}
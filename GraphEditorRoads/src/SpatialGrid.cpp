@@ -0,0 +1,242 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <queue>
+#include <utility>
+
+SpatialGrid::SpatialGrid(float cellSize)
+    : cellSize(cellSize > 0 ? cellSize : 1.0f),
+      minCellX(std::numeric_limits<int>::max()), maxCellX(std::numeric_limits<int>::lowest()),
+      minCellY(std::numeric_limits<int>::max()), maxCellY(std::numeric_limits<int>::lowest()) {}
+
+int SpatialGrid::cellCoord(float value) const {
+    return static_cast<int>(std::floor(value / cellSize));
+}
+
+SpatialGrid::CellKey SpatialGrid::makeKey(int cellX, int cellY) {
+    return (static_cast<CellKey>(cellX) << 32) | static_cast<std::uint32_t>(cellY);
+}
+
+void SpatialGrid::insert(int id, float x, float y) {
+    if (locations.count(id)) {
+        move(id, x, y);
+        return;
+    }
+    int cx = cellCoord(x);
+    int cy = cellCoord(y);
+    CellKey key = makeKey(cx, cy);
+    cells[key].push_back({id, x, y});
+    locations[id] = key;
+
+    minCellX = std::min(minCellX, cx);
+    maxCellX = std::max(maxCellX, cx);
+    minCellY = std::min(minCellY, cy);
+    maxCellY = std::max(maxCellY, cy);
+}
+
+void SpatialGrid::remove(int id) {
+    auto location = locations.find(id);
+    if (location == locations.end()) {
+        return;
+    }
+    auto cell = cells.find(location->second);
+    if (cell != cells.end()) {
+        std::vector<Entry>& entries = cell->second;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (entries[i].id == id) {
+                entries[i] = entries.back();
+                entries.pop_back();
+                break;
+            }
+        }
+        if (entries.empty()) {
+            cells.erase(cell);
+        }
+    }
+    locations.erase(location);
+}
+
+void SpatialGrid::move(int id, float x, float y) {
+    auto location = locations.find(id);
+    if (location == locations.end()) {
+        insert(id, x, y);
+        return;
+    }
+    // Most drag events stay inside the same cell, so just patch the stored position.
+    if (location->second == makeKey(cellCoord(x), cellCoord(y))) {
+        for (Entry& entry : cells[location->second]) {
+            if (entry.id == id) {
+                entry.x = x;
+                entry.y = y;
+                return;
+            }
+        }
+    }
+    remove(id);
+    insert(id, x, y);
+}
+
+void SpatialGrid::clear() {
+    cells.clear();
+    locations.clear();
+    minCellX = minCellY = std::numeric_limits<int>::max();
+    maxCellX = maxCellY = std::numeric_limits<int>::lowest();
+}
+
+bool SpatialGrid::contains(int id) const {
+    return locations.count(id) != 0;
+}
+
+std::size_t SpatialGrid::size() const {
+    return locations.size();
+}
+
+float SpatialGrid::getCellSize() const {
+    return cellSize;
+}
+
+template <typename Visitor>
+void SpatialGrid::forEachInCells(int x0, int y0, int x1, int y1, Visitor visit) const {
+    x0 = std::max(x0, minCellX);
+    y0 = std::max(y0, minCellY);
+    x1 = std::min(x1, maxCellX);
+    y1 = std::min(y1, maxCellY);
+    if (x0 > x1 || y0 > y1) {
+        return;
+    }
+
+    long long blockCells = static_cast<long long>(x1 - x0 + 1) * (y1 - y0 + 1);
+    if (blockCells > static_cast<long long>(cells.size())) {
+        for (const auto& cell : cells) {
+            int cx = static_cast<int>(cell.first >> 32);
+            int cy = static_cast<int>(static_cast<std::uint32_t>(cell.first));
+            if (cx < x0 || cx > x1 || cy < y0 || cy > y1) continue;
+            for (const Entry& entry : cell.second) visit(entry);
+        }
+        return;
+    }
+
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            auto cell = cells.find(makeKey(cx, cy));
+            if (cell == cells.end()) continue;
+            for (const Entry& entry : cell->second) visit(entry);
+        }
+    }
+}
+
+template <typename Visitor>
+void SpatialGrid::forEachOnRing(int cx, int cy, int ring, Visitor visit) const {
+    if (ring == 0) {
+        forEachInCells(cx, cy, cx, cy, visit);
+        return;
+    }
+    // Top and bottom rows, then the left and right columns without their corners.
+    forEachInCells(cx - ring, cy - ring, cx + ring, cy - ring, visit);
+    forEachInCells(cx - ring, cy + ring, cx + ring, cy + ring, visit);
+    forEachInCells(cx - ring, cy - ring + 1, cx - ring, cy + ring - 1, visit);
+    forEachInCells(cx + ring, cy - ring + 1, cx + ring, cy + ring - 1, visit);
+}
+
+int SpatialGrid::maxRing(int cx, int cy) const {
+    return std::max(std::max(cx - minCellX, maxCellX - cx), std::max(cy - minCellY, maxCellY - cy));
+}
+
+int SpatialGrid::nearest(float x, float y, float maxDistance) const {
+    if (cells.empty()) {
+        return -1;
+    }
+    int cx = cellCoord(x);
+    int cy = cellCoord(y);
+
+    // Rings closer than the occupied extent are empty, so start at the first one that can hit.
+    int firstRing = std::max(0, std::max(std::max(minCellX - cx, cx - maxCellX), std::max(minCellY - cy, cy - maxCellY)));
+    int lastRing = maxRing(cx, cy);
+
+    int bestId = -1;
+    float bestDistanceSq = maxDistance < std::sqrt(std::numeric_limits<float>::max())
+                               ? maxDistance * maxDistance
+                               : std::numeric_limits<float>::max();
+
+    for (int ring = firstRing; ring <= lastRing; ++ring) {
+        // Everything on this ring or beyond is at least (ring - 1) cells away.
+        float ringDistance = (ring - 1) * cellSize;
+        if (ring > 0 && ringDistance * ringDistance > bestDistanceSq) {
+            break;
+        }
+        forEachOnRing(cx, cy, ring, [&](const Entry& entry) {
+            float dx = entry.x - x;
+            float dy = entry.y - y;
+            float distanceSq = dx * dx + dy * dy;
+            if (distanceSq <= bestDistanceSq) {
+                bestDistanceSq = distanceSq;
+                bestId = entry.id;
+            }
+        });
+    }
+    return bestId;
+}
+
+std::vector<int> SpatialGrid::kNearest(float x, float y, std::size_t k) const {
+    std::vector<int> result;
+    if (cells.empty() || k == 0) {
+        return result;
+    }
+    int cx = cellCoord(x);
+    int cy = cellCoord(y);
+    int firstRing = std::max(0, std::max(std::max(minCellX - cx, cx - maxCellX), std::max(minCellY - cy, cy - maxCellY)));
+    int lastRing = maxRing(cx, cy);
+
+    // Max-heap on distance, so the furthest of the current k best sits on top.
+    std::priority_queue<std::pair<float, int>> best;
+    for (int ring = firstRing; ring <= lastRing; ++ring) {
+        float ringDistance = (ring - 1) * cellSize;
+        if (ring > 0 && best.size() == k && ringDistance * ringDistance > best.top().first) {
+            break;
+        }
+        forEachOnRing(cx, cy, ring, [&](const Entry& entry) {
+            float dx = entry.x - x;
+            float dy = entry.y - y;
+            float distanceSq = dx * dx + dy * dy;
+            if (best.size() < k) {
+                best.push({distanceSq, entry.id});
+            } else if (distanceSq < best.top().first) {
+                best.pop();
+                best.push({distanceSq, entry.id});
+            }
+        });
+    }
+
+    result.resize(best.size());
+    for (size_t i = result.size(); i-- > 0;) {
+        result[i] = best.top().second;
+        best.pop();
+    }
+    return result;
+}
+
+std::vector<int> SpatialGrid::queryRadius(float x, float y, float radius) const {
+    std::vector<int> result;
+    float radiusSq = radius * radius;
+    forEachInCells(cellCoord(x - radius), cellCoord(y - radius), cellCoord(x + radius), cellCoord(y + radius),
+                   [&](const Entry& entry) {
+                       float dx = entry.x - x;
+                       float dy = entry.y - y;
+                       if (dx * dx + dy * dy <= radiusSq) {
+                           result.push_back(entry.id);
+                       }
+                   });
+    return result;
+}
+
+std::vector<int> SpatialGrid::queryRect(float minX, float minY, float maxX, float maxY) const {
+    std::vector<int> result;
+    forEachInCells(cellCoord(minX), cellCoord(minY), cellCoord(maxX), cellCoord(maxY),
+                   [&](const Entry& entry) {
+                       if (entry.x >= minX && entry.x <= maxX && entry.y >= minY && entry.y <= maxY) {
+                           result.push_back(entry.id);
+                       }
+                   });
+    return result;
+}
@@ -0,0 +1,107 @@
+#include "TileCache.h"
+#include <algorithm>
+#include <cmath>
+
+TileCache::TileCache(unsigned tilePixels, std::size_t maxTiles)
+    : tilePixels(tilePixels), maxTiles(maxTiles), tileZoom(0), frame(0), redrawn(0) {}
+
+std::uint64_t TileCache::tileKey(std::int32_t x, std::int32_t y) {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) | static_cast<std::uint32_t>(y);
+}
+
+void TileCache::invalidate(const AABB& area) {
+    if (tiles.empty() || tileZoom <= 0) {
+        return;
+    }
+    float tileSize = tilePixels * tileZoom;
+    std::int32_t x0 = static_cast<std::int32_t>(std::floor(area.minX / tileSize));
+    std::int32_t y0 = static_cast<std::int32_t>(std::floor(area.minY / tileSize));
+    std::int32_t x1 = static_cast<std::int32_t>(std::floor(area.maxX / tileSize));
+    std::int32_t y1 = static_cast<std::int32_t>(std::floor(area.maxY / tileSize));
+    // A huge area is cheaper to handle by walking the cached tiles than the tile range.
+    if (static_cast<std::int64_t>(x1 - x0 + 1) * (y1 - y0 + 1) > static_cast<std::int64_t>(tiles.size())) {
+        for (auto& tile : tiles) {
+            std::int32_t x = static_cast<std::int32_t>(tile.first >> 32);
+            std::int32_t y = static_cast<std::int32_t>(tile.first & 0xFFFFFFFFu);
+            if (x >= x0 && x <= x1 && y >= y0 && y <= y1) {
+                tile.second.stale = true;
+            }
+        }
+        return;
+    }
+    for (std::int32_t x = x0; x <= x1; ++x) {
+        for (std::int32_t y = y0; y <= y1; ++y) {
+            auto tile = tiles.find(tileKey(x, y));
+            if (tile != tiles.end()) {
+                tile->second.stale = true;
+            }
+        }
+    }
+}
+
+void TileCache::invalidateAll() {
+    for (auto& tile : tiles) {
+        tile.second.stale = true;
+    }
+}
+
+void TileCache::draw(sf::RenderTarget& target, const sf::FloatRect& visibleArea, float zoom, const TileDrawer& drawTile) {
+    ++frame;
+    redrawn = 0;
+    if (zoom != tileZoom) {
+        tiles.clear();
+        tileZoom = zoom;
+    }
+
+    float tileSize = tilePixels * tileZoom;
+    std::int32_t x0 = static_cast<std::int32_t>(std::floor(visibleArea.left / tileSize));
+    std::int32_t y0 = static_cast<std::int32_t>(std::floor(visibleArea.top / tileSize));
+    std::int32_t x1 = static_cast<std::int32_t>(std::floor((visibleArea.left + visibleArea.width) / tileSize));
+    std::int32_t y1 = static_cast<std::int32_t>(std::floor((visibleArea.top + visibleArea.height) / tileSize));
+
+    for (std::int32_t x = x0; x <= x1; ++x) {
+        for (std::int32_t y = y0; y <= y1; ++y) {
+            sf::FloatRect area(x * tileSize, y * tileSize, tileSize, tileSize);
+            Tile& tile = tiles[tileKey(x, y)];
+            if (!tile.texture) {
+                tile.texture.reset(new sf::RenderTexture());
+                tile.texture->create(tilePixels, tilePixels);
+                tile.stale = true;
+            }
+            if (tile.stale) {
+                tile.texture->setView(sf::View(area));
+                tile.texture->clear(sf::Color::Transparent);
+                drawTile(*tile.texture, area);
+                tile.texture->display();
+                tile.stale = false;
+                ++redrawn;
+            }
+            tile.lastUsed = frame;
+
+            sf::Sprite sprite(tile.texture->getTexture());
+            sprite.setPosition(area.left, area.top);
+            sprite.setScale(tileZoom, tileZoom);
+            target.draw(sprite);
+        }
+    }
+    evict();
+}
+
+// Drops the least recently drawn tiles once the cache holds more than maxTiles.
+void TileCache::evict() {
+    if (tiles.size() <= maxTiles) {
+        return;
+    }
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> ages;
+    ages.reserve(tiles.size());
+    for (const auto& tile : tiles) {
+        ages.push_back({tile.second.lastUsed, tile.first});
+    }
+    std::size_t excess = tiles.size() - maxTiles;
+    std::nth_element(ages.begin(), ages.begin() + excess, ages.end());
+    for (std::size_t i = 0; i < excess; ++i) {
+        if (ages[i].first != frame) {
+            tiles.erase(ages[i].second);
+        }
+    }
+}
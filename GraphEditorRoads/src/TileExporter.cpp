@@ -0,0 +1,94 @@
+#include "TileExporter.h"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "Constants.h"
+
+TileExporter::TileExporter(const Graph& graph, unsigned tileSize)
+    : graph(graph), renderer(graph, &borders), tileSize(tileSize) {
+    borders.rebuild(graph);
+
+    // The pyramid covers a square around the whole graph, roads included.
+    float width = graph.maxX - graph.minX, height = graph.maxY - graph.minY;
+    if (graph.vertices.empty() || width < 0 || height < 0) {
+        world = sf::FloatRect(0, 0, 1000, 1000);
+        return;
+    }
+    float side = std::max(width, height) + 2 * ROAD_WIDTH;
+    world = sf::FloatRect((graph.minX + graph.maxX - side) / 2, (graph.minY + graph.maxY - side) / 2, side, side);
+}
+
+bool TileExporter::loadRoadTexture(const std::string& filename) {
+    return renderer.loadRoadTexture(filename);
+}
+
+sf::FloatRect TileExporter::getTileArea(int zoom, int x, int y) const {
+    float size = world.width / static_cast<float>(1 << zoom);
+    return sf::FloatRect(world.left + x * size, world.top + y * size, size, size);
+}
+
+void TileExporter::renderTile(int zoom, int x, int y, sf::Image& image) const {
+    renderer.render(getTileArea(zoom, x, y), tileSize, tileSize, image);
+}
+
+std::size_t TileExporter::exportPyramid(const std::string& directory, int maxZoom, unsigned threadCount) {
+    // Directories are made up front so the workers only ever write files.
+    std::error_code error;
+    for (int zoom = 0; zoom <= maxZoom; ++zoom) {
+        for (int x = 0; x < (1 << zoom); ++x) {
+            std::filesystem::create_directories(directory + "/" + std::to_string(zoom) + "/" + std::to_string(x), error);
+            if (error) {
+                std::cerr << "Cannot create tile directory in " << directory << ": " << error.message() << std::endl;
+                return 0;
+            }
+        }
+    }
+
+    // Every tile of every zoom, numbered level by level
+    std::size_t tileCount = 0;
+    for (int zoom = 0; zoom <= maxZoom; ++zoom) {
+        tileCount += static_cast<std::size_t>(1) << (2 * zoom);
+    }
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = static_cast<unsigned>(std::min<std::size_t>(threadCount, tileCount));
+
+    std::atomic<std::size_t> nextTile(0);
+    std::atomic<std::size_t> written(0);
+    auto work = [&]() {
+        sf::Image image;
+        for (std::size_t tile = nextTile++; tile < tileCount; tile = nextTile++) {
+            int zoom = 0;
+            std::size_t index = tile;
+            while (index >= static_cast<std::size_t>(1) << (2 * zoom)) {
+                index -= static_cast<std::size_t>(1) << (2 * zoom);
+                ++zoom;
+            }
+            int x = static_cast<int>(index >> zoom);
+            int y = static_cast<int>(index & ((static_cast<std::size_t>(1) << zoom) - 1));
+            renderTile(zoom, x, y, image);
+            std::string path = directory + "/" + std::to_string(zoom) + "/" + std::to_string(x) + "/" +
+                               std::to_string(y) + ".png";
+            if (image.saveToFile(path)) {
+                ++written;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threadCount; ++i) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    if (written != tileCount) {
+        std::cerr << "Wrote " << written << " of " << tileCount << " tiles to " << directory << std::endl;
+    }
+    return written;
+}
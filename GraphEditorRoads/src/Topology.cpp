@@ -0,0 +1,81 @@
+#include "Topology.h"
+#include <algorithm>
+
+void Topology::addSegment(int segmentId, int p1, int p2) {
+    incidence[p1].push_back(segmentId);
+    if (p2 != p1) {
+        incidence[p2].push_back(segmentId);
+    }
+}
+
+static void eraseSegmentId(std::vector<int>& list, int segmentId) {
+    auto found = std::find(list.begin(), list.end(), segmentId);
+    if (found != list.end()) {
+        *found = list.back();
+        list.pop_back();
+    }
+}
+
+void Topology::removeSegment(int segmentId, int p1, int p2) {
+    for (int pointId : {p1, p2}) {
+        auto list = incidence.find(pointId);
+        if (list == incidence.end()) continue;
+        eraseSegmentId(list->second, segmentId);
+        if (list->second.empty()) {
+            incidence.erase(list);
+        }
+    }
+}
+
+std::vector<int> Topology::removePoint(int pointId) {
+    std::vector<int> removed;
+    auto list = incidence.find(pointId);
+    if (list != incidence.end()) {
+        removed.swap(list->second);
+        incidence.erase(list);
+    }
+    return removed;
+}
+
+const std::vector<int>& Topology::incident(int pointId) const {
+    static const std::vector<int> none;
+    auto list = incidence.find(pointId);
+    return list == incidence.end() ? none : list->second;
+}
+
+std::size_t Topology::degree(int pointId) const {
+    return incident(pointId).size();
+}
+
+void Topology::clear() {
+    incidence.clear();
+}
+
+TopologySnapshot Topology::snapshot() const {
+    TopologySnapshot csr;
+    int maxPointId = -1;
+    std::size_t entries = 0;
+    for (const auto& list : incidence) {
+        if (list.first < 0) continue;
+        maxPointId = std::max(maxPointId, list.first);
+        entries += list.second.size();
+    }
+
+    // Count, prefix sum, then fill each row.
+    csr.offsets.assign(maxPointId + 2, 0);
+    for (const auto& list : incidence) {
+        if (list.first >= 0) {
+            csr.offsets[list.first + 1] = static_cast<int>(list.second.size());
+        }
+    }
+    for (std::size_t i = 1; i < csr.offsets.size(); ++i) {
+        csr.offsets[i] += csr.offsets[i - 1];
+    }
+    csr.segmentIds.resize(entries);
+    for (const auto& list : incidence) {
+        if (list.first >= 0) {
+            std::copy(list.second.begin(), list.second.end(), csr.segmentIds.begin() + csr.offsets[list.first]);
+        }
+    }
+    return csr;
+}
@@ -0,0 +1,68 @@
+#include "VertexBuffer.h"
+
+Handle VertexBuffer::add(float x, float y) {
+    std::uint32_t index;
+    if (!freeSlots.empty()) {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+        xs[index] = x;
+        ys[index] = y;
+    } else {
+        index = static_cast<std::uint32_t>(xs.size());
+        xs.push_back(x);
+        ys.push_back(y);
+        generations.push_back(0);
+        slotToLive.push_back(NoSlot);
+    }
+    generations[index] = nextGeneration(generations[index]);
+    slotToLive[index] = static_cast<std::uint32_t>(liveSlots.size());
+    liveSlots.push_back(index);
+    return {index, generations[index]};
+}
+
+bool VertexBuffer::remove(Handle handle) {
+    if (!contains(handle)) {
+        return false;
+    }
+    // Swap the last live slot into the hole so the live list stays dense.
+    std::uint32_t hole = slotToLive[handle.index];
+    std::uint32_t last = liveSlots.back();
+    liveSlots[hole] = last;
+    slotToLive[last] = hole;
+    liveSlots.pop_back();
+
+    slotToLive[handle.index] = NoSlot;
+    generations[handle.index] = nextGeneration(generations[handle.index]);
+    freeSlots.push_back(handle.index);
+    return true;
+}
+
+void VertexBuffer::clear() {
+    xs.clear();
+    ys.clear();
+    generations.clear();
+    slotToLive.clear();
+    liveSlots.clear();
+    freeSlots.clear();
+}
+
+void VertexBuffer::reserve(std::size_t count) {
+    xs.reserve(count);
+    ys.reserve(count);
+    generations.reserve(count);
+    slotToLive.reserve(count);
+    liveSlots.reserve(count);
+}
+
+void VertexBuffer::assign(const float* x, const float* y, std::size_t count) {
+    clear();
+    xs.assign(x, x + count);
+    ys.assign(y, y + count);
+    generations.assign(count, 1);
+    slotToLive.resize(count);
+    liveSlots.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        slotToLive[i] = static_cast<std::uint32_t>(i);
+        liveSlots[i] = static_cast<std::uint32_t>(i);
+    }
+}
@@ -44,6 +44,16 @@ void Viewport::update() {
     window.setView(view);
 }
 
+sf::FloatRect Viewport::getVisibleArea() const {
+    sf::Vector2f center = view.getCenter();
+    sf::Vector2f size = view.getSize();
+    return sf::FloatRect(center.x - size.x / 2.0f, center.y - size.y / 2.0f, size.x, size.y);
+}
+
+float Viewport::getZoom() const {
+    return window.getSize().x > 0 ? view.getSize().x / window.getSize().x : 1.0f;
+}
+
 sf::Vector2f Viewport::toWorldCoordinates(sf::Vector2i screenCoordinates) {
     return window.mapPixelToCoords(screenCoordinates);
 }
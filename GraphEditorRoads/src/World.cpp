@@ -1,4 +1,5 @@
 #include "World.h"
+#include "Profiler.h"
 
 World::World(Graph& graph, GraphEditor& editor) : graph(graph), editor(editor) {
     generateLevel();
@@ -10,6 +11,7 @@ void World::generateLevel() {
 }
 
 void World::draw() {
+    PROFILE_SCOPE("World::draw");
     // Draw a temporary point at the current mouse position
     editor.drawTemporaryPoint();
 
@@ -1,4 +1,5 @@
 #include "utils.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include "Point.h"
@@ -39,6 +40,21 @@ float lerp(float a, float b, float t) {
     return a + (b - a) * t;
 }
 
+// Shortest distance from point P to the segment AB
+float distanceToSegment(const Point& P, const Point& A, const Point& B) {
+    float dx = B.x - A.x;
+    float dy = B.y - A.y;
+    float lengthSq = dx * dx + dy * dy;
+
+    // Calculate the t that minimizes the distance, clamped to the segment.
+    float t = lengthSq > 0 ? ((P.x - A.x) * dx + (P.y - A.y) * dy) / lengthSq : 0.0f;
+    t = std::max(0.0f, std::min(1.0f, t));
+
+    float nearestX = A.x + t * dx;
+    float nearestY = A.y + t * dy;
+    return std::sqrt((P.x - nearestX) * (P.x - nearestX) + (P.y - nearestY) * (P.y - nearestY));
+}
+
 // Get Intersection (assuming Point has a constructor Point(float x, float y))
 Point getIntersection(const Point& A, const Point& B, const Point& C, const Point& D) {
     // Line AB represented as a1x + b1y = c1
@@ -62,3 +78,21 @@ Point getIntersection(const Point& A, const Point& B, const Point& C, const Poin
         return Point(x, y);
     }
 }
+
+// Segment Intersection: solves A + t(B - A) = C + u(D - C) and accepts t, u in [0, 1].
+bool getSegmentIntersection(const Point& A, const Point& B, const Point& C, const Point& D, Point& intersection) {
+    double rx = B.x - A.x, ry = B.y - A.y;
+    double sx = D.x - C.x, sy = D.y - C.y;
+    double denominator = rx * sy - ry * sx;
+    if (denominator == 0) {
+        return false;
+    }
+    double qx = C.x - A.x, qy = C.y - A.y;
+    double t = (qx * sy - qy * sx) / denominator;
+    double u = (qx * ry - qy * rx) / denominator;
+    if (t < 0 || t > 1 || u < 0 || u > 1) {
+        return false;
+    }
+    intersection = Point(A.x + t * rx, A.y + t * ry);
+    return true;
+}
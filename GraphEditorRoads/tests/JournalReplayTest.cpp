@@ -0,0 +1,173 @@
+// Drags a point onto and next to other points, journals the drag, and checks that the
+// graph reopened from the journal, and from the base compacted from it, matches the one
+// that was edited. Points are named by position in the journal, so a point dropped
+// within snap tolerance of another would replay onto the wrong one, and graph files
+// holding such points must be refused.
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Constants.h"
+#include "EditJournal.h"
+#include "Graph.h"
+#include "GraphFile.h"
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+static std::vector<std::pair<float, float>> pointsOf(const Graph& graph) {
+    std::vector<std::pair<float, float>> points;
+    for (std::uint32_t index : graph.vertices.live()) {
+        points.push_back({graph.vertices.x(index), graph.vertices.y(index)});
+    }
+    std::sort(points.begin(), points.end());
+    return points;
+}
+
+static std::vector<std::vector<float>> segmentsOf(const Graph& graph) {
+    std::vector<std::vector<float>> segments;
+    for (const Segment& segment : graph.segments) {
+        std::pair<float, float> a = {graph.vertices.x(segment.a), graph.vertices.y(segment.a)};
+        std::pair<float, float> b = {graph.vertices.x(segment.b), graph.vertices.y(segment.b)};
+        if (b < a) {
+            std::swap(a, b);
+        }
+        segments.push_back({a.first, a.second, b.first, b.second});
+    }
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+static bool sameGraph(const Graph& a, const Graph& b) {
+    return pointsOf(a) == pointsOf(b) && segmentsOf(a) == segmentsOf(b);
+}
+
+static void removeFiles(const std::string& baseFile) {
+    std::remove(baseFile.c_str());
+    std::remove((baseFile + ".journal").c_str());
+}
+
+// Hands the edits made so far to the journal and writes them as a batch of their own,
+// as the editor does between drags
+static void journalEdits(Graph& graph, EditJournal& journal) {
+    journal.append(graph.edits);
+    graph.clearEdits();
+    check(journal.flush(), "edits are written");
+}
+
+// Files holding two points at one position would replay edits onto the wrong one, so they
+// are neither written nor opened
+static void checkCoincidentPoints(const std::string& baseFile) {
+    // Roads (0,0)-(100,0) and (0,0)-(0,100) whose (0,0) ends are separate points
+    EdgeList coincident;
+    coincident.points = {Point(0, 0), Point(100, 0), Point(0, 0), Point(0, 100)};
+    coincident.segments = {Segment(0, 1), Segment(2, 3)};
+    check(!saveGraph(baseFile, coincident), "points at one position are not saved");
+    coincident.points[2] = Point(SNAP_TOLERANCE / 2, 0);
+    check(!saveGraph(baseFile, coincident), "points within tolerance are not saved");
+
+    // Write the second point clear of the first, then move it onto it in the file
+    float apart = 0.5f, onto = 0;
+    coincident.points[2] = Point(apart, 0);
+    check(saveGraph(baseFile, coincident), "points apart are saved");
+    std::string bytes;
+    {
+        std::ifstream in(baseFile, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    std::size_t at = bytes.find(std::string(reinterpret_cast<const char*>(&apart), sizeof(float)));
+    check(at != std::string::npos, "point found in the file");
+    if (at != std::string::npos) {
+        std::memcpy(&bytes[at], &onto, sizeof(float));
+        std::ofstream(baseFile, std::ios::binary).write(bytes.data(), bytes.size());
+        Graph graph({}, {});
+        EditJournal journal;
+        check(!journal.open(baseFile, graph), "file with points at one position does not open");
+    }
+    removeFiles(baseFile);
+}
+
+int main() {
+    const std::string baseFile = "JournalReplayTest.graph";
+    removeFiles(baseFile);
+    checkCoincidentPoints(baseFile);
+
+    // The first session lays out a road a - b - c; its edits end up in the base
+    {
+        Graph graph({}, {});
+        EditJournal journal;
+        check(journal.open(baseFile, graph), "journal opens without a base");
+        Handle a = graph.addPoint(Point(0, 0));
+        Handle b = graph.addPoint(Point(10, 0));
+        Handle c = graph.addPoint(Point(20, 0));
+        graph.addSegment(Segment(a.index, b.index));
+        graph.addSegment(Segment(b.index, c.index));
+        journalEdits(graph, journal);
+        journal.close();
+    }
+
+    // The second session drags points onto and next to others; its edits stay in the journal
+    Graph graph({}, {});
+    EditJournal journal;
+    check(journal.open(baseFile, graph), "journal reopens");
+    Handle a = graph.findNearestPoint(Point(0, 0));
+    Handle b = graph.findNearestPoint(Point(10, 0));
+    Handle c = graph.findNearestPoint(Point(20, 0));
+    check(!a.isNull() && !b.isNull() && !c.isNull(), "base holds the road");
+    float near = SNAP_TOLERANCE / 2;
+    float clear = SNAP_TOLERANCE * 2;
+
+    // Drop c exactly onto b
+    check(graph.movePoint(c, 15, 0), "free move is made");
+    check(!graph.movePoint(c, 10, 0), "move onto a point is refused");
+    check(graph.getPoint(c).x == 15, "refused move leaves the point where it was");
+    journalEdits(graph, journal);
+    // Drop c within tolerance of b
+    check(!graph.movePoint(c, 10 + near, 0), "move within tolerance of a point is refused");
+    journalEdits(graph, journal);
+    // Drop c just clear of b, then drag it on from there
+    check(graph.movePoint(c, 10 + clear, 0), "move just outside tolerance is made");
+    journalEdits(graph, journal);
+    check(graph.movePoint(c, 5, 5), "drag carries on from next to b");
+    journalEdits(graph, journal);
+    // Drop b onto a, then remove b; a and its segment to c must survive
+    check(!graph.movePoint(b, near, 0), "move of b onto a is refused");
+    journalEdits(graph, journal);
+    graph.removePoint(b);
+    graph.addSegment(Segment(a.index, c.index));
+    journalEdits(graph, journal);
+    check(graph.vertices.size() == 2 && graph.segments.size() == 1, "b is removed and a joined to c");
+    journal.close();
+
+    Graph replayed({}, {});
+    EditJournal reopened;
+    check(reopened.open(baseFile, replayed), "journal reopens after the drags");
+    check(sameGraph(graph, replayed), "replayed journal matches the edited graph");
+
+    // Same again once the journal is folded into the base, which the writer does at the
+    // latest on close
+    reopened.compact();
+    reopened.close();
+    check(reopened.getBaseBytesWritten() > 0, "journal is compacted");
+    Graph compacted({}, {});
+    EditJournal again;
+    check(again.open(baseFile, compacted), "compacted base reopens");
+    check(sameGraph(graph, compacted), "compacted base matches the edited graph");
+    again.close();
+
+    removeFiles(baseFile);
+    if (failures == 0) {
+        std::printf("JournalReplayTest passed\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
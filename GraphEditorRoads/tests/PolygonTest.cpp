@@ -0,0 +1,101 @@
+// Checks Polygon's containment, segment intersection and overlap answers on shapes whose
+// results are known, including points on edges and edges lying along each other.
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "Polygon.h"
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+static Polygon rectangle(float minX, float minY, float maxX, float maxY) {
+    return Polygon({Point(minX, minY), Point(maxX, minY), Point(maxX, maxY), Point(minX, maxY)});
+}
+
+static void checkContains() {
+    Polygon square = rectangle(0, 0, 10, 10);
+    check(square.size() == 4, "square has four vertices");
+    check(square.contains(5, 5), "centre is inside");
+    check(!square.contains(15, 5) && !square.contains(5, -1), "points beyond the edges are outside");
+    check(Polygon({Point(0, 0), Point(10, 0), Point(10, 10), Point(0, 0)}).size() == 3,
+          "a repeated first point is dropped");
+
+    // An L shape: the notch is inside the bounds but not the polygon
+    Polygon shape({Point(0, 0), Point(10, 0), Point(10, 4), Point(4, 4), Point(4, 10), Point(0, 10)});
+    check(shape.contains(2, 8) && shape.contains(8, 2), "both arms of the L are inside");
+    check(!shape.contains(8, 8), "the notch of the L is outside");
+
+    // The batch test agrees with the single one on a grid over the bounds
+    std::vector<float> xs, ys;
+    for (int i = 0; i <= 24; ++i) {
+        for (int j = 0; j <= 24; ++j) {
+            xs.push_back(-1 + i * 0.5f + 0.125f);
+            ys.push_back(-1 + j * 0.5f + 0.125f);
+        }
+    }
+    std::vector<std::uint8_t> inside(xs.size());
+    shape.contains(xs.data(), ys.data(), xs.size(), inside.data());
+    bool agree = true;
+    for (std::size_t k = 0; k < xs.size(); ++k) {
+        agree &= (inside[k] != 0) == shape.contains(xs[k], ys[k]);
+    }
+    check(agree, "batch containment matches single containment");
+
+    check(square.containsStrictly(5, 5), "centre is strictly inside");
+    check(!square.containsStrictly(10, 5) && !square.containsStrictly(0, 0), "edges and corners are not strictly inside");
+    check(!square.containsStrictly(11, 5), "points beyond the edges are not strictly inside");
+}
+
+static void checkIntersects() {
+    Polygon square = rectangle(0, 0, 10, 10);
+    check(square.intersects(Point(-5, 5), Point(15, 5)), "segment through the square intersects");
+    check(square.intersects(Point(2, 2), Point(3, 3)), "segment wholly inside intersects");
+    check(square.intersects(Point(-5, 5), Point(5, 5)), "segment ending inside intersects");
+    check(!square.intersects(Point(-5, -5), Point(-1, 20)), "segment beside the square does not intersect");
+    check(!square.intersects(Point(12, -5), Point(20, 15)), "segment within the bounds' reach but apart does not");
+    check(square.intersects(Point(-5, 15), Point(15, -5)), "diagonal through the square intersects");
+    // Running along an edge and past both corners touches the edges at each end
+    check(square.intersects(Point(-5, 0), Point(15, 0)), "segment along an edge past its corners touches");
+    check(square.intersects(Point(10, 5), Point(20, 5)), "segment starting on an edge touches");
+}
+
+static void checkOverlaps() {
+    Polygon square = rectangle(0, 0, 10, 10);
+    check(square.overlaps(rectangle(5, 5, 15, 15)), "crossing squares overlap");
+    check(square.overlaps(rectangle(2, 2, 4, 4)) && rectangle(2, 2, 4, 4).overlaps(square),
+          "a square inside another overlaps it, either way round");
+    check(!square.overlaps(rectangle(20, 0, 30, 10)), "squares apart do not overlap");
+    check(!square.overlaps(rectangle(11, 11, 20, 20)), "squares with overlapping bounds on a diagonal gap do not overlap");
+    // Edges lying along each other are not crossings, but the edges meeting them at the
+    // ends of the shared stretch touch
+    check(square.overlaps(rectangle(10, 0, 20, 10)), "squares sharing an edge touch");
+    check(square.overlaps(rectangle(10, 2, 20, 8)), "squares sharing part of an edge touch");
+    check(!square.overlaps(Polygon()), "nothing overlaps an empty polygon");
+}
+
+static void checkCrossEdge() {
+    Polygon square = rectangle(0, 0, 10, 10);
+    float alongEdge = 0, alongOther = 0;
+    // Edge 0 runs from (0, 0) to (10, 0)
+    check(square.crossEdge(0, Point(3, -5), Point(3, 5), alongEdge, alongOther), "crossing line is found");
+    check(alongEdge == 0.3f && alongOther == 0.5f, "crossing lies at the expected fractions");
+    check(!square.crossEdge(0, Point(0, 1), Point(10, 1), alongEdge, alongOther), "parallel line does not cross");
+    check(!square.crossEdge(0, Point(2, 0), Point(8, 0), alongEdge, alongOther), "collinear line does not cross");
+}
+
+int main() {
+    checkContains();
+    checkIntersects();
+    checkOverlaps();
+    checkCrossEdge();
+    if (failures == 0) {
+        std::printf("PolygonTest passed\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+// Exports map previews of a graph file as a pyramid of PNG tiles, directory/z/x/y.png,
+// rendered on the CPU so it runs on build servers without a display:
+//
+//   graphtiles world.graph tiles 6 Assets/road.png
+//
+// Files ending in .graph are read in the editor's binary format, anything else as OBJ.
+// OpenStreetMap extracts are converted to .graph with graphtool first.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "EdgeList.h"
+#include "Graph.h"
+#include "GraphFile.h"
+#include "GraphIO.h"
+#include "TileExporter.h"
+
+static void printUsage() {
+    std::cerr << "Usage: graphtiles <input.graph|.obj> <directory> [max zoom] [road texture] [threads]\n"
+                 "Writes directory/z/x/y.png for every zoom from 0, one 256 pixel tile showing the\n"
+                 "whole map, to max zoom (default 5). Without a road texture roads are flat grey.\n"
+                 "Threads defaults to one per core.\n";
+}
+
+static bool endsWith(const std::string& filename, const std::string& extension) {
+    return filename.size() >= extension.size() &&
+           filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+static bool load(const std::string& filename, Graph& graph) {
+    if (endsWith(filename, ".graph")) {
+        return loadGraph(filename, graph);
+    }
+    EdgeList edges;
+    if (!loadObj(filename, edges)) {
+        return false;
+    }
+    graph = Graph(edges.points, edges.segments);
+    return true;
+}
+
+// Reads a whole number argument in [low, high], reporting a malformed one.
+static bool readNumber(const char* argument, long low, long high, long& value) {
+    char* end = nullptr;
+    long number = std::strtol(argument, &end, 10);
+    if (end == argument || *end != '\0' || number < low || number > high) {
+        std::cerr << "Expected a number from " << low << " to " << high << ", got " << argument << std::endl;
+        return false;
+    }
+    value = number;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3 || argc > 6) {
+        printUsage();
+        return 1;
+    }
+    long maxZoom = 5, threads = 0;
+    if ((argc > 3 && !readNumber(argv[3], 0, 20, maxZoom)) || (argc > 5 && !readNumber(argv[5], 0, 1024, threads))) {
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    Graph graph({}, {});
+    if (!load(argv[1], graph)) {
+        return 1;
+    }
+    TileExporter exporter(graph);
+    if (argc > 4 && !exporter.loadRoadTexture(argv[4])) {
+        std::cerr << "Cannot load the road texture " << argv[4] << std::endl;
+        return 1;
+    }
+    std::fprintf(stderr, "load      %10.1f ms  %zu points, %zu segments\n",
+                 std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(),
+                 graph.vertices.size(), graph.segments.size());
+
+    start = std::chrono::steady_clock::now();
+    std::size_t expected = 0;
+    for (long zoom = 0; zoom <= maxZoom; ++zoom) {
+        expected += static_cast<std::size_t>(1) << (2 * zoom);
+    }
+    std::size_t written = exporter.exportPyramid(argv[2], static_cast<int>(maxZoom), static_cast<unsigned>(threads));
+    std::fprintf(stderr, "tiles     %10.1f ms  %zu of %zu written\n",
+                 std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(), written,
+                 expected);
+    return written == expected ? 0 : 1;
+}
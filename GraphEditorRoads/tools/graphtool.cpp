@@ -0,0 +1,139 @@
+// Batch processing of graph files without a window, for preprocessing jobs on servers.
+// Loads a graph, then runs the commands in the order given:
+//
+//   graphtool input.obj dedupe 0.5 intersect simplify 2 stats save output.graph
+//
+// Files ending in .graph are read and written in the editor's binary format, anything
+// else as OBJ. OpenStreetMap extracts, .osm or .osm.pbf, can be read too.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "EdgeList.h"
+#include "GraphFile.h"
+#include "GraphIO.h"
+#include "GraphProcessing.h"
+#include "OsmImport.h"
+
+static void printUsage() {
+    std::cerr << "Usage: graphtool <input.obj|.graph|.osm|.osm.pbf> [command...]\n"
+                 "Commands, run in order:\n"
+                 "  dedupe [tolerance]    merge points closer than tolerance, drop repeated segments\n"
+                 "  intersect             split segments where they cross\n"
+                 "  simplify <tolerance>  remove points along roads that bend less than tolerance\n"
+                 "  stats                 print counts, length and bounds\n"
+                 "  save <output>         write the graph as it is now, as .graph or .obj\n";
+}
+
+static bool endsWith(const std::string& filename, const std::string& extension) {
+    return filename.size() >= extension.size() &&
+           filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+static bool isBinary(const std::string& filename) {
+    return endsWith(filename, ".graph");
+}
+
+static bool load(const std::string& filename, EdgeList& graph) {
+    if (endsWith(filename, ".osm") || endsWith(filename, ".pbf")) {
+        OsmImportOptions options;
+        options.progress = [](const OsmProgress& progress) {
+            std::fprintf(stderr, "\r%-5s %5.1f%%  %zu ways, %zu nodes", progress.phase,
+                         progress.totalBytes ? 100.0 * progress.bytesRead / progress.totalBytes : 100.0,
+                         progress.ways, progress.nodes);
+            if (progress.bytesRead == progress.totalBytes) {
+                std::fputc('\n', stderr);
+            }
+        };
+        return importOsm(filename, graph, options);
+    }
+    return isBinary(filename) ? loadGraph(filename, graph) : loadObj(filename, graph);
+}
+
+static bool save(const std::string& filename, const EdgeList& graph) {
+    return isBinary(filename) ? saveGraph(filename, graph) : saveObj(filename, graph);
+}
+
+static void printStats(const EdgeList& graph) {
+    GraphStats stats = computeStats(graph);
+    std::printf("points:          %zu\n", stats.points);
+    std::printf("segments:        %zu\n", stats.segments);
+    std::printf("isolated points: %zu\n", stats.isolatedPoints);
+    std::printf("dead ends:       %zu\n", stats.deadEnds);
+    std::printf("junctions:       %zu (up to %zu roads)\n", stats.junctions, stats.maxDegree);
+    std::printf("components:      %zu\n", stats.components);
+    std::printf("total length:    %.1f\n", stats.totalLength);
+    std::printf("bounds:          %g %g to %g %g\n", stats.minX, stats.minY, stats.maxX, stats.maxY);
+}
+
+// Reads a number argument, reporting a missing or malformed one.
+static bool readNumber(int argc, char** argv, int& i, float& value) {
+    if (i + 1 >= argc) {
+        return false;
+    }
+    char* end = nullptr;
+    float number = std::strtof(argv[i + 1], &end);
+    if (end == argv[i + 1] || *end != '\0') {
+        return false;
+    }
+    value = number;
+    ++i;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+
+    EdgeList graph;
+    auto start = std::chrono::steady_clock::now();
+    if (!load(argv[1], graph)) {
+        return 1;
+    }
+    auto report = [&graph, &start](const std::string& step) {
+        double milliseconds =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::fprintf(stderr, "%-10s %10.1f ms  %zu points, %zu segments\n", step.c_str(), milliseconds,
+                     graph.points.size(), graph.segments.size());
+    };
+    report("load");
+
+    for (int i = 2; i < argc; ++i) {
+        std::string command = argv[i];
+        start = std::chrono::steady_clock::now();
+        if (command == "dedupe") {
+            float tolerance = SNAP_TOLERANCE;
+            readNumber(argc, argv, i, tolerance);
+            dedupe(graph, tolerance);
+        } else if (command == "intersect") {
+            std::size_t crossings = splitCrossings(graph);
+            std::fprintf(stderr, "%zu crossings\n", crossings);
+        } else if (command == "simplify") {
+            float tolerance = 0;
+            if (!readNumber(argc, argv, i, tolerance)) {
+                std::cerr << "simplify needs a tolerance" << std::endl;
+                return 1;
+            }
+            simplify(graph, tolerance);
+        } else if (command == "stats") {
+            printStats(graph);
+        } else if (command == "save") {
+            if (i + 1 >= argc) {
+                std::cerr << "save needs a file name" << std::endl;
+                return 1;
+            }
+            if (!save(argv[++i], graph)) {
+                return 1;
+            }
+        } else {
+            std::cerr << "Unknown command " << command << std::endl;
+            printUsage();
+            return 1;
+        }
+        report(command);
+    }
+    return 0;
+}